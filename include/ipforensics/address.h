@@ -80,9 +80,9 @@ class Address {
 
   /**
    *  @brief Accessor for the address_ property
-   *  @retval std::vector copy of the address_ property
+   *  @retval const std::vector<uint8_t>& the address_ property
    */
-  std::vector<uint8_t> address() const;
+  const std::vector<uint8_t>& address() const;
 
   /**
    *  @brief Mutator for the address_ property
@@ -160,6 +160,21 @@ class MACAddress : public Address {
    */
   virtual std::string str() const override;
 
+  /**
+   *  @brief Writes the text of str() without allocating
+   *  @param out buffer with room for ipf::kOutputLengthMAC characters
+   *  @retval char* end of the text written, out if the address is empty
+   */
+  char* format(char* out) const;
+
+  /**
+   *  @brief Writes the text of a MAC address without allocating
+   *  @param octets the 6 octets of the address
+   *  @param out buffer with room for ipf::kOutputLengthMAC characters
+   *  @retval char* end of the text written
+   */
+  static char* format(const uint8_t* octets, char* out);
+
   /**
    *  @brief Check if this address is a broadcast, multicast or otherwise 
    *         useless address for network asset discovery purposes.
@@ -187,6 +202,8 @@ class IPv4Address : public Address {
   /**
    *  @brief Creates a new IPv4 address from the supplied std::string
    *  @param ipv4 IPv4 address in dotted-quad notation
+   *  @throws std::invalid_argument if an octet is not a number
+   *  @throws std::out_of_range if an octet is not between 0 and 255
    */
   explicit IPv4Address(const std::string ipv4);
 
@@ -211,6 +228,21 @@ class IPv4Address : public Address {
    */
   virtual std::string str() const override;
 
+  /**
+   *  @brief Writes the text of str() without allocating
+   *  @param out buffer with room for ipf::kOutputLengthIPv4 characters
+   *  @retval char* end of the text written, out if the address is empty
+   */
+  char* format(char* out) const;
+
+  /**
+   *  @brief Writes the text of an IPv4 address without allocating
+   *  @param octets the 4 octets of the address
+   *  @param out buffer with room for ipf::kOutputLengthIPv4 characters
+   *  @retval char* end of the text written
+   */
+  static char* format(const uint8_t* octets, char* out);
+
   /**
    *  @brief Check if this address is a broadcast, multicast or otherwise
    *         useless address for network asset discovery purposes.
@@ -263,6 +295,21 @@ class IPv6Address : public Address {
    */
   virtual std::string str() const override;
 
+  /**
+   *  @brief Writes the text of str() without allocating
+   *  @param out buffer with room for ipf::kOutputLengthIPv6 characters
+   *  @retval char* end of the text written, out if the address is empty
+   */
+  char* format(char* out) const;
+
+  /**
+   *  @brief Writes the text of an IPv6 address without allocating
+   *  @param octets the 16 octets of the address
+   *  @param out buffer with room for ipf::kOutputLengthIPv6 characters
+   *  @retval char* end of the text written
+   */
+  static char* format(const uint8_t* octets, char* out);
+
   /**
    *  @brief Check if this address is a broadcast, multicast or otherwise
    *         useless address for network asset discovery purposes.
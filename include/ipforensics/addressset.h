@@ -0,0 +1,116 @@
+/**
+ *  @file addressset.h
+ *  @brief AddressSet class template definitions
+ */
+
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014 Michael Maraya
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef IPFORENSICS_ADDRESSSET_H_
+#define IPFORENSICS_ADDRESSSET_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <array>
+#include <vector>
+
+/**
+ *  @brief Small set of addresses kept in insertion order
+ *  @details The first N addresses are stored inline so the common case of a
+ *           host with one or two addresses per family never allocates; any
+ *           further addresses spill into a heap-allocated std::vector.  T is a
+ *           fixed-size integral or array representation of the address so
+ *           membership tests are plain value comparisons.
+ *  @tparam T packed address type
+ *  @tparam N number of addresses stored inline
+ */
+template <typename T, size_t N>
+class AddressSet {
+ private:
+  /** First N addresses */
+  std::array<T, N> inline_ {};
+
+  /** Addresses beyond the first N */
+  std::vector<T> spill_;
+
+  /** Number of addresses in the set */
+  size_t size_ {0};
+
+ public:
+  /**
+   *  @brief Number of addresses in the set
+   *  @retval size_t number of addresses
+   */
+  size_t size() const {
+    return size_;
+  }
+
+  /**
+   *  @brief Determines whether the set has no addresses
+   *  @retval bool true if empty, false otherwise
+   */
+  bool empty() const {
+    return size_ == 0;
+  }
+
+  /**
+   *  @brief Address at the given position, in insertion order
+   *  @param i position, less than size()
+   *  @retval T address
+   */
+  const T& operator[](size_t i) const {
+    return (i < N) ? inline_[i] : spill_[i - N];
+  }
+
+  /**
+   *  @brief Determines whether an address is in the set
+   *  @param address address to look for
+   *  @retval bool true if present, false otherwise
+   */
+  bool contains(const T& address) const {
+    for (size_t i = 0; i < size_; ++i) {
+      if ((*this)[i] == address) return true;
+    }
+    return false;
+  }
+
+  /**
+   *  @brief Adds an address unless it is already present or the set is full
+   *  @param address address to add
+   *  @param cap maximum number of addresses the set may hold
+   *  @retval bool true if the address was added, false otherwise
+   */
+  bool insert(const T& address, size_t cap) {
+    if (size_ >= cap || contains(address)) return false;
+    if (size_ < N) {
+      inline_[size_] = address;
+    } else {
+      spill_.push_back(address);
+    }
+    ++size_;
+    return true;
+  }
+};
+
+#endif  // IPFORENSICS_ADDRESSSET_H_
@@ -0,0 +1,228 @@
+/**
+ *  @file census.h
+ *  @brief HostCensus class definitions
+ */
+
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014 Michael Maraya
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef IPFORENSICS_CENSUS_H_
+#define IPFORENSICS_CENSUS_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <array>
+#include <iostream>  // NOLINT
+#include <unordered_set>
+#include <vector>
+#include "ipforensics/host.h"
+#include "ipforensics/ipindex.h"
+
+/**
+ *  @brief Counts of hosts by IP stack, kept up to date as hosts change
+ *  @details IPForensics reports every Host inserted into, changed in or 
+ *           removed from its host table, and every address it skips, so the
+ *           counts are always current and cost nothing to read.  Skipped 
+ *           addresses are counted once each, however many packets carry 
+ *           them.  When an interval is set, the counts are also recorded at 
+ *           the end of each interval of packet time that saw packets, giving
+ *           the migration trend within a capture.
+ */
+class HostCensus {
+ public:
+  /**
+   *  @brief IP stack of a Host, from its primary addresses
+   */
+  enum class Stack {
+    /** Neither an IPv4 nor an IPv6 address */
+    kNone,
+    /** IPv4 address only */
+    kIPv4,
+    /** IPv6 address only */
+    kIPv6,
+    /** Both IPv4 and IPv6 addresses */
+    kDual
+  };
+
+  /** number of stacks */
+  static const size_t kStacks {4};
+
+  /**
+   *  @brief Reason an address was skipped
+   */
+  enum class Skip {
+    /** Listed in the exclude file */
+    kExcluded,
+    /** Broadcast, multicast or otherwise not a real host */
+    kFake
+  };
+
+  /** number of reasons */
+  static const size_t kSkips {2};
+
+  /**
+   *  @brief Counts at the end of one interval
+   */
+  struct Bucket {
+    /** start of the interval in seconds since the Unix epoch */
+    int64_t start;
+
+    /** number of hosts */
+    uint64_t hosts;
+
+    /** number of hosts by Stack */
+    std::array<uint64_t, kStacks> stacks;
+  };
+
+ private:
+  /** Number of hosts */
+  uint64_t hosts_ {};
+
+  /** Number of hosts by Stack */
+  std::array<uint64_t, kStacks> stacks_ {};
+
+  /** Distinct MAC addresses skipped, packed, by Skip */
+  std::array<std::unordered_set<uint64_t>, kSkips> skipped_mac_;
+
+  /** Distinct IPv4 addresses skipped, packed, by Skip */
+  std::array<std::unordered_set<Host::PackedIPv4>, kSkips> skipped_ipv4_;
+
+  /** Distinct IPv6 addresses skipped, packed, by Skip */
+  std::array<std::unordered_set<Host::PackedIPv6, PackedIPv6Hash>, kSkips>
+      skipped_ipv6_;
+
+  /** Length of the intervals in seconds, 0 to not record them */
+  int interval_ {};
+
+  /** Start of the current interval in seconds, -1 before the first packet */
+  int64_t start_ {-1};
+
+  /** Counts at the end of each finished interval */
+  std::vector<Bucket> series_;
+
+ public:
+  /**
+   *  @brief IP stack of a Host
+   *  @param host Host to classify
+   *  @retval Stack from the Host's primary IPv4 and IPv6 addresses
+   */
+  static Stack stack(const Host& host);
+
+  /**
+   *  @brief Accessor method for the hosts_ property
+   *  @retval uint64_t number of hosts
+   */
+  uint64_t hosts() const;
+
+  /**
+   *  @brief Number of hosts with an IP stack
+   *  @param stack IP stack to count
+   *  @retval uint64_t number of hosts
+   */
+  uint64_t count(Stack stack) const;
+
+  /**
+   *  @brief Number of distinct addresses skipped for a reason
+   *  @param why reason the addresses were skipped
+   *  @retval uint64_t number of MAC, IPv4 and IPv6 addresses
+   */
+  uint64_t skipped(Skip why) const;
+
+  /**
+   *  @brief Accessor method for the interval_ property
+   *  @retval int length of the intervals in seconds, 0 if not recorded
+   */
+  int interval() const;
+
+  /**
+   *  @brief Mutator method for the interval_ property
+   *  @param seconds length of the intervals, 0 to not record them
+   */
+  void set_interval(int seconds);
+
+  /**
+   *  @brief Counts a Host added to the host table
+   *  @param host Host added
+   */
+  void add(const Host& host);
+
+  /**
+   *  @brief Uncounts a Host removed from the host table
+   *  @param host Host removed
+   */
+  void remove(const Host& host);
+
+  /**
+   *  @brief Moves a Host between stacks when its addresses change
+   *  @param before Host before the change
+   *  @param after Host after the change
+   */
+  void change(const Host& before, const Host& after);
+
+  /**
+   *  @brief Counts a MAC address skipped, unless it was skipped before
+   *  @param why reason the address was skipped
+   *  @param mac address skipped
+   */
+  void skip(Skip why, const MACAddress& mac);
+
+  /**
+   *  @brief Counts an IPv4 address skipped, unless it was skipped before
+   *  @param why reason the address was skipped
+   *  @param ipv4 address skipped
+   */
+  void skip(Skip why, const IPv4Address& ipv4);
+
+  /**
+   *  @brief Counts an IPv6 address skipped, unless it was skipped before
+   *  @param why reason the address was skipped
+   *  @param ipv6 address skipped
+   */
+  void skip(Skip why, const IPv6Address& ipv6);
+
+  /**
+   *  @brief Records the counts of any interval finished by a packet
+   *  @param time packet time in microseconds since the Unix epoch, before
+   *         the packet is counted
+   */
+  void tick(int64_t time);
+
+  /**
+   *  @brief Counts at the end of each interval seen so far
+   *  @retval std::vector<Bucket> finished intervals, then the current one
+   */
+  std::vector<Bucket> series() const;
+};
+
+/**
+ *  @brief Provide the std::string representation of a HostCensus time series
+ *         by overloading the << operator for std::ostream
+ *  @param out std::ostream output stream
+ *  @param c HostCensus instance to display as an std::string
+ *  @retval std::ostream address that contains the std::string representation of
+ *          this HostCensus
+ */
+std::ostream& operator<<(std::ostream& out, const HostCensus& c);
+
+#endif  // IPFORENSICS_CENSUS_H_
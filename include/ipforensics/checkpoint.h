@@ -0,0 +1,93 @@
+/**
+ *  @file checkpoint.h
+ *  @brief Checkpoint class definitions
+ */
+
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014 Michael Maraya
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef IPFORENSICS_CHECKPOINT_H_
+#define IPFORENSICS_CHECKPOINT_H_
+
+#include <stdint.h>
+#include <string>
+#include "ipforensics/ip4and6.h"
+
+/**
+ *  @brief Saves and restores the progress of a long-running capture file scan
+ *  @details A checkpoint records the capture file being read, the byte offset
+ *           of the next unread record in it, and every host found so far in
+ *           the same row format as the host summary report.  Checkpoints are
+ *           written to a temporary file and renamed into place so a run that
+ *           dies mid-write leaves the previous checkpoint intact.
+ */
+class Checkpoint {
+ private:
+  /**
+   *  @brief Pointer to the main controller this Checkpoint is associated with
+   */
+  IPForensics* ip_;
+
+  /**
+   *  @brief Why the last load() found no valid checkpoint, empty if there was
+   *         none to load
+   */
+  std::string error_;
+
+ public:
+  /**
+   *  @brief Constructs a Checkpoint for the supplied IPForensics instance
+   *  @param ip the IPForensics instance whose progress is saved and restored
+   */
+  explicit Checkpoint(IPForensics* ip);
+
+  /**
+   *  @brief Accessor method for the error_ property
+   *  @retval std::string why the last load() failed, as "file:line: problem",
+   *          or empty if there was no checkpoint
+   */
+  const std::string& error() const;
+
+  /**
+   *  @brief Write a checkpoint to IPForensics::checkpoint_file()
+   *  @param file name of the capture file being read
+   *  @param offset byte offset of the next unread record in file
+   *  @throws std::runtime_error if the checkpoint cannot be written
+   */
+  void save(const std::string& file, uint64_t offset) const;
+
+  /**
+   *  @brief Restore hosts and read position from IPForensics::checkpoint_file()
+   *  @details The checkpoint's hosts replace any with the same MAC address,
+   *           such as those loaded from the output file, since they are at 
+   *           least as recent.
+   *  @param file receives the name of the capture file to continue reading
+   *  @param offset receives the byte offset to continue reading from
+   *  @retval bool true if a valid checkpoint was loaded, false otherwise, with
+   *          no hosts added and file and offset left alone
+   */
+  bool load(std::string* file, uint64_t* offset);
+};
+
+#endif  // IPFORENSICS_CHECKPOINT_H_
@@ -0,0 +1,111 @@
+/**
+ *  @file countmin.h
+ *  @brief CountMin class definitions
+ */
+
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014 Michael Maraya
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef IPFORENSICS_COUNTMIN_H_
+#define IPFORENSICS_COUNTMIN_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+/**
+ *  @brief Count-Min frequency estimator
+ *  @details Keeps kDepth rows of kWidth counters, each row indexed by its own
+ *           bits of a 64-bit hash.  An estimate never undercounts, and with
+ *           probability confidence() it overcounts by at most epsilon() times
+ *           the total of all counts.  Counters are raised conservatively, 
+ *           only as far as the new estimate, which keeps the same bound but 
+ *           tightens it in practice.  Memory is fixed at 64 KB.
+ */
+class CountMin {
+ public:
+  /** number of hash bits used to select a counter in a row */
+  static const int kWidthBits {11};
+
+  /** number of counters in each row */
+  static const size_t kWidth {size_t {1} << kWidthBits};
+
+  /** number of rows */
+  static const size_t kDepth {4};
+
+ private:
+  /** Counters, row by row */
+  std::vector<uint64_t> counts_;
+
+  /** Total of all counts added */
+  uint64_t total_ {};
+
+ public:
+  /**
+   *  @brief Constructs an estimator with all counters at zero
+   */
+  CountMin();
+
+  /**
+   *  @brief Largest overcount as a fraction of total(), e / kWidth
+   *  @retval double fraction of the total
+   */
+  static double epsilon();
+
+  /**
+   *  @brief Probability that an estimate is within the error bound, 
+   *         1 - e^-kDepth
+   *  @retval double probability
+   */
+  static double confidence();
+
+  /**
+   *  @brief Accessor method for the total_ property
+   *  @retval uint64_t total of all counts added
+   */
+  uint64_t total() const;
+
+  /**
+   *  @brief Largest overcount of an estimate at confidence()
+   *  @retval uint64_t epsilon() times total(), rounded up
+   */
+  uint64_t error() const;
+
+  /**
+   *  @brief Adds to the count of an item
+   *  @param hash well-mixed 64-bit hash of the item
+   *  @param count amount to add
+   *  @retval uint64_t new estimated count of the item
+   */
+  uint64_t add(uint64_t hash, uint64_t count);
+
+  /**
+   *  @brief Estimates the count of an item
+   *  @param hash well-mixed 64-bit hash of the item
+   *  @retval uint64_t estimated count, never less than the true count
+   */
+  uint64_t estimate(uint64_t hash) const;
+};
+
+#endif  // IPFORENSICS_COUNTMIN_H_
@@ -0,0 +1,193 @@
+/**
+ *  @file deltalog.h
+ *  @brief DeltaLog class definitions
+ */
+
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014 Michael Maraya
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef IPFORENSICS_DELTALOG_H_
+#define IPFORENSICS_DELTALOG_H_
+
+/* Forward declared dependencies */
+class IPForensics;
+
+#include <stdint.h>
+#include <string>
+
+/**
+ *  @brief Append-only log of the hosts changed since the last snapshot
+ *  @details The log sits beside a Snapshot and records the hosts added, 
+ *           changed or removed by each run as one batch of Snapshot::Record 
+ *           and Snapshot::Alias entries with its own checksum, so a run only
+ *           writes the hosts it touched.  The log header names the checksum
+ *           of the snapshot it applies to, and loading replays the batches 
+ *           over that snapshot in order.  A batch cut short by a crash fails
+ *           its checksum and is dropped, along with anything after it, and 
+ *           the next append overwrites it.  Once the log outgrows a share of
+ *           the snapshot it is compacted: the snapshot is rewritten with 
+ *           every host and the log is deleted.  A log left over from an 
+ *           older snapshot no longer matches its checksum and is ignored.
+ */
+class DeltaLog {
+ public:
+  /**
+   *  @brief Start of a log file
+   */
+  struct Header {
+    /** ipf::kDeltaLogMagic */
+    char magic[8];
+
+    /** ipf::kSnapshotVersion */
+    uint32_t version;
+
+    /** ipf::kSnapshotByteOrder as written by the saving machine */
+    uint32_t byte_order;
+
+    /** sizeof(Snapshot::Record) */
+    uint32_t record_size;
+
+    /** sizeof(Snapshot::Alias) */
+    uint32_t alias_size;
+
+    /** checksum of the snapshot this log applies to */
+    uint64_t base;
+  };
+
+  /**
+   *  @brief Start of each batch of changes, followed by its records and then
+   *         its aliases
+   */
+  struct Batch {
+    /** number of records */
+    uint64_t records;
+
+    /** number of aliases */
+    uint64_t aliases;
+
+    /** FNV-1a hash of the records and aliases */
+    uint64_t checksum;
+  };
+
+ private:
+  /**
+   *  @brief Name of the log file
+   */
+  std::string filename_;
+
+  /**
+   *  @brief True once the snapshot the log applies to has been loaded or 
+   *         saved
+   */
+  bool based_ {};
+
+  /**
+   *  @brief Checksum of the snapshot the log applies to
+   */
+  uint64_t base_ {};
+
+  /**
+   *  @brief Number of hosts in the snapshot the log applies to
+   */
+  uint64_t base_records_ {};
+
+  /**
+   *  @brief Number of records in the log
+   */
+  uint64_t records_ {};
+
+  /**
+   *  @brief Size in bytes of the header and complete batches, or 0 if there 
+   *         is no usable log file
+   */
+  uint64_t size_ {};
+
+ public:
+  /**
+   *  @brief Accessor method for the filename_ property
+   *  @retval std::string name of the log file
+   */
+  std::string filename() const;
+
+  /**
+   *  @brief Accessor method for the records_ property
+   *  @retval uint64_t number of records in the log
+   */
+  uint64_t records() const;
+
+  /**
+   *  @brief Mutator method for the filename_ property
+   *  @param filename name of the log file
+   */
+  void set_filename(const std::string& filename);
+
+  /**
+   *  @brief Makes a snapshot the one the log applies to, without touching the 
+   *         log file
+   *  @param base checksum of the snapshot
+   *  @param records number of hosts in the snapshot
+   */
+  void set_base(uint64_t base, uint64_t records);
+
+  /**
+   *  @brief Forgets the snapshot the log applies to, without touching the log
+   *         file, so that due() asks for a full snapshot
+   */
+  void reset();
+
+  /**
+   *  @brief Determines if the changes should be compacted into a new snapshot
+   *         rather than appended
+   *  @param records number of records the next batch would add
+   *  @retval bool true if there is no snapshot yet or the log would grow past
+   *          its share of the snapshot
+   */
+  bool due(uint64_t records) const;
+
+  /**
+   *  @brief Applies the log to the hosts loaded from its snapshot
+   *  @param ip IPForensics holding the snapshot's hosts
+   *  @retval uint64_t number of records applied
+   *  @throws std::runtime_error if the file cannot be read or is not a log
+   */
+  uint64_t replay(IPForensics* ip);
+
+  /**
+   *  @brief Appends the hosts changed or removed since the last save as one 
+   *         batch
+   *  @param ip IPForensics whose changes are appended
+   *  @throws std::runtime_error if the file cannot be written
+   */
+  void append(const IPForensics& ip);
+
+  /**
+   *  @brief Deletes the log after its snapshot has been rewritten
+   *  @param base checksum of the new snapshot
+   *  @param records number of hosts in the new snapshot
+   *  @throws std::runtime_error if the file exists and cannot be deleted
+   */
+  void compacted(uint64_t base, uint64_t records);
+};
+
+#endif  // IPFORENSICS_DELTALOG_H_
@@ -32,11 +32,14 @@
 
 /* Forward declared dependencies */
 class IPForensics;
+class Publisher;
 
 #include <pcap/pcap.h>
 #include <pcap/bpf.h>
+#include <csignal>
 #include <stdexcept>
 #include <string>
+#include <utility>
 #include <vector>
 #include "ipforensics/packet.h"
 
@@ -68,6 +71,9 @@ class Device {
   /** IPv4 network mask for this device */
   IPv4Address mask_;
 
+  /** IPv6 network addresses and prefix lengths for this device */
+  std::vector<std::pair<IPv6Address, int>> ipv6_prefixes_;
+
  public:
   /**
    * @brief Creates a new Device supplying the parent IPForensics class
@@ -104,6 +110,13 @@ class Device {
    */
   IPv4Address mask() const;
 
+  /**
+   * @brief Accessor method for the ipv6_prefixes_ property
+   * @retval std::vector<std::pair<IPv6Address, int>> IPv6 network addresses
+   *         and prefix lengths for this Device
+   */
+  std::vector<std::pair<IPv6Address, int>> ipv6_prefixes() const;
+
   /**
    * @brief Accessor method for the packets_ property
    * @retval std::vector<Packet> Collection of packets collected by this Device
@@ -140,12 +153,40 @@ class Device {
    */
   void set_mask(const IPv4Address mask);
 
+  /**
+   * @brief Adds an IPv6 network to the ipv6_prefixes_ property
+   * @param net IPv6 network address for this Device
+   * @param length prefix length of the network in bits
+   */
+  void add_ipv6_prefix(const IPv6Address net, int length);
+
   /**
    * @brief Capture network packets from this Device
    * @param n Number of packets to capture
    * @retval int Actual number of packets captured
    */
   int capture(const int n);
+
+  /**
+   * @brief Capture network packets from this Device until stopped, passing
+   *        each one to IPForensics as it arrives
+   * @param n Number of packets to capture, 0 for no limit
+   * @param publisher Publisher to poll at least once per second
+   * @param stop set when the capture should end, checked at least every 
+   *        ipf::kTimeout milliseconds
+   * @retval int Actual number of packets captured
+   */
+  int stream(const int n, Publisher* publisher,
+             const volatile sig_atomic_t* stop);
+
+ private:
+  /**
+   * @brief Opens this Device for live capture
+   * @retval pcap_t* capture handle, to be closed with pcap_close()
+   * @throw std::runtime_error if the capture could not be opened or is not
+   *        IEEE 802.3 Ethernet
+   */
+  pcap_t* open() const;
 };
 
 /**
@@ -0,0 +1,149 @@
+/**
+ *  @file diff.h
+ *  @brief Diff class definitions
+ */
+
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014 Michael Maraya
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef IPFORENSICS_DIFF_H_
+#define IPFORENSICS_DIFF_H_
+
+#include <stddef.h>
+#include <ostream>
+#include <string>
+#include <vector>
+#include "ipforensics/ip4and6.h"
+#include "ipforensics/merge.h"
+
+/**
+ *  @brief Compares two inventories host by host
+ *  @details Both inputs are reports or binary Snapshots, read in parallel 
+ *           into Merge::Run arrays sorted by MAC address, and joined in one 
+ *           linear pass.  Hosts only in the newer inventory are added, hosts 
+ *           only in the older one are removed, and hosts in both whose set of
+ *           IPv4 and IPv6 addresses differs are changed.  Activity is not 
+ *           compared, since every active host's counts move between runs.  
+ *           Records are compared in their packed form, so hosts that did not
+ *           change are never converted back to Hosts or formatted.
+ */
+class Diff {
+ public:
+  /**
+   *  @brief Host counts of a comparison
+   */
+  struct Counts {
+    /** Hosts only in the newer inventory */
+    size_t added;
+
+    /** Hosts only in the older inventory */
+    size_t removed;
+
+    /** Hosts in both whose addresses differ */
+    size_t changed;
+
+    /** Hosts in both with the same addresses */
+    size_t unchanged;
+
+    /** Hosts in both that had no IPv6 address before and have one now */
+    size_t gained_ipv6;
+  };
+
+ private:
+  /**
+   *  @brief Pointer to the main controller supplying the per-host caps
+   */
+  IPForensics* ip_;
+
+  /**
+   *  @brief Older inventory
+   */
+  std::string before_;
+
+  /**
+   *  @brief Newer inventory
+   */
+  std::string after_;
+
+  /**
+   *  @brief Bad rows skipped by the last run, in file order
+   */
+  std::vector<std::string> errors_;
+
+  /**
+   *  @brief Host counts of the last run
+   */
+  Counts counts_ {};
+
+ public:
+  /**
+   *  @brief Constructs a Diff of two inventories
+   *  @param ip the IPForensics instance supplying the per-host address caps
+   *  @param before older report or snapshot file
+   *  @param after newer report or snapshot file
+   */
+  Diff(IPForensics* ip, const std::string& before, const std::string& after);
+
+  /**
+   *  @brief Accessor method for the ip_ property
+   *  @retval IPForensics* main controller supplying the per-host caps
+   */
+  IPForensics* ip() const;
+
+  /**
+   *  @brief Accessor method for the before_ property
+   *  @retval std::string older report or snapshot file
+   */
+  std::string before() const;
+
+  /**
+   *  @brief Accessor method for the after_ property
+   *  @retval std::string newer report or snapshot file
+   */
+  std::string after() const;
+
+  /**
+   *  @brief Accessor method for the errors_ property
+   *  @retval std::vector<std::string> bad rows skipped by the last run, as
+   *          "file:line: problem"
+   */
+  const std::vector<std::string>& errors() const;
+
+  /**
+   *  @brief Accessor method for the counts_ property
+   *  @retval Counts host counts of the last run
+   */
+  const Counts& counts() const;
+
+  /**
+   *  @brief Reads both inventories and writes one line per added, removed 
+   *         and changed host, then a summary line
+   *  @param out stream to write the differences to
+   *  @throws std::runtime_error naming the first file that could not be read,
+   *          in which case nothing is written
+   */
+  void run(std::ostream* out);
+};
+
+#endif  // IPFORENSICS_DIFF_H_
@@ -0,0 +1,161 @@
+/**
+ *  @file excludeset.h
+ *  @brief ExcludeSet class definitions
+ */
+
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014 Michael Maraya
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef IPFORENSICS_EXCLUDESET_H_
+#define IPFORENSICS_EXCLUDESET_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+#include <unordered_set>
+#include <vector>
+#include "ipforensics/host.h"
+#include "ipforensics/ipindex.h"
+#include "ipforensics/prefixtrie.h"
+
+/**
+ *  @brief MAC addresses, IP addresses and IP networks to leave out of the
+ *         host inventory
+ *  @details MAC and IPv4 addresses share one open-addressing hash table of 
+ *           tagged 64-bit keys, which takes 16 bytes per entry and usually 
+ *           answers with a single probe.  IPv6 addresses go in a hash set and
+ *           networks in a PrefixTrie per family.  Lists of at least 
+ *           ipf::kExcludeBloomEntries addresses also get a blocked Bloom filter
+ *           that keeps all of an address's bits in one 64-bit word, so most 
+ *           addresses that are not excluded are turned away after touching a 
+ *           single cache line.
+ */
+class ExcludeSet {
+ private:
+  /** Open-addressing table of tagged MAC and IPv4 keys */
+  std::vector<uint64_t> table_;
+
+  /** IPv6 addresses */
+  std::unordered_set<Host::PackedIPv6, PackedIPv6Hash> ipv6_;
+
+  /** IPv4 networks */
+  PrefixTrie ipv4_networks_;
+
+  /** IPv6 networks */
+  PrefixTrie ipv6_networks_;
+
+  /** Bloom filter over all the addresses, empty for short lists */
+  std::vector<uint64_t> bloom_;
+
+  /** Number of MAC, IPv4 and IPv6 addresses */
+  size_t addresses_ {};
+
+  /**
+   *  @brief Hashes a tagged key
+   *  @param key key to hash
+   *  @retval uint64_t well-mixed hash
+   */
+  static uint64_t hash(uint64_t key);
+
+  /**
+   *  @brief Folds an IPv6 address into a 64-bit key
+   *  @param ipv6 packed address
+   *  @retval uint64_t key for the Bloom filter
+   */
+  static uint64_t fold(const Host::PackedIPv6& ipv6);
+
+  /**
+   *  @brief Bits a hash sets in its Bloom filter word
+   *  @param h hash of the key
+   *  @retval uint64_t mask of ipf::kExcludeBloomBits bits
+   */
+  static uint64_t bloom_bits(uint64_t h);
+
+  /**
+   *  @brief Checks the Bloom filter
+   *  @param h hash of the key
+   *  @retval bool false if the key is certainly absent, true if it may be 
+   *          present or there is no filter
+   */
+  bool maybe(uint64_t h) const;
+
+  /**
+   *  @brief Looks a tagged key up in table_
+   *  @param key tagged MAC or IPv4 key
+   *  @retval bool true if present, false otherwise
+   */
+  bool find(uint64_t key) const;
+
+  /**
+   *  @brief Builds table_ and bloom_ from the loaded keys
+   *  @param keys tagged MAC and IPv4 keys
+   */
+  void build(const std::vector<uint64_t>& keys);
+
+ public:
+  /**
+   *  @brief Number of excluded addresses and networks
+   *  @retval size_t number of entries
+   */
+  size_t size() const;
+
+  /**
+   *  @brief Determines whether nothing is excluded
+   *  @retval bool true if empty, false otherwise
+   */
+  bool empty() const;
+
+  /**
+   *  @brief Replaces the contents with the entries of an exclude file
+   *  @param filename file with one MAC address, IPv4 or IPv6 address, or 
+   *         network in address/length notation per line; blank lines and 
+   *         text after '#' are ignored
+   *  @throws std::runtime_error if the file cannot be read or a line is not a
+   *          valid entry
+   */
+  void load(const std::string& filename);
+
+  /**
+   *  @brief Determines whether a MAC address is excluded
+   *  @param mac address to check
+   *  @retval bool true if excluded, false otherwise
+   */
+  bool excluded(const MACAddress& mac) const;
+
+  /**
+   *  @brief Determines whether an IPv4 address is excluded
+   *  @param ipv4 address to check
+   *  @retval bool true if listed or within a listed network, false otherwise
+   */
+  bool excluded(const IPv4Address& ipv4) const;
+
+  /**
+   *  @brief Determines whether an IPv6 address is excluded
+   *  @param ipv6 address to check
+   *  @retval bool true if listed or within a listed network, false otherwise
+   */
+  bool excluded(const IPv6Address& ipv6) const;
+};
+
+#endif  // IPFORENSICS_EXCLUDESET_H_
@@ -30,17 +30,133 @@
 #ifndef IPFORENSICS_HOST_H_
 #define IPFORENSICS_HOST_H_
 
+#include <stdint.h>
+#include <stdlib.h>
+#include <algorithm>
+#include <array>
+#include <new>
 #include <string>
+#include <vector>
 #include "ipforensics/address.h"
+#include "ipforensics/addressset.h"
+
+/**
+ *  @brief Traffic counters and first/last-seen times for a single Host
+ *  @details Activity is updated for every packet, so IPForensics keeps these
+ *           records in their own dense array instead of inside the Host 
+ *           records, apart from the rarely changing addresses.  Each record is
+ *           32 bytes and 32-byte aligned so that an update touches exactly one
+ *           cache line.  Times are microseconds since the Unix epoch, 0 if not
+ *           yet seen.
+ */
+struct alignas(32) Activity {
+  /** Number of packets sent or received */
+  uint64_t packets {};
+
+  /** Number of bytes sent or received, from the original packet lengths */
+  uint64_t bytes {};
+
+  /** Time of the first packet */
+  int64_t first_seen {};
+
+  /** Time of the last packet */
+  int64_t last_seen {};
+
+  /**
+   *  @brief Count one packet
+   *  @param time packet time in microseconds since the Unix epoch
+   *  @param length original length of the packet
+   */
+  void update(int64_t time, uint32_t length);
+
+  /**
+   *  @brief Combine the counters of another Activity into this one
+   *  @param other Activity to add to this one
+   */
+  void merge(const Activity& other);
+};
+
+/**
+ *  @brief Allocator that honors the alignment of over-aligned types such as
+ *         Activity
+ *  @details std::allocator only guarantees the alignment of std::max_align_t
+ *           before C++17, which would let Activity records straddle cache lines
+ */
+template <typename T>
+struct AlignedAllocator {
+  typedef T value_type;
+
+  AlignedAllocator() {}
+
+  template <typename U>
+  AlignedAllocator(const AlignedAllocator<U>&) {}  // NOLINT
+
+  T* allocate(size_t n) {
+    void* p = nullptr;
+    size_t alignment = std::max(alignof(T), sizeof(void*));
+    if (posix_memalign(&p, alignment, n * sizeof(T)) != 0) {
+      throw std::bad_alloc();
+    }
+    return static_cast<T*>(p);
+  }
+
+  void deallocate(T* p, size_t) {
+    free(p);
+  }
+};
+
+template <typename T, typename U>
+bool operator==(const AlignedAllocator<T>&, const AlignedAllocator<U>&) {
+  return true;
+}
+
+template <typename T, typename U>
+bool operator!=(const AlignedAllocator<T>&, const AlignedAllocator<U>&) {
+  return false;
+}
+
+/**
+ *  @brief Formats a packet time for reports
+ *  @param time microseconds since the Unix epoch, 0 if unknown
+ *  @retval std::string time in UTC, empty if unknown
+ */
+std::string utc_time(int64_t time);
+
+/**
+ *  @brief Provide the std::string representation of an Activity by overloading
+ *         the << operator for std::ostream
+ *  @details Writes the packet count, byte count, first-seen time and 
+ *           last-seen time columns of the host summary report
+ *  @param out std::ostream output stream
+ *  @param a Activity instance to display as an std::string
+ *  @retval std::ostream address that contains the std::string representation of
+ *          this Activity
+ */
+std::ostream& operator<<(std::ostream& out, const Activity& a);
 
 /**
  *  @brief Model class for storing information about a single network node, 
  *         following the model-view-controller software design pattern
  *  @details Host stores the media access control, Internet Protocol version 4,
  *           and Internet Protocol version 6 address information for a single 
- *           network node.
+ *           network node.  ipv4_ and ipv6_ are the primary addresses shown in
+ *           the main report row; every address seen for the node, primary
+ *           ones included, is also kept in ipv4s_ and ipv6s_.
  */
 class Host {
+ public:
+  /** IPv4 address packed into 32 bits, first octet in the low byte */
+  typedef uint32_t PackedIPv4;
+
+  /** IPv6 address as its 16 octets */
+  typedef std::array<uint8_t, 16> PackedIPv6;
+
+  /** Number of IPv4 addresses stored without a heap allocation */
+  static const size_t kInlineIPv4 {2};
+
+  /** Number of IPv6 addresses stored without a heap allocation */
+  static const size_t kInlineIPv6 {4};
+
  private:
   /** Media access control address */
   MACAddress mac_;
@@ -51,7 +167,48 @@ class Host {
   /** Internet Protocol version 6 address */
   IPv6Address ipv6_;
 
+  /** All Internet Protocol version 4 addresses, in the order first seen */
+  AddressSet<PackedIPv4, kInlineIPv4> ipv4s_;
+
+  /** All Internet Protocol version 6 addresses, in the order first seen */
+  AddressSet<PackedIPv6, kInlineIPv6> ipv6s_;
+
+  /** Index of this Host's Activity in IPForensics, kNoSlot if not stored */
+  uint32_t slot_ {kNoSlot};
+
  public:
+  /** Value of slot_ for a Host that has no Activity record */
+  static const uint32_t kNoSlot {UINT32_MAX};
+
+  /**
+   *  @brief Packs an IPv4 address for cheap comparison and hashing
+   *  @param ipv4 address to pack
+   *  @retval PackedIPv4 packed address, 0 if empty
+   */
+  static PackedIPv4 pack(const IPv4Address& ipv4);
+
+  /**
+   *  @brief Packs an IPv6 address for cheap comparison and hashing
+   *  @param ipv6 address to pack
+   *  @retval PackedIPv6 packed address, all zero if empty
+   */
+  static PackedIPv6 pack(const IPv6Address& ipv6);
+
+  /**
+   *  @brief Packs a MAC address for cheap comparison and hashing
+   *  @param mac address to pack
+   *  @retval uint64_t packed address, first octet in the most significant of
+   *          the low six bytes, 0 if empty
+   */
+  static uint64_t pack(const MACAddress& mac);
+
+  /**
+   *  @brief Restores a MAC address packed by pack(const MACAddress&)
+   *  @param mac packed address
+   *  @retval MACAddress unpacked address
+   */
+  static MACAddress unpack(uint64_t mac);
+
   /**
    *  @brief Construct an empty Host
    */
@@ -75,33 +232,116 @@ class Host {
 
   /** 
    *  @brief Accessor method for the const_ property
-   *  @retval MACAddress media access control address for this Host
+   *  @retval const MACAddress& media access control address for this Host
    */
-  MACAddress mac() const;
+  const MACAddress& mac() const;
 
   /**
    *  @brief Accessor method for the ipv4_ property
-   *  @retval IPv4Address Internet Protocol version 4 address for this Host
+   *  @retval const IPv4Address& Internet Protocol version 4 address for this
+   *          Host
    */
-  IPv4Address ipv4() const;
+  const IPv4Address& ipv4() const;
 
   /**
    *  @brief Accessor method for the ipv6_ property
-   *  @retval IPv6Address Internet Protocol version 6 address for this Host
+   *  @retval const IPv6Address& Internet Protocol version 6 address for this
+   *          Host
+   */
+  const IPv6Address& ipv6() const;
+
+  /**
+   *  @brief Accessor method for the ipv4s_ property
+   *  @retval std::vector<IPv4Address> every IPv4 address of this Host
+   */
+  std::vector<IPv4Address> ipv4s() const;
+
+  /**
+   *  @brief Accessor method for the ipv6s_ property
+   *  @retval std::vector<IPv6Address> every IPv6 address of this Host
+   */
+  std::vector<IPv6Address> ipv6s() const;
+
+  /**
+   *  @brief Accessor method for the ipv4s_ property that does not copy
+   *  @retval const AddressSet<PackedIPv4, kInlineIPv4>& every IPv4 address of
+   *          this Host, packed
+   */
+  const AddressSet<PackedIPv4, kInlineIPv4>& packed_ipv4s() const;
+
+  /**
+   *  @brief Accessor method for the ipv6s_ property that does not copy
+   *  @retval const AddressSet<PackedIPv6, kInlineIPv6>& every IPv6 address of
+   *          this Host, packed
    */
-  IPv6Address ipv6() const;
+  const AddressSet<PackedIPv6, kInlineIPv6>& packed_ipv6s() const;
+
+  /**
+   *  @brief Accessor method for the slot_ property
+   *  @retval uint32_t index of this Host's Activity record
+   */
+  uint32_t slot() const;
 
   /**
    *  @brief Mutator method for the ipv4_ property
    *  @param ipv4 Internet Protocol version 4 address for this Host
+   *  @details The address is also added to ipv4s_, regardless of any cap
    */
   void set_ipv4(const IPv4Address ipv4);
 
   /**
    *  @brief Mutator method for the ipv6_ property
    *  @param ipv6 Internet Protocol version 6 address for this Host
+   *  @details The address is also added to ipv6s_, regardless of any cap
    */
   void set_ipv6(const IPv6Address ipv6);
+
+  /**
+   *  @brief Records an IPv4 address of this Host, making it the primary
+   *         address if there is none yet
+   *  @param ipv4 Internet Protocol version 4 address, may be empty
+   *  @param cap maximum number of IPv4 addresses to keep for this Host
+   *  @retval bool true if the Host changed, false otherwise
+   */
+  bool add_ipv4(const IPv4Address& ipv4, size_t cap);
+
+  /**
+   *  @brief Records an IPv6 address of this Host, making it the primary
+   *         address if there is none yet
+   *  @param ipv6 Internet Protocol version 6 address, may be empty
+   *  @param cap maximum number of IPv6 addresses to keep for this Host
+   *  @retval bool true if the Host changed, false otherwise
+   */
+  bool add_ipv6(const IPv6Address& ipv6, size_t cap);
+
+  /**
+   *  @brief Determines whether add_ipv4() would change this Host
+   *  @param ipv4 Internet Protocol version 4 address, may be empty
+   *  @param cap maximum number of IPv4 addresses to keep for this Host
+   *  @retval bool true if the address is new and would be kept
+   */
+  bool adds_ipv4(const IPv4Address& ipv4, size_t cap) const;
+
+  /**
+   *  @brief Determines whether add_ipv6() would change this Host
+   *  @param ipv6 Internet Protocol version 6 address, may be empty
+   *  @param cap maximum number of IPv6 addresses to keep for this Host
+   *  @retval bool true if the address is new and would be kept
+   */
+  bool adds_ipv6(const IPv6Address& ipv6, size_t cap) const;
+
+  /**
+   *  @brief Additional report rows for the non-primary addresses
+   *  @retval std::vector<Host> Hosts without a MAC address, each holding the
+   *          next unlisted IPv4 and IPv6 address of this Host
+   */
+  std::vector<Host> aliases() const;
+
+  /**
+   *  @brief Mutator method for the slot_ property
+   *  @param slot index of this Host's Activity record
+   */
+  void set_slot(const uint32_t slot);
 };
 
 /**
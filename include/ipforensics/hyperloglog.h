@@ -0,0 +1,104 @@
+/**
+ *  @file hyperloglog.h
+ *  @brief HyperLogLog class definitions
+ */
+
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014 Michael Maraya
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef IPFORENSICS_HYPERLOGLOG_H_
+#define IPFORENSICS_HYPERLOGLOG_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <array>
+#include <string>
+
+/**
+ *  @brief HyperLogLog distinct-count estimator
+ *  @details Uses 2^kPrecision one-byte registers (4 KB) fed with 64-bit 
+ *           hashes, giving a relative standard error of 1.04 / sqrt(2^12), 
+ *           about 1.6%, at any cardinality.  Small counts are corrected with 
+ *           linear counting.  Two sketches of the same items merge losslessly
+ *           by taking the larger of each pair of registers.
+ */
+class HyperLogLog {
+ public:
+  /** number of hash bits used to select a register */
+  static const int kPrecision {12};
+
+  /** number of registers */
+  static const size_t kRegisters {size_t {1} << kPrecision};
+
+ private:
+  /** Largest rank seen in each register */
+  std::array<uint8_t, kRegisters> registers_ {};
+
+ public:
+  /**
+   *  @brief Relative standard error of the estimates
+   *  @retval double error as a fraction of the estimate
+   */
+  static double error();
+
+  /**
+   *  @brief Mixes a 64-bit key into a hash suitable for add()
+   *  @param key key to hash
+   *  @retval uint64_t hash of the key
+   */
+  static uint64_t hash(uint64_t key);
+
+  /**
+   *  @brief Counts an item
+   *  @param hash well-mixed 64-bit hash of the item
+   */
+  void add(uint64_t hash);
+
+  /**
+   *  @brief Estimates the number of distinct items counted
+   *  @retval double estimated cardinality
+   */
+  double estimate() const;
+
+  /**
+   *  @brief Combines another sketch into this one
+   *  @param other sketch to merge
+   */
+  void merge(const HyperLogLog& other);
+
+  /**
+   *  @brief Hexadecimal representation of the registers, for sketch files
+   *  @retval std::string two hexadecimal digits per register
+   */
+  std::string hex() const;
+
+  /**
+   *  @brief Restores the registers from hex()
+   *  @param text two hexadecimal digits per register
+   *  @throws std::invalid_argument if text is not a valid representation
+   */
+  void set_hex(const std::string& text);
+};
+
+#endif  // IPFORENSICS_HYPERLOGLOG_H_
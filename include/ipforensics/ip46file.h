@@ -32,6 +32,8 @@
 
 #include <set>
 #include <string>
+#include <utility>
+#include <vector>
 #include "ipforensics/ip4and6.h"
 
 /**
@@ -41,12 +43,35 @@
  *           the file-based storage and manipulation of IPForensics information
  */
 class IP46File {
+ public:
+  /**
+   *  @brief Hosts read from a file with their Activity, aligned for Activity
+   */
+  typedef std::vector<std::pair<Host, Activity>,
+                      AlignedAllocator<std::pair<Host, Activity>>> HostList;
+
  private:
   /**
    *  @brief Pointer to the main controller this IP46File is associated with
    */
   IPForensics* ip_;
 
+  /**
+   *  @brief Bad rows found by the last read, with their line numbers, up to
+   *         ipf::kMaxRowErrors
+   */
+  std::vector<std::string> errors_;
+
+  /**
+   *  @brief Number of bad rows found by the last read
+   */
+  size_t error_count_ {};
+
+  /**
+   *  @brief Most threads a read may use, 0 for one per hardware thread
+   */
+  size_t threads_ {};
+
  public:
   /**
    *  @brief Constructs an IP46File instance with the supplied pointer to 
@@ -62,15 +87,99 @@ class IP46File {
   IPForensics* ip() const;
 
   /**
-   *  @brief Determines if the file is a valid IPForensics information file
+   *  @brief Accessor method for the errors_ property
+   *  @retval std::vector<std::string> bad rows found by the last read, as
+   *          "file:line: problem"
+   */
+  const std::vector<std::string>& errors() const;
+
+  /**
+   *  @brief Accessor method for the error_count_ property
+   *  @retval size_t number of bad rows found by the last read, including 
+   *          those not kept in errors_
+   */
+  size_t error_count() const;
+
+  /**
+   *  @brief Accessor method for the threads_ property
+   *  @retval size_t most threads a read may use, 0 for one per hardware 
+   *          thread
+   */
+  size_t threads() const;
+
+  /**
+   *  @brief Mutator method for the threads_ property
+   *  @param threads most threads a read may use, 0 for one per hardware 
+   *         thread
+   */
+  void set_threads(size_t threads);
+
+  /**
+   *  @brief Determines if the file starts with the headers of an IPForensics
+   *         information file
    *  @retval bool true if valid IPForensics output file, false otherwise
    */
   bool valid() const;
 
+  /**
+   *  @brief Reads the hosts of an IPForensics information file without adding
+   *         them to IPForensics
+   *  @details Bad rows are skipped and recorded in errors_.
+   *  @param filename report written by IPForensics::results()
+   *  @param hosts receives each Host, with its continuation rows attached, and
+   *         its Activity, in file order
+   *  @retval bool true if read, false if the file does not exist or does not
+   *          start with a known header
+   *  @throws std::runtime_error if the file exists but cannot be read
+   */
+  bool read(const std::string& filename, HostList* hosts);
+
   /**
    *  @brief Load hosts from a valid IPForensics information file
+   *  @details Bad rows are skipped and recorded in errors_.
+   *  @retval bool true if loaded, false if the file does not exist or does 
+   *          not start with a known header
+   *  @throws std::runtime_error if the file exists but cannot be read
+   */
+  bool load();
+
+  /**
+   *  @brief Create a Host from one row of an IPForensics information file
+   *  @param line host row as written by operator<<(std::ostream&, const Host&)
+   *         and operator<<(std::ostream&, const Activity&)
+   *  @param activity receives the counters and times found in the row, if not
+   *         nullptr
+   *  @retval Host with the MAC, IPv4 and IPv6 addresses found in the row
+   */
+  static Host parse(const std::string& line, Activity* activity = nullptr);
+
+  /**
+   *  @brief Reads one row of an IPForensics information file, checking every
+   *         column as read() does
+   *  @param line host or continuation row, without the line break
+   *  @param host receives the MAC, IPv4 and IPv6 addresses of the row
+   *  @param activity receives the counters and times of the row
+   *  @retval const char* description of the first bad column, nullptr if the
+   *          row is good
+   */
+  static const char* read_row(const std::string& line, Host* host,
+                               Activity* activity);
+
+  /**
+   *  @brief Adds the addresses of a continuation row to the Host it follows
+   *  @param row parsed continuation row, without a MAC address
+   *  @param host Host the row belongs to
+   *  @param ip IPForensics supplying the per-host address caps
+   */
+  static void attach(const Host& row, Host* host, IPForensics* ip);
+
+  /**
+   *  @brief Adds a fully read Host to IPForensics, ignoring empty Hosts
+   *  @param host Host with all of its continuation rows attached
+   *  @param activity Activity read from the Host's row
+   *  @param ip IPForensics to add the Host to
    */
-  void load();
+  static void add(const Host& host, const Activity& activity, IPForensics* ip);
 };
 
 #endif  // IPFORENSICS_IP46FILE_H_
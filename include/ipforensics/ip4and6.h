@@ -34,8 +34,19 @@
 #include <pcap/pcap.h>
 #include <set>
 #include <string>
+#include <utility>
 #include <vector>
+#include "ipforensics/census.h"
+#include "ipforensics/deltalog.h"
 #include "ipforensics/device.h"
+#include "ipforensics/excludeset.h"
+#include "ipforensics/ipindex.h"
+#include "ipforensics/prefixtrie.h"
+#include "ipforensics/reportwriter.h"
+#include "ipforensics/sampler.h"
+#include "ipforensics/sketch.h"
+#include "ipforensics/timerwheel.h"
+#include "ipforensics/toptalkers.h"
 
 /**
  *  @brief Main controller class for the IPForensics library, following the 
@@ -64,6 +75,44 @@ class IPForensics {
    */
   std::set<Host> hosts_;
 
+  /**
+   *  @brief Counts of the hosts in hosts_ by IP stack, over time if an 
+   *         interval is set
+   */
+  HostCensus census_;
+
+  /**
+   *  @brief MAC addresses, IP addresses and networks from exclude_file_
+   */
+  ExcludeSet exclude_;
+
+  /**
+   *  @brief Local IPv4 networks; when not empty, other IPv4 addresses are
+   *         not attributed to hosts
+   */
+  PrefixTrie local_ipv4_;
+
+  /**
+   *  @brief Local IPv6 networks; when not empty, other IPv6 addresses are
+   *         not attributed to hosts
+   */
+  PrefixTrie local_ipv6_;
+
+  /**
+   *  @brief MAC address currently holding each IPv4 and IPv6 address seen
+   */
+  IPIndex index_;
+
+  /**
+   *  @brief Activity records of the hosts in hosts_, indexed by Host::slot()
+   */
+  std::vector<Activity, AlignedAllocator<Activity>> activity_;
+
+  /**
+   *  @brief Slots in activity_ released by removed hosts, reused first
+   */
+  std::vector<uint32_t> free_slots_;
+
   /**
    *  @brief Name of the network capture device to read packets from
    */
@@ -85,12 +134,161 @@ class IPForensics {
    */
   std::string exclude_file_;
 
+  /**
+   *  @brief Name of the binary snapshot file hosts are loaded from and saved
+   *         to, if any
+   */
+  std::string snapshot_file_;
+
+  /**
+   *  @brief Log of the changes saved since snapshot_file_ was last written
+   */
+  DeltaLog journal_;
+
+  /**
+   *  @brief Hosts added or changed since the last save, by Host::slot()
+   */
+  std::vector<bool> changed_;
+
+  /**
+   *  @brief Packed MAC addresses of the hosts removed since the last save, 
+   *         kept only when there is a snapshot file
+   */
+  std::vector<uint64_t> removed_;
+
+  /**
+   *  @brief Name of the file to periodically save read progress to
+   */
+  std::string checkpoint_file_;
+
+  /**
+   *  @brief Continue reading from the position saved in checkpoint_file_
+   */
+  bool resume_ {};
+
+  /**
+   *  @brief Keep reading the input file as it grows
+   *  @details When set, IPForensics::load_sequence follows the input file 
+   *           and the files after it in a tcpdump rotation until interrupted
+   */
+  bool follow_ {};
+
+  /**
+   *  @brief Seconds between background writes of a long-running capture, 0
+   *         for a one-shot run
+   *  @details When set, the device is captured and the input file followed
+   *           until interrupted, and a Publisher writes the report and 
+   *           snapshot from a copy of the host table every daemon_ seconds and
+   *           on SIGHUP
+   */
+  int daemon_ {};
+
+  /**
+   *  @brief Read only the bytes of each record that Packet decodes
+   *  @details Applies to IPForensics::load_sequence, which switches to batched
+   *           O_DIRECT reads for files of ipf::kDirectFileSize or more
+   */
+  bool skip_payload_ {};
+
+  /**
+   *  @brief Read capture files through io_uring where available
+   *  @details Applies to IPForensics::load_sequence when neither follow_ nor
+   *           skip_payload_ is set
+   */
+  bool uring_ {};
+
+  /**
+   *  @brief Display read throughput after reading a capture file
+   */
+  bool stats_ {};
+
   /**
    *  @brief Number of packets to read from the network or file
    *  @details If reading a file, a value of 0 means read all packets
    */
   int packet_count_ {};
 
+  /**
+   *  @brief Selects the packets that are decoded when sampling
+   */
+  Sampler sampler_;
+
+  /**
+   *  @brief Seconds of packet time after which a silent host is evicted,
+   *         0 to keep hosts forever
+   */
+  int idle_timeout_ {};
+
+  /**
+   *  @brief File that evicted hosts are appended to, if any
+   */
+  std::string evict_file_;
+
+  /**
+   *  @brief Idle timers of the hosts in hosts_, in seconds of packet time
+   */
+  TimerWheel timers_;
+
+  /**
+   *  @brief Number of hosts evicted for being idle
+   */
+  uint64_t evicted_ {};
+
+  /**
+   *  @brief Busiest MAC and IP addresses, tracked when --top is given
+   */
+  TopTalkers top_;
+
+  /**
+   *  @brief Add a vendor column and per-vendor counts to the report
+   */
+  bool vendors_ {};
+
+  /**
+   *  @brief Output format of the host report
+   */
+  ReportWriter::Format format_ {ReportWriter::Format::kTable};
+
+  /**
+   *  @brief Write only the summary counts, without the hosts
+   */
+  bool summary_only_ {};
+
+  /**
+   *  @brief Order the hosts are written in
+   */
+  ReportWriter::Order order_ {ReportWriter::Order::kMAC};
+
+  /**
+   *  @brief Estimated inventory, kept when sketching_ is set
+   */
+  Sketch sketch_;
+
+  /**
+   *  @brief Keep the estimated inventory alongside the host table
+   */
+  bool sketching_ {};
+
+  /**
+   *  @brief Keep only the estimated inventory, without a host table
+   */
+  bool sketch_only_ {};
+
+  /**
+   *  @brief File the estimated inventory is merged from and saved to, if any
+   */
+  std::string sketch_file_;
+
+  /**
+   *  @brief Maximum number of IPv4 addresses kept for each host
+   */
+  size_t max_ipv4_;
+
+  /**
+   *  @brief Maximum number of IPv6 addresses kept for each host
+   */
+  size_t max_ipv6_;
+
   /**
    *  @brief Packets from the capture device or libpcap file are stored in this
    *         collection
@@ -103,18 +301,121 @@ class IPForensics {
    *  @param ipv4 IPv4Address associated with this host
    *  @param ipv6 IPv6Address associated with this host
    */
-  void update_host(std::set<Host>::iterator it, IPv4Address ipv4,
-                   IPv6Address ipv6);
+  void update_host(std::set<Host>::iterator it, const IPv4Address& ipv4,
+                   const IPv6Address& ipv6);
+
+  /**
+   *  @brief Adds or updates the source and destination hosts of a Packet
+   *  @param packet Packet to extract hosts from
+   */
+  void process_packet(const Packet& packet);
+
+  /**
+   *  @brief Adds or updates one host of a Packet and counts the Packet in its
+   *         Activity
+   *  @param mac MACAddress of the host
+   *  @param ipv4 IPv4Address of the host in the Packet, if any
+   *  @param ipv6 IPv6Address of the host in the Packet, if any
+   *  @param packet Packet the host was found in
+   *  @param source true if the host sent the Packet
+   */
+  void observe_host(const MACAddress& mac, const IPv4Address& ipv4,
+                    const IPv6Address& ipv6, const Packet& packet,
+                    bool source);
+
+  /**
+   *  @brief Inserts a Host into hosts_ and stores its Activity
+   *  @param host Host to insert
+   *  @param activity Activity to store for the host
+   *  @retval uint32_t slot of the Host's Activity; the existing slot if a 
+   *          Host with the same MAC address was already present
+   */
+  uint32_t insert_host(Host host, const Activity& activity);
+
+  /**
+   *  @brief Removes a Host from hosts_ and releases its Activity
+   *  @param it iterator pointing to the Host to remove
+   *  @retval std::set<Host>::iterator iterator following the removed Host
+   */
+  std::set<Host>::iterator remove_host(std::set<Host>::iterator it);
+
+  /**
+   *  @brief Saves the hosts changed since the last save to the delta log, or
+   *         compacts everything into snapshot_file_ when the log is due
+   *  @throws std::runtime_error if a file cannot be written
+   */
+  void save_snapshot();
+
+  /**
+   *  @brief Marks every host as saved
+   */
+  void clear_changes();
+
+  /**
+   *  @brief Starts the idle timer of a Host
+   *  @param slot Host::slot() of the host
+   *  @param mac MACAddress of the host
+   *  @param seen packet time in microseconds from which the host counts as 
+   *         idle
+   */
+  void arm_timer(uint32_t slot, const MACAddress& mac, int64_t seen);
+
+  /**
+   *  @brief Evicts the hosts whose idle timeout has passed
+   *  @param time packet time in microseconds since the Unix epoch
+   *  @details Hosts seen since their timer was armed are re-armed instead
+   */
+  void expire_hosts(int64_t time);
 
   /**
-   *  @brief Remove broadcast, multicast and non-local hosts from 
+   *  @brief Appends evicted hosts to IPForensics::evict_file_
+   *  @param hosts hosts to write, with their activity
+   *  @throws std::runtime_error if the file cannot be opened or written to
+   */
+  void write_evicted(const std::vector<std::pair<Host, Activity>>& hosts);
+
+  /**
+   *  @brief Writes the number of hosts of each vendor
+   *  @param out stream to write the summary line to
+   */
+  void vendor_counts(std::ostream* out) const;
+
+  /**
+   *  @brief Lists the hosts in the order of order_
+   *  @retval std::vector<const Host*> every host, sorted by address with ties
+   *          in MAC order
+   */
+  std::vector<const Host*> sorted_hosts() const;
+
+  /**
+   *  @brief Remove hosts with broadcast or multicast addresses from 
    *         IPForensics::hosts_
-   *  @param net IPv4 network address used by the capture device
-   *  @param mask IPv4 network mask used by the capture device
+   *  @details Packets never add such hosts; this catches hosts loaded from
+   *           files
    */
-  void clean_hosts(IPv4Address* net, IPv4Address* mask);
+  void clean_hosts();
+
+  /**
+   *  @brief Determines whether an address may be attributed to a host
+   *  @param ipv4 address from a packet
+   *  @retval bool true if not empty, broadcast, multicast, non-local or
+   *          excluded
+   */
+  bool usable(const IPv4Address& ipv4) const;
+
+  /**
+   *  @brief Determines whether an address may be attributed to a host
+   *  @param ipv6 address from a packet
+   *  @retval bool true if not empty, multicast, non-local or excluded
+   */
+  bool usable(const IPv6Address& ipv6) const;
 
  public:
+  /**
+   *  @brief Constructs an IPForensics instance with the default settings
+   */
+  IPForensics();
+
   /**
    *  @brief Accessor method for the verbose_ property
    *  @retval bool show additional details during program execution
@@ -131,7 +432,20 @@ class IPForensics {
    *  @brief Accessor method for the hosts_ property
    *  @retval std::set of hosts, uniquely identified by their MAC addresses
    */
-  std::set<Host> hosts() const;
+  const std::set<Host>& hosts() const;
+
+  /**
+   *  @brief Accessor method for the index_ property
+   *  @retval IPIndex holders of the addresses seen and their conflicts
+   */
+  const IPIndex& index() const;
+
+  /**
+   *  @brief Activity of a Host in hosts_
+   *  @param host Host to look up
+   *  @retval Activity counters and times of the host, all zero if unknown
+   */
+  const Activity& activity(const Host& host) const;
 
   /**
    *  @brief Accessor method for the device_ property
@@ -157,12 +471,156 @@ class IPForensics {
    */
   std::string exclude_file() const;
 
+  /**
+   *  @brief Accessor method for the snapshot_file_ property
+   *  @retval std::string name of the binary snapshot file
+   */
+  std::string snapshot_file() const;
+
+  /**
+   *  @brief Accessor method for the checkpoint_file_ property
+   *  @retval std::string name of the file to save read progress to
+   */
+  std::string checkpoint_file() const;
+
+  /**
+   *  @brief Accessor method for the resume_ property
+   *  @retval bool true if reading continues from the last checkpoint
+   */
+  bool resume() const;
+
+  /**
+   *  @brief Accessor method for the follow_ property
+   *  @retval bool true if the input file is followed as it grows
+   */
+  bool follow() const;
+
+  /**
+   *  @brief Accessor method for the daemon_ property
+   *  @retval int seconds between background writes, 0 for a one-shot run
+   */
+  int daemon() const;
+
+  /**
+   *  @brief Accessor method for the skip_payload_ property
+   *  @retval bool true if only the decoded bytes of each record are read
+   */
+  bool skip_payload() const;
+
+  /**
+   *  @brief Accessor method for the uring_ property
+   *  @retval bool true if capture files are read through io_uring
+   */
+  bool uring() const;
+
+  /**
+   *  @brief Accessor method for the stats_ property
+   *  @retval bool true if read throughput is displayed
+   */
+  bool stats() const;
+
   /**
    *  @brief Accessor method for the packet_count_ property
    *  @retval int number of packets to read from the network or file
    */
   int packet_count() const;
 
+  /**
+   *  @brief Accessor method for the sampler_ property
+   *  @retval Sampler selecting the packets that are decoded
+   */
+  const Sampler& sampler() const;
+
+  /**
+   *  @brief Accessor method for the idle_timeout_ property
+   *  @retval int seconds of packet time after which a silent host is evicted
+   */
+  int idle_timeout() const;
+
+  /**
+   *  @brief Accessor method for the evict_file_ property
+   *  @retval std::string file that evicted hosts are appended to
+   */
+  std::string evict_file() const;
+
+  /**
+   *  @brief Accessor method for the evicted_ property
+   *  @retval uint64_t number of hosts evicted for being idle
+   */
+  uint64_t evicted() const;
+
+  /**
+   *  @brief Accessor method for the vendors_ property
+   *  @retval bool true if the report has a vendor column and per-vendor counts
+   */
+  bool vendors() const;
+
+  /**
+   *  @brief Accessor method for the format_ property
+   *  @retval ReportWriter::Format output format of the host report
+   */
+  ReportWriter::Format format() const;
+
+  /**
+   *  @brief Accessor method for the summary_only_ property
+   *  @retval bool true if only the summary counts are written
+   */
+  bool summary_only() const;
+
+  /**
+   *  @brief Accessor method for the order_ property
+   *  @retval ReportWriter::Order order the hosts are written in
+   */
+  ReportWriter::Order order() const;
+
+  /**
+   *  @brief Accessor method for the census_ property
+   *  @retval HostCensus counts of the hosts by IP stack
+   */
+  const HostCensus& census() const;
+
+  /**
+   *  @brief Accessor method for the top_ property
+   *  @retval TopTalkers busiest MAC and IP addresses
+   */
+  const TopTalkers& top() const;
+
+  /**
+   *  @brief Accessor method for the sketch_ property
+   *  @retval Sketch estimated inventory
+   */
+  const Sketch& sketch() const;
+
+  /**
+   *  @brief Accessor method for the sketching_ property
+   *  @retval bool true if the estimated inventory is kept
+   */
+  bool sketching() const;
+
+  /**
+   *  @brief Accessor method for the sketch_only_ property
+   *  @retval bool true if only the estimated inventory is kept
+   */
+  bool sketch_only() const;
+
+  /**
+   *  @brief Accessor method for the sketch_file_ property
+   *  @retval std::string file the estimated inventory is saved to
+   */
+  std::string sketch_file() const;
+
+  /**
+   *  @brief Accessor method for the max_ipv4_ property
+   *  @retval size_t maximum number of IPv4 addresses kept for each host
+   */
+  size_t max_ipv4() const;
+
+  /**
+   *  @brief Accessor method for the max_ipv6_ property
+   *  @retval size_t maximum number of IPv6 addresses kept for each host
+   */
+  size_t max_ipv6() const;
+
   /**
    *  @brief Accessor method for the packets_ property
    *  @retval std::vector packets read from the capture device or file
@@ -199,6 +657,55 @@ class IPForensics {
    */
   void set_exclude_file(std::string exclude_file);
 
+  /**
+   *  @brief Mutator method for the snapshot_file_ property
+   *  @param snapshot_file binary snapshot file to load hosts from and save
+   *         them to
+   */
+  void set_snapshot_file(std::string snapshot_file);
+
+  /**
+   *  @brief Mutator method for the checkpoint_file_ property
+   *  @param checkpoint_file file to periodically save read progress to
+   */
+  void set_checkpoint_file(std::string checkpoint_file);
+
+  /**
+   *  @brief Mutator method for the resume_ property
+   *  @param resume continue reading from the last checkpoint
+   */
+  void set_resume(bool resume);
+
+  /**
+   *  @brief Mutator method for the follow_ property
+   *  @param follow keep reading the input file as it grows
+   */
+  void set_follow(bool follow);
+
+  /**
+   *  @brief Mutator method for the daemon_ property
+   *  @param daemon seconds between background writes, 0 for a one-shot run
+   */
+  void set_daemon(int daemon);
+
+  /**
+   *  @brief Mutator method for the skip_payload_ property
+   *  @param skip_payload read only the decoded bytes of each record
+   */
+  void set_skip_payload(bool skip_payload);
+
+  /**
+   *  @brief Mutator method for the uring_ property
+   *  @param uring read capture files through io_uring where available
+   */
+  void set_uring(bool uring);
+
+  /**
+   *  @brief Mutator method for the stats_ property
+   *  @param stats display read throughput after reading a capture file
+   */
+  void set_stats(bool stats);
+
   /**
    *  @brief Mutator method for the packet_count_ property
    *  @param count number of packets to read from the network or file
@@ -206,6 +713,95 @@ class IPForensics {
    */
   void set_packet_count(int count);
 
+  /**
+   *  @brief Mutator method for the sampler_ property
+   *  @param method how packets are selected
+   *  @param rate decode one in rate packets
+   */
+  void set_sampler(Sampler::Method method, uint32_t rate);
+
+  /**
+   *  @brief Mutator method for the idle_timeout_ property
+   *  @param seconds seconds of packet time after which a silent host is 
+   *         evicted, 0 to keep hosts forever
+   */
+  void set_idle_timeout(int seconds);
+
+  /**
+   *  @brief Mutator method for the evict_file_ property
+   *  @param evict_file file that evicted hosts are appended to
+   */
+  void set_evict_file(std::string evict_file);
+
+  /**
+   *  @brief Mutator method for the vendors_ property
+   *  @param vendors add a vendor column and per-vendor counts to the report
+   */
+  void set_vendors(bool vendors);
+
+  /**
+   *  @brief Mutator method for the format_ property
+   *  @param format output format of the host report
+   */
+  void set_format(ReportWriter::Format format);
+
+  /**
+   *  @brief Mutator method for the summary_only_ property
+   *  @param summary_only write only the summary counts, without the hosts
+   */
+  void set_summary_only(bool summary_only);
+
+  /**
+   *  @brief Mutator method for the order_ property
+   *  @param order order the hosts are written in
+   */
+  void set_order(ReportWriter::Order order);
+
+  /**
+   *  @brief Sets the interval of the census_ time series
+   *  @param seconds seconds of packet time between snapshots of the host 
+   *         counts, 0 for none
+   */
+  void set_census_interval(int seconds);
+
+  /**
+   *  @brief Mutator method for the top_ property
+   *  @param k number of MAC and IP addresses to rank by packets and bytes, 0
+   *         to not track them
+   */
+  void set_top(size_t k);
+
+  /**
+   *  @brief Mutator method for the sketching_ property
+   *  @param sketching keep the estimated inventory alongside the host table
+   */
+  void set_sketching(bool sketching);
+
+  /**
+   *  @brief Mutator method for the sketch_only_ property
+   *  @param sketch_only keep only the estimated inventory; implies sketching
+   */
+  void set_sketch_only(bool sketch_only);
+
+  /**
+   *  @brief Mutator method for the sketch_file_ property
+   *  @param sketch_file file the estimated inventory is merged from and saved
+   *         to; implies sketching
+   */
+  void set_sketch_file(std::string sketch_file);
+
+  /**
+   *  @brief Mutator method for the max_ipv4_ property
+   *  @param max maximum number of IPv4 addresses kept for each host
+   */
+  void set_max_ipv4(size_t max);
+
+  /**
+   *  @brief Mutator method for the max_ipv6_ property
+   *  @param max maximum number of IPv6 addresses kept for each host
+   */
+  void set_max_ipv6(size_t max);
+
   /**
    *  @brief Adds a new Host to IPForensics::hosts_
    *  @param host Host instance to add to the collection
@@ -220,6 +816,112 @@ class IPForensics {
    */
   void add_host(MACAddress mac, IPv4Address ipv4, IPv6Address ipv6);
 
+  /**
+   *  @brief Adds a new Host with previously collected Activity to 
+   *         IPForensics::hosts_
+   *  @param host Host instance to add to the collection
+   *  @param activity Activity of the host
+   */
+  void add_host(const Host host, const Activity& activity);
+
+  /**
+   *  @brief Records the addresses seen for a Host using the same preference
+   *         rules as packets from the capture
+   *  @param host Host to update
+   *  @param ipv4 IPv4Address seen for the host, may be empty
+   *  @param ipv6 IPv6Address seen for the host, may be empty
+   *  @retval bool true if the Host changed, false otherwise
+   */
+  bool update_addresses(Host* host, const IPv4Address& ipv4,
+                        const IPv6Address& ipv6) const;
+
+  /**
+   *  @brief Adds a Host, replacing any Host with the same MAC address
+   *  @param host Host instance to add to the collection
+   *  @param activity Activity of the host
+   */
+  void replace_host(const Host& host, const Activity& activity);
+
+  /**
+   *  @brief Removes the Host with a MAC address, if any
+   *  @param mac MACAddress of the Host to remove
+   */
+  void drop_host(const MACAddress& mac);
+
+  /**
+   *  @brief Determines if a Host was added or changed since the last save
+   *  @param host Host from IPForensics::hosts()
+   *  @retval bool true if the Host has not been saved as it is now
+   */
+  bool changed(const Host& host) const;
+
+  /**
+   *  @brief Accessor method for the removed_ property
+   *  @retval const std::vector<uint64_t>& packed MAC addresses of the hosts
+   *          removed since the last save
+   */
+  const std::vector<uint64_t>& removed() const;
+
+  /**
+   *  @brief Loads the entries of IPForensics::exclude_file_
+   *  @throws std::runtime_error if the file cannot be read or has an invalid
+   *          entry
+   */
+  void load_exclude();
+
+  /**
+   *  @brief Merges IPForensics::sketch_file_ into the estimated inventory
+   *  @retval bool true if loaded, false if the file does not exist yet
+   *  @throws std::runtime_error if the file is not a valid sketch file
+   */
+  bool load_sketch();
+
+  /**
+   *  @brief Loads IPForensics::snapshot_file_ and replays its delta log
+   *  @retval bool true if loaded, false if the snapshot does not exist yet
+   *  @throws std::runtime_error if the snapshot or log cannot be read or is
+   *          not valid
+   */
+  bool load_snapshot();
+
+  /**
+   *  @brief Adds a local IPv4 network
+   *  @param net IPv4 network address
+   *  @param length prefix length in bits
+   */
+  void add_local(const IPv4Address& net, int length);
+
+  /**
+   *  @brief Adds a local IPv6 network
+   *  @param net IPv6 network address
+   *  @param length prefix length in bits
+   */
+  void add_local(const IPv6Address& net, int length);
+
+  /**
+   *  @brief Adds the local networks listed in a file
+   *  @param filename file with one IPv4 or IPv6 network per line in 
+   *         address/length notation; a missing length means a single address,
+   *         and blank lines and text after '#' are ignored
+   *  @throws std::runtime_error if the file cannot be read or a line is not a
+   *          valid network
+   */
+  void load_local(const std::string& filename);
+
+  /**
+   *  @brief Determines whether an address is on a local network
+   *  @param ipv4 address to check
+   *  @retval bool true if within a local IPv4 network, or if none were added
+   */
+  bool local(const IPv4Address& ipv4) const;
+
+  /**
+   *  @brief Determines whether an address is on a local network
+   *  @param ipv6 address to check
+   *  @retval bool true if within a local IPv6 network, or if none were added
+   */
+  bool local(const IPv6Address& ipv6) const;
+
   /**
    *  @brief Queries the system for all available packet capture devices and
    *         enters them into IPForensics::devices_
@@ -240,6 +942,19 @@ class IPForensics {
    */
   void load_hosts(std::string filename);
 
+  /**
+   *  @brief Reads hosts from a packet capture file and the files after it in
+   *         its tcpdump rotation sequence
+   *  @details Reading moves on to the next file in the rotation once it exists.
+   *           If follow_ is set, new records are processed as they are 
+   *           appended until the packet count is reached or on SIGINT/SIGTERM.
+   *           If checkpoint_file_ is set, progress is saved periodically and,
+   *           with resume_, reading continues from the saved position.
+   *  @param filename User-supplied filename of the packet capture file to read
+   *  @retval int number of packets read
+   */
+  int load_sequence(std::string filename);
+
   /**
    *  @brief Load packets from command-line supplied pcap file
    *  @retval Number of packets read from pcap file or -1 if error detected
@@ -265,6 +980,24 @@ class IPForensics {
    * @retval int actual number of packets captured
    */
   friend int Device::capture(const int n);
+
+  /**
+   * @brief friend function from the Device class for capturing network 
+   *        packets until stopped
+   * @details Device processes each packet as it arrives instead of storing it
+   * @param n Number of packets to capture, 0 for no limit
+   * @param publisher Publisher to poll between packets
+   * @param stop set when the capture should end
+   * @retval int actual number of packets captured
+   */
+  friend int Device::stream(const int n, Publisher* publisher,
+                            const volatile sig_atomic_t* stop);
+
+  /**
+   * @brief Publisher writes the hosts of a long-running capture from a forked
+   *        copy and needs to clean that copy and reset the delta log
+   */
+  friend class Publisher;
 };
 
 /**
@@ -287,6 +1020,93 @@ namespace ipf {
   /** number of milliseconds to wait for each network packet */
   const int kTimeout {1000};
 
+  /** number of milliseconds to wait for a followed file to grow */
+  const int kFollowInterval {1000};
+
+  /** length in seconds of the time strata used for sampling */
+  const int kSampleStratum {1};
+
+  /** default maximum number of IPv4 addresses kept for each host */
+  const size_t kMaxAddressesIPv4 {8};
+
+  /** default maximum number of IPv6 addresses kept for each host */
+  const size_t kMaxAddressesIPv6 {16};
+
+  /** maximum number of subnets given their own estimates */
+  const size_t kSketchMaxSubnets {256};
+
+  /** first line of a sketch file */
+  const std::string kSketchHeader {"ipforensics sketch 1"};
+
+  /** number of excluded addresses from which a Bloom filter is used */
+  const size_t kExcludeBloomEntries {65536};
+
+  /** number of Bloom filter bits per excluded address */
+  const size_t kExcludeBloomBitsPerEntry {16};
+
+  /** number of Bloom filter bits set for each excluded address */
+  const int kExcludeBloomBits {4};
+
+  /** number of packets read between checkpoints */
+  const int kCheckpointPackets {1000000};
+
+  /** first eight bytes of a snapshot file */
+  const char kSnapshotMagic[8] {'I', 'P', 'F', 'S', 'N', 'A', 'P', '\0'};
+
+  /** snapshot file format version */
+  const uint32_t kSnapshotVersion {1};
+
+  /** value whose stored bytes reveal the byte order of a snapshot file */
+  const uint32_t kSnapshotByteOrder {0x01020304};
+
+  /** first eight bytes of a delta log file */
+  const char kDeltaLogMagic[8] {'I', 'P', 'F', 'D', 'E', 'L', 'T', 'A'};
+
+  /** appended to the snapshot file name to name its delta log */
+  const char kDeltaLogSuffix[] {".log"};
+
+  /** snapshot hosts per delta log record below which the log is compacted */
+  const uint64_t kDeltaLogCompaction {4};
+
+  /** size of the buffer report rows are formatted into */
+  const size_t kReportBufferSize {1 << 20};
+
+  /** first line of a checkpoint file */
+  const std::string kCheckpointHeader {"ipforensics checkpoint 1"};
+
+  /** largest record a libpcap-format file may contain */
+  const uint32_t kMaxSnapLength {262144};
+
+  /** number of bytes read from a capture file at a time */
+  const size_t kReadBufferSize {1 << 20};
+
+  /** number of bytes read per record when skipping payloads */
+  const size_t kHeaderReadSize {128};
+
+  /** buffer and offset alignment required for O_DIRECT reads */
+  const size_t kDirectAlignment {4096};
+
+  /** files at least this large use O_DIRECT reads when skipping payloads */
+  const uint64_t kDirectFileSize {1ULL << 32};
+
+  /** number of io_uring reads kept in flight */
+  const unsigned kRingChunks {8};
+
+  /** size of each io_uring read */
+  const size_t kRingChunkSize {1 << 20};
+
+  /** libpcap file magic number for microsecond timestamps */
+  const uint32_t kPcapMagic {0xA1B2C3D4};
+
+  /** libpcap file magic number for nanosecond timestamps */
+  const uint32_t kPcapMagicNano {0xA1B23C4D};
+
+  /** length of the libpcap file header */
+  const size_t kPcapFileHeaderLength {24};
+
+  /** length of the libpcap record header */
+  const size_t kPcapRecordHeaderLength {16};
+
   /** number of segments in a MAC address */
   const int kLengthMAC {6};
 
@@ -317,6 +1137,9 @@ namespace ipf {
   /** IPv6 destination address packet offset */
   const int kOffsetIPv6Dst {38};
 
+  /** number of leading packet bytes needed to decode a Packet */
+  const uint32_t kDecodeLength {kOffsetIPv6Dst + kLengthIPv6};
+
   /** ethertype for IPv4 */
   const uint16_t kEtherTypeIPv4 {0x0800};
 
@@ -342,15 +1165,47 @@ namespace ipf {
   const MACAddress kBroadcastMAC {std::vector<uint8_t> (6, 0xFF)};
 
   /** output header line 1 for console display */
-  const std::string kHeader1 {"MAC Address       IPv4 Address    IPv6 Address"};
+  const std::string kHeader1 {"MAC Address       IPv4 Address    IPv6 Address"
+    + std::string(28, ' ') + "   Packets          Bytes First Seen" 
+    + std::string(11, ' ') + "Last Seen"};
 
   /** output header line 2 for console display */
   const std::string kHeader2 {std::string(17, '=') + ' ' + std::string(15, '=')
-    + ' ' + std::string(39, '=')};
+    + ' ' + std::string(39, '=') + ' ' + std::string(10, '=') + ' '
+    + std::string(14, '=') + ' ' + std::string(20, '=') + ' '
+    + std::string(20, '=')};
 
   /** output footer for console display */
   const std::string kFooter1 {std::string(kHeader2.length(), '=')};
 
+  /** output length of the vendor column */
+  const size_t kOutputLengthVendor {24};
+
+  /** output header line 1 with the vendor column */
+  const std::string kVendorHeader1 {kHeader1 + std::string(12, ' ') + "Vendor"};
+
+  /** output header line 2 with the vendor column */
+  const std::string kVendorHeader2 {kHeader2 + ' ' +
+                                    std::string(kOutputLengthVendor, '=')};
+
+  /** output footer with the vendor column */
+  const std::string kVendorFooter1 {std::string(kVendorHeader2.length(), '=')};
+
+  /** vendor shown for locally administered (randomized) MAC addresses */
+  const char kRandomVendor[] {"(random)"};
+
+  /** vendor shown in the summary for unregistered MAC addresses */
+  const char kUnknownVendor[] {"(unknown)"};
+
+  /** output header line 1 of files written before activity was recorded */
+  const std::string kLegacyHeader1 {kHeader1.substr(0, 46)};
+
+  /** output header line 2 of files written before activity was recorded */
+  const std::string kLegacyHeader2 {kHeader2.substr(0, 73)};
+
+  /** output footer of files written before activity was recorded */
+  const std::string kLegacyFooter1 {kFooter1.substr(0, 73)};
+
   /** output position of MAC address */
   const size_t kOutputOffsetMAC {0};
 
@@ -368,6 +1223,42 @@ namespace ipf {
 
   /** output length of IPv6 address */
   const size_t kOutputLengthIPv6 {39};
+
+  /** output position of packet count */
+  const size_t kOutputOffsetPackets {74};
+
+  /** output length of packet count */
+  const size_t kOutputLengthPackets {10};
+
+  /** output position of byte count */
+  const size_t kOutputOffsetBytes {85};
+
+  /** output length of byte count */
+  const size_t kOutputLengthBytes {14};
+
+  /** output position of first-seen time */
+  const size_t kOutputOffsetFirstSeen {100};
+
+  /** output position of last-seen time */
+  const size_t kOutputOffsetLastSeen {121};
+
+  /** output length of first-seen and last-seen times */
+  const size_t kOutputLengthTime {20};
+
+  /** report rows per loader thread, in bytes, below which one thread is used */
+  const size_t kLoadChunkBytes {size_t{1} << 22};
+
+  /** bad report rows described individually before only counting them */
+  const size_t kMaxRowErrors {20};
+
+  /** hosts below which the report is sorted on one thread */
+  const size_t kParallelSortHosts {size_t{1} << 16};
+
+  /** hosts below which the report is formatted on one thread */
+  const size_t kParallelReportHosts {size_t{1} << 15};
+
+  /** hosts each thread formats at a time for a large report */
+  const size_t kReportChunkHosts {size_t{1} << 13};
 }  // namespace ipf
 
 #endif  // IPFORENSICS_IP4AND6_H_
@@ -0,0 +1,181 @@
+/**
+ *  @file ipindex.h
+ *  @brief IPIndex class definitions
+ */
+
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014 Michael Maraya
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef IPFORENSICS_IPINDEX_H_
+#define IPFORENSICS_IPINDEX_H_
+
+#include <stdint.h>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "ipforensics/host.h"
+
+/**
+ *  @brief An IP address seen with more than one MAC address
+ *  @details Raised when an address that belongs to one MAC address shows up
+ *           with another, as happens with ARP or neighbor spoofing and with
+ *           duplicate address assignments.
+ */
+struct Conflict {
+  /** Address that changed hands */
+  std::string address;
+
+  /** MAC address that held the address first */
+  MACAddress first;
+
+  /** MAC address that took the address over */
+  MACAddress second;
+
+  /** Number of times the address changed hands */
+  uint64_t changes {};
+
+  /** Time of the first change in microseconds since the Unix epoch */
+  int64_t first_time {};
+
+  /** Time of the last change in microseconds since the Unix epoch */
+  int64_t last_time {};
+};
+
+/**
+ *  @brief Provide the std::string representation of a Conflict by overloading
+ *         the << operator for std::ostream
+ *  @param out std::ostream output stream
+ *  @param c Conflict instance to display as an std::string
+ *  @retval std::ostream address that contains the std::string representation of
+ *          this Conflict
+ */
+std::ostream& operator<<(std::ostream& out, const Conflict& c);
+
+/**
+ *  @brief Hash function for packed IPv6 addresses
+ */
+struct PackedIPv6Hash {
+  size_t operator()(const Host::PackedIPv6& a) const;
+};
+
+/**
+ *  @brief Reverse index from IPv4 and IPv6 addresses to the MAC address that
+ *         currently holds them
+ *  @details IPForensics claims each address for its MAC address as packets are
+ *           processed.  A claim is a single hash lookup, so address conflicts
+ *           are found as they happen instead of by scanning every host.  Each
+ *           address raises at most one Conflict, which then counts further
+ *           changes of hands.
+ */
+class IPIndex {
+ public:
+  /** Claim result when no Conflict was raised */
+  static const uint32_t kNoConflict {UINT32_MAX};
+
+ private:
+  /** Holder of an address and the Conflict it raised, if any */
+  struct Claim {
+    /** packed MAC address holding the address */
+    uint64_t mac;
+
+    /** index into conflicts_, or kNoConflict */
+    uint32_t conflict;
+  };
+
+  /** IPv4 address holders */
+  std::unordered_map<Host::PackedIPv4, Claim> ipv4_;
+
+  /** IPv6 address holders */
+  std::unordered_map<Host::PackedIPv6, Claim, PackedIPv6Hash> ipv6_;
+
+  /** Conflicts in the order they were found */
+  std::vector<Conflict> conflicts_;
+
+  /**
+   *  @brief Records a claim in one of the indexes
+   *  @param claim existing or newly inserted Claim for the address
+   *  @param inserted true if the Claim was just inserted
+   *  @param address address being claimed, for reporting
+   *  @param mac MAC address claiming it
+   *  @param time packet time in microseconds since the Unix epoch
+   *  @retval uint32_t index into conflicts_ of the Conflict if one was raised
+   *          by this claim, kNoConflict otherwise
+   */
+  uint32_t claim(Claim* claim, bool inserted, const Address& address,
+                 const MACAddress& mac, int64_t time);
+
+ public:
+  /**
+   *  @brief Accessor method for the conflicts_ property
+   *  @retval std::vector<Conflict> conflicts in the order they were found
+   */
+  const std::vector<Conflict>& conflicts() const;
+
+  /**
+   *  @brief MAC address currently holding an IPv4 address
+   *  @param ipv4 address to look up
+   *  @retval MACAddress holder, empty if the address was never claimed
+   */
+  MACAddress owner(const IPv4Address& ipv4) const;
+
+  /**
+   *  @brief MAC address currently holding an IPv6 address
+   *  @param ipv6 address to look up
+   *  @retval MACAddress holder, empty if the address was never claimed
+   */
+  MACAddress owner(const IPv6Address& ipv6) const;
+
+  /**
+   *  @brief Claims an IPv4 address for a MAC address
+   *  @param ipv4 address seen with mac; empty, unspecified, broadcast and
+   *         multicast addresses are ignored
+   *  @param mac MAC address the address was seen with
+   *  @param time packet time in microseconds since the Unix epoch
+   *  @retval uint32_t index into conflicts() of the Conflict if this claim 
+   *          raised one, kNoConflict otherwise
+   */
+  uint32_t claim(const IPv4Address& ipv4, const MACAddress& mac,
+                 int64_t time);
+
+  /**
+   *  @brief Claims an IPv6 address for a MAC address
+   *  @param ipv6 address seen with mac; empty, unspecified and multicast 
+   *         addresses are ignored
+   *  @param mac MAC address the address was seen with
+   *  @param time packet time in microseconds since the Unix epoch
+   *  @retval uint32_t index into conflicts() of the Conflict if this claim 
+   *          raised one, kNoConflict otherwise
+   */
+  uint32_t claim(const IPv6Address& ipv6, const MACAddress& mac,
+                 int64_t time);
+
+  /**
+   *  @brief Removes the addresses a Host still holds from the index
+   *  @param host Host being removed; addresses that have since been claimed by
+   *         another MAC address are left alone
+   */
+  void release(const Host& host);
+};
+
+#endif  // IPFORENSICS_IPINDEX_H_
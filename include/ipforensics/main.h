@@ -31,6 +31,8 @@
 #define IPFORENSICS_MAIN_H_
 
 #include <algorithm>
+#include <string>
+#include <vector>
 #include "ipforensics/ip4and6.h"
 
 /**
@@ -38,4 +40,11 @@
  */
 void usage();
 
+/**
+ *  @brief Display the bad rows skipped while loading a report
+ *  @param errors descriptions of the bad rows, as "file:line: problem"
+ *  @param count number of bad rows, including those not described
+ */
+void report_errors(const std::vector<std::string>& errors, size_t count);
+
 #endif  // IPFORENSICS_MAIN_H_
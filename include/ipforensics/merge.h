@@ -0,0 +1,141 @@
+/**
+ *  @file merge.h
+ *  @brief Merge class definitions
+ */
+
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014 Michael Maraya
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef IPFORENSICS_MERGE_H_
+#define IPFORENSICS_MERGE_H_
+
+#include <stddef.h>
+#include <string>
+#include <vector>
+#include "ipforensics/ip4and6.h"
+#include "ipforensics/snapshot.h"
+
+/**
+ *  @brief Combines the inventories of many sensors into one
+ *  @details Each input is a report or a binary Snapshot and is read on its 
+ *           own worker thread into Snapshot::Record and Snapshot::Alias 
+ *           arrays sorted by MAC address, which are far smaller than Hosts. 
+ *           The sorted runs are then merged with a heap keyed on the packed 
+ *           MAC address.  Hosts that appear in several inputs are combined in
+ *           input order using IPForensics::update_addresses() and 
+ *           Activity::merge(), and each merged Host is appended to 
+ *           IPForensics in MAC order.  Each run is freed as soon as it is 
+ *           exhausted.
+ */
+class Merge {
+ public:
+  /**
+   *  @brief One input file read into memory
+   */
+  struct Run {
+    /** hosts of the file, sorted by MAC address */
+    std::vector<Snapshot::Record> records;
+
+    /** secondary addresses the records index */
+    std::vector<Snapshot::Alias> aliases;
+
+    /** bad rows skipped in a report, as IP46File::errors() */
+    std::vector<std::string> errors;
+  };
+
+ private:
+  /**
+   *  @brief Pointer to the main controller the hosts are merged into
+   */
+  IPForensics* ip_;
+
+  /**
+   *  @brief Files to merge, in the order their hosts are combined
+   */
+  std::vector<std::string> files_;
+
+  /**
+   *  @brief Bad rows skipped by the last run, in file order
+   */
+  std::vector<std::string> errors_;
+
+ public:
+  /**
+   *  @brief Constructs a Merge into the supplied IPForensics instance
+   *  @param ip the IPForensics instance that receives the merged hosts
+   */
+  explicit Merge(IPForensics* ip);
+
+  /**
+   *  @brief Accessor method for the ip_ property
+   *  @retval IPForensics* main controller the hosts are merged into
+   */
+  IPForensics* ip() const;
+
+  /**
+   *  @brief Accessor method for the files_ property
+   *  @retval std::vector<std::string> files to merge
+   */
+  const std::vector<std::string>& files() const;
+
+  /**
+   *  @brief Accessor method for the errors_ property
+   *  @retval std::vector<std::string> bad rows skipped by the last run, as
+   *          "file:line: problem"
+   */
+  const std::vector<std::string>& errors() const;
+
+  /**
+   *  @brief Adds a file to merge
+   *  @param filename report or snapshot file
+   */
+  void add_file(const std::string& filename);
+
+  /**
+   *  @brief Determines if a file is a binary Snapshot rather than a report
+   *  @param filename file to check
+   *  @retval bool true if the file starts with ipf::kSnapshotMagic
+   */
+  static bool snapshot(const std::string& filename);
+
+  /**
+   *  @brief Reads one input file into a Run
+   *  @param filename report or snapshot file
+   *  @param run receives the hosts of the file, sorted by MAC address
+   *  @throws std::runtime_error if the file cannot be read or is neither a
+   *          report nor a snapshot
+   */
+  void read(const std::string& filename, Run* run) const;
+
+  /**
+   *  @brief Reads every file in parallel and merges their hosts into 
+   *         IPForensics
+   *  @retval size_t number of hosts read from all of the files
+   *  @throws std::runtime_error naming the first file that could not be read,
+   *          in which case nothing is added to IPForensics
+   */
+  size_t run();
+};
+
+#endif  // IPFORENSICS_MERGE_H_
@@ -0,0 +1,83 @@
+/**
+ *  @file oui.h
+ *  @brief OUI class definitions
+ */
+
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014 Michael Maraya
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef IPFORENSICS_OUI_H_
+#define IPFORENSICS_OUI_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include "ipforensics/address.h"
+
+/**
+ *  @brief Vendor lookup by the Organizationally Unique Identifier, the first
+ *         three octets of a MAC address
+ *  @details The registrations are compiled into the binary as a sorted 
+ *           array, checked at compile time, so there is nothing to load at
+ *           startup and a lookup is a fixed number of comparisons.
+ *           Locally administered MAC addresses, which include the randomized
+ *           addresses of mobile devices, are never registered and are 
+ *           recognized from a single bit before any lookup.
+ */
+class OUI {
+ public:
+  /**
+   *  @brief One registration
+   */
+  struct Entry {
+    /** first three octets of the MAC address, most significant first */
+    uint32_t prefix;
+
+    /** short vendor name */
+    const char* vendor;
+  };
+
+  /**
+   *  @brief Determines whether a MAC address is locally administered, as
+   *         randomized addresses are
+   *  @param mac MAC address to check
+   *  @retval bool true if the locally administered bit is set
+   */
+  static bool random(const MACAddress& mac);
+
+  /**
+   *  @brief Looks up the vendor of a MAC address
+   *  @param mac MAC address to look up
+   *  @retval const char* vendor name, ipf::kRandomVendor if locally 
+   *          administered, or an empty string if not registered
+   */
+  static const char* vendor(const MACAddress& mac);
+
+  /**
+   *  @brief Number of registrations compiled in
+   *  @retval size_t number of entries
+   */
+  static size_t size();
+};
+
+#endif  // IPFORENSICS_OUI_H_
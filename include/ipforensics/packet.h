@@ -31,6 +31,7 @@
 #define IPFORENSICS_PACKET_H_
 
 #include <stdint.h>
+#include <pcap/pcap.h>
 #include <iostream>  // NOLINT
 #include "ipforensics/host.h"
 
@@ -64,6 +65,12 @@ class Packet {
   /** IPv6 address of the packet destination */
   IPv6Address ipv6_dst_;
 
+  /** Capture time in microseconds since the Unix epoch, 0 if unknown */
+  int64_t time_ {};
+
+  /** Original length of the packet on the wire */
+  uint32_t length_ {};
+
  public:
   /**
    *  @brief Create a Packet instance using the supplied pcap pointer to the
@@ -71,6 +78,14 @@ class Packet {
    */
   explicit Packet(const uint8_t *);
 
+  /**
+   *  @brief Create a Packet instance using the supplied pcap record header and
+   *         pointer to the packet capture data
+   *  @param header record header supplying the capture time and length
+   *  @param data packet capture data
+   */
+  Packet(const struct pcap_pkthdr& header, const uint8_t* data);
+
   /**
    *  @brief Does this Packet have IPv4 information
    *  @retval true if this Packet has IPv4 information, false otherwise
@@ -124,6 +139,18 @@ class Packet {
    *  @retval IPv6Address destination IPv6 address for this Packet
    */
   IPv6Address ipv6_dst() const;
+
+  /**
+   *  @brief Accessor method for the time_ property
+   *  @retval int64_t capture time in microseconds since the Unix epoch
+   */
+  int64_t time() const;
+
+  /**
+   *  @brief Accessor method for the length_ property
+   *  @retval uint32_t original length of the packet
+   */
+  uint32_t length() const;
 };
 
 /**
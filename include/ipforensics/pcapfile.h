@@ -0,0 +1,237 @@
+/**
+ *  @file pcapfile.h
+ *  @brief PcapFile class definitions
+ */
+
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014 Michael Maraya
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef IPFORENSICS_PCAPFILE_H_
+#define IPFORENSICS_PCAPFILE_H_
+
+#include <stdint.h>
+#include <pcap/pcap.h>
+#include <memory>
+#include <string>
+#include <vector>
+#include "ipforensics/ringreader.h"
+
+/**
+ *  @brief Reader for libpcap-format capture files that tracks the byte offset
+ *         of every record
+ *  @details PcapFile reads the classic libpcap file format (microsecond or
+ *           nanosecond timestamps, either byte order) without going through
+ *           libpcap so that the reader always knows where the next record 
+ *           starts.  A record that has not been completely written yet is not
+ *           consumed, which makes it possible to follow a capture file that 
+ *           another process such as tcpdump is still appending to.
+ */
+class PcapFile {
+ public:
+  /**
+   *  @brief How records are read from the capture file
+   */
+  enum class Mode {
+    /** Read whole records through large buffered reads */
+    kStream,
+    /** Read only record headers and the bytes Packet decodes, skipping the 
+     *  rest of each record */
+    kHeaders,
+    /** Read whole records through large O_DIRECT reads that bypass the page
+     *  cache */
+    kDirect,
+    /** Read whole records through io_uring with several reads in flight */
+    kRing
+  };
+
+ private:
+  /** Name of the capture file */
+  std::string name_;
+
+  /** File descriptor of the open capture file, -1 if not open */
+  int fd_ {-1};
+
+  /** File descriptor opened with O_DIRECT in Mode::kDirect, -1 otherwise */
+  int direct_fd_ {-1};
+
+  /** inotify descriptor used to wait for changes, -1 if not available */
+  int notify_ {-1};
+
+  /** How records are read from the capture file */
+  Mode mode_ {Mode::kStream};
+
+  /** File header was written on a host with the opposite byte order */
+  bool swap_ {};
+
+  /** Record timestamps are in nanoseconds rather than microseconds */
+  bool nano_ {};
+
+  /** Link-layer header type from the file header */
+  uint32_t link_type_ {};
+
+  /** Byte offset of the next unread record */
+  uint64_t offset_ {};
+
+  /** Last known size of the capture file, used in Mode::kHeaders */
+  uint64_t size_ {};
+
+  /** Offset up to which the page cache has been told to drop the file */
+  uint64_t advised_ {};
+
+  /** Read buffer holding the file contents starting at buffer_offset_, see
+   *  PcapFile::base() */
+  std::vector<uint8_t> buffer_;
+
+  /** File offset of the first byte in buffer_ */
+  uint64_t buffer_offset_ {};
+
+  /** Number of valid bytes in buffer_ */
+  size_t buffer_length_ {};
+
+  /** Byte at buffer_offset_, inside buffer_ or owned by ring_ */
+  const uint8_t* window_ {};
+
+  /** io_uring reader used in Mode::kRing */
+  std::unique_ptr<RingReader> ring_;
+
+  /** Zero-padded copy of records shorter than ipf::kDecodeLength */
+  std::vector<uint8_t> scratch_;
+
+  /**
+   *  @brief Make sure that length bytes starting at offset are in buffer_
+   *  @param offset file offset of the first byte required
+   *  @param length number of bytes required
+   *  @retval bool true if the bytes are available, false if the file is not
+   *          that long yet
+   */
+  bool fill(uint64_t offset, size_t length);
+
+  /**
+   *  @brief Start of the read buffer, aligned for O_DIRECT
+   *  @retval uint8_t* first byte of buffer_ aligned to ipf::kDirectAlignment
+   */
+  uint8_t* base();
+
+  /**
+   *  @brief Convert a 32-bit field from file byte order to host byte order
+   */
+  uint32_t field(const uint8_t* p) const;
+
+ public:
+  /**
+   *  @brief Creates a PcapFile for the supplied capture file name
+   *  @param name name of the libpcap-format file to read
+   */
+  explicit PcapFile(const std::string name);
+
+  /**
+   *  @brief Closes the capture file if it is still open
+   */
+  ~PcapFile();
+
+  PcapFile(const PcapFile&) = delete;
+  PcapFile& operator=(const PcapFile&) = delete;
+
+  /**
+   *  @brief Accessor method for the name_ property
+   *  @retval std::string name of the capture file
+   */
+  std::string name() const;
+
+  /**
+   *  @brief Accessor method for the link_type_ property
+   *  @retval uint32_t link-layer header type of the capture file
+   */
+  uint32_t link_type() const;
+
+  /**
+   *  @brief Accessor method for the offset_ property
+   *  @retval uint64_t byte offset of the next unread record
+   */
+  uint64_t offset() const;
+
+  /**
+   *  @brief Accessor method for the mode_ property
+   *  @retval Mode how records are read from the capture file
+   */
+  Mode mode() const;
+
+  /**
+   *  @brief Mutator method for the mode_ property
+   *  @param mode how records are read from the capture file
+   */
+  void set_mode(Mode mode);
+
+  /**
+   *  @brief Open the capture file and read the file header
+   *  @retval bool true if the file was opened, false if the file or its
+   *          header has not been completely written yet
+   *  @throws std::runtime_error if the file cannot be opened or is not a 
+   *          libpcap-format file
+   */
+  bool open();
+
+  /**
+   *  @brief Close the capture file
+   */
+  void close();
+
+  /**
+   *  @brief Continue reading from the supplied byte offset
+   *  @param offset byte offset of a record boundary, as returned by offset()
+   */
+  void seek(uint64_t offset);
+
+  /**
+   *  @brief Read the next complete record
+   *  @param header receives the record header
+   *  @param data receives a pointer to the captured bytes, which stays valid
+   *         until the next call.  In Mode::kHeaders only the first 
+   *         ipf::kDecodeLength bytes are read.
+   *  @retval bool true if a record was read, false if no complete record is
+   *          available (yet)
+   *  @throws std::runtime_error if the record header is corrupt
+   */
+  bool next(struct pcap_pkthdr* header, const uint8_t** data);
+
+  /**
+   *  @brief Block until the capture file or its directory changes
+   *  @details Uses inotify where available and falls back to sleeping for
+   *           the timeout otherwise
+   *  @param timeout maximum number of milliseconds to wait
+   */
+  void wait(int timeout);
+
+  /**
+   *  @brief Name of the file that follows the supplied one in a rotation
+   *  @details tcpdump -C and -W append a sequence number to the file name so
+   *           the next file is found by incrementing the trailing number (and
+   *           keeping its width) or appending 1 if there is no number.
+   *  @param name name of a capture file in a rotation sequence
+   *  @retval std::string name of the next file in the sequence
+   */
+  static std::string rotation(const std::string& name);
+};
+
+#endif  // IPFORENSICS_PCAPFILE_H_
@@ -0,0 +1,144 @@
+/**
+ *  @file prefixtrie.h
+ *  @brief PrefixTrie class definitions
+ */
+
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014 Michael Maraya
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef IPFORENSICS_PREFIXTRIE_H_
+#define IPFORENSICS_PREFIXTRIE_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <array>
+#include <vector>
+
+/**
+ *  @brief Path-compressed binary (Patricia) trie of address prefixes
+ *  @details Keys are up to 128 bits, most significant bit of the first octet 
+ *           first, so one class serves both IPv4 and IPv6.  Each node stores
+ *           the whole prefix it stands for, and nodes with a single child are
+ *           collapsed, so a lookup visits at most one node per distinct prefix 
+ *           length on its path, however long the prefixes are.  Nodes live in
+ *           one std::vector and refer to each other by index.
+ */
+class PrefixTrie {
+ public:
+  /** Address octets in network order; unused trailing octets are zero */
+  typedef std::array<uint8_t, 16> Key;
+
+ private:
+  /**
+   *  @brief A branch point or stored prefix
+   */
+  struct Node {
+    /** prefix bits, zero past length */
+    Key key;
+
+    /** number of significant bits in key */
+    int length;
+
+    /** true if this prefix was inserted, false if only a branch point */
+    bool prefix;
+
+    /** indexes of the children continuing with a 0 and a 1 bit, or -1 */
+    int32_t child[2];
+  };
+
+  /** Nodes, the root (the empty prefix) first */
+  std::vector<Node> nodes_;
+
+  /** Number of prefixes inserted */
+  size_t size_ {};
+
+  /**
+   *  @brief Bit of a key
+   *  @param key key to read
+   *  @param i bit index, 0 being the most significant bit of key[0]
+   *  @retval int 0 or 1
+   */
+  static int bit(const Key& key, int i);
+
+  /**
+   *  @brief Number of leading bits two keys have in common
+   *  @param a first key
+   *  @param b second key
+   *  @param limit maximum number of bits to compare
+   *  @retval int number of equal leading bits, at most limit
+   */
+  static int common(const Key& a, const Key& b, int limit);
+
+  /**
+   *  @brief Clears the bits of a key past a length
+   *  @param key key to truncate
+   *  @param length number of bits to keep
+   *  @retval Key truncated key
+   */
+  static Key truncate(Key key, int length);
+
+  /**
+   *  @brief Appends a node
+   *  @param key prefix bits
+   *  @param length number of significant bits
+   *  @param prefix true if the node is an inserted prefix
+   *  @retval int32_t index of the new node
+   */
+  int32_t add_node(const Key& key, int length, bool prefix);
+
+ public:
+  /**
+   *  @brief Constructs an empty PrefixTrie
+   */
+  PrefixTrie();
+
+  /**
+   *  @brief Number of prefixes inserted
+   *  @retval size_t number of distinct prefixes
+   */
+  size_t size() const;
+
+  /**
+   *  @brief Determines whether no prefix has been inserted
+   *  @retval bool true if empty, false otherwise
+   */
+  bool empty() const;
+
+  /**
+   *  @brief Adds a prefix
+   *  @param key prefix bits; bits past length are ignored
+   *  @param length prefix length in bits, at most 128
+   */
+  void insert(const Key& key, int length);
+
+  /**
+   *  @brief Determines whether an address falls within any inserted prefix
+   *  @param key address bits
+   *  @param bits length of the address in bits, 32 or 128
+   *  @retval bool true if a prefix covers the address, false otherwise
+   */
+  bool contains(const Key& key, int bits) const;
+};
+
+#endif  // IPFORENSICS_PREFIXTRIE_H_
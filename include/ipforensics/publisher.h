@@ -0,0 +1,149 @@
+/**
+ *  @file publisher.h
+ *  @brief Publisher class definitions
+ */
+
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014 Michael Maraya
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef IPFORENSICS_PUBLISHER_H_
+#define IPFORENSICS_PUBLISHER_H_
+
+#include <stdint.h>
+#include <sys/types.h>
+#include <chrono>  // NOLINT
+#include "ipforensics/ip4and6.h"
+
+/**
+ *  @brief Writes the report and snapshot of a long-running capture in the
+ *         background
+ *  @details Each write runs in a forked child process, which gets a 
+ *           copy-on-write image of the host table as it was at the fork.  The
+ *           child writes the report and a full snapshot to temporary files, 
+ *           renames them into place and exits, while the capture carries on 
+ *           in the parent and only pays for the pages it changes meanwhile.  
+ *           A write is due every interval seconds of wall-clock time, and 
+ *           SIGHUP asks for one at the next poll().  Only one write runs at a
+ *           time; one that comes due while another is running waits for it.
+ *           The capture must not be running other threads when a write is 
+ *           started.
+ */
+class Publisher {
+ private:
+  /**
+   *  @brief Pointer to the main controller whose hosts are written
+   */
+  IPForensics* ip_;
+
+  /**
+   *  @brief Seconds between writes, 0 to only write when asked by SIGHUP
+   */
+  int interval_ {};
+
+  /**
+   *  @brief Process ID of the running write, -1 if none
+   */
+  pid_t child_ {-1};
+
+  /**
+   *  @brief Time the next write is due
+   */
+  std::chrono::steady_clock::time_point due_;
+
+  /**
+   *  @brief True if a write was asked for and has not started yet
+   */
+  bool requested_ {};
+
+  /**
+   *  @brief Number of writes that completed
+   */
+  uint64_t written_ {};
+
+  /**
+   *  @brief Number of writes that failed
+   */
+  uint64_t failed_ {};
+
+ public:
+  /**
+   *  @brief Constructs a Publisher for the supplied IPForensics instance and
+   *         starts handling SIGHUP
+   *  @param ip the IPForensics instance whose hosts are written
+   *  @param interval seconds between writes, 0 to only write on SIGHUP
+   */
+  Publisher(IPForensics* ip, int interval);
+
+  /**
+   *  @brief Waits for a running write and restores the default SIGHUP 
+   *         handling
+   */
+  ~Publisher();
+
+  Publisher(const Publisher&) = delete;
+  Publisher& operator=(const Publisher&) = delete;
+
+  /**
+   *  @brief Accessor method for the interval_ property
+   *  @retval int seconds between writes
+   */
+  int interval() const;
+
+  /**
+   *  @brief Accessor method for the written_ property
+   *  @retval uint64_t number of writes that completed
+   */
+  uint64_t written() const;
+
+  /**
+   *  @brief Accessor method for the failed_ property
+   *  @retval uint64_t number of writes that failed
+   */
+  uint64_t failed() const;
+
+  /**
+   *  @brief Determines if a write is running, collecting it if it has ended
+   *  @retval bool true if a write is still running
+   */
+  bool busy();
+
+  /**
+   *  @brief Starts a write if one is due or was asked for and none is running
+   *  @details Cheap enough to call every second of capture.
+   */
+  void poll();
+
+  /**
+   *  @brief Waits for the running write, if any, to end
+   */
+  void finish();
+
+ private:
+  /**
+   *  @brief Forks the child process that writes the report and snapshot
+   */
+  void start();
+};
+
+#endif  // IPFORENSICS_PUBLISHER_H_
@@ -0,0 +1,109 @@
+/**
+ *  @file radixsort.h
+ *  @brief radix_sort function template definitions
+ */
+
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014 Michael Maraya
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef IPFORENSICS_RADIXSORT_H_
+#define IPFORENSICS_RADIXSORT_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <algorithm>
+#include <array>
+#include <utility>
+#include <vector>
+#include "ipforensics/threads.h"
+
+/**
+ *  @brief A value and the fixed-length byte key it is sorted by
+ *  @tparam N number of key bytes, most significant first
+ *  @tparam T value type
+ */
+template <size_t N, typename T>
+struct Keyed {
+  /** sort key, compared byte by byte from the first */
+  std::array<uint8_t, N> key;
+
+  /** value carried along with the key */
+  T value;
+};
+
+/**
+ *  @brief Sorts items by their keys with a stable least significant digit 
+ *         radix sort
+ *  @details Each pass counts the items by one key byte and scatters them into
+ *           a second array, from the last key byte to the first.  With 
+ *           several threads, each counts and scatters its own contiguous 
+ *           share of the items into bucket offsets reserved after those of 
+ *           the threads before it, so the sort stays stable.  Passes over a 
+ *           byte that every key shares, such as the leading bytes of 
+ *           addresses in one network, move nothing and are skipped.
+ *  @param items items to sort, equal keys keeping their order
+ *  @param threads number of threads to use, 1 or more
+ */
+template <size_t N, typename T>
+void radix_sort(std::vector<Keyed<N, T>>* items, size_t threads) {
+  size_t n = items->size();
+  if (n < 2) return;
+  threads = std::max<size_t>(1, std::min(threads, n));
+  std::vector<Keyed<N, T>> buffer(n);
+  std::vector<Keyed<N, T>>* from = items;
+  std::vector<Keyed<N, T>>* to = &buffer;
+  std::vector<std::array<size_t, 256>> counts(threads);
+  auto first = [n, threads](size_t t) { return n * t / threads; };
+  for (size_t d = N; d-- > 0; ) {
+    run_threads(threads, [&](size_t t) {
+      counts[t].fill(0);
+      for (size_t i = first(t); i < first(t + 1); ++i) {
+        ++counts[t][(*from)[i].key[d]];
+      }
+    });
+    size_t total = 0;
+    bool shared = false;
+    for (size_t b = 0; b < 256; ++b) {
+      size_t bucket = 0;
+      for (size_t t = 0; t < threads; ++t) {
+        size_t count = counts[t][b];
+        counts[t][b] = total;
+        total += count;
+        bucket += count;
+      }
+      if (bucket == n) shared = true;
+    }
+    if (shared) continue;
+    run_threads(threads, [&](size_t t) {
+      std::array<size_t, 256>& next = counts[t];
+      for (size_t i = first(t); i < first(t + 1); ++i) {
+        (*to)[next[(*from)[i].key[d]]++] = (*from)[i];
+      }
+    });
+    std::swap(from, to);
+  }
+  if (from != items) items->swap(buffer);
+}
+
+#endif  // IPFORENSICS_RADIXSORT_H_
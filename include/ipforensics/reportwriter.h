@@ -0,0 +1,435 @@
+/**
+ *  @file reportwriter.h
+ *  @brief ReportWriter class hierarchy definitions
+ */
+
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014 Michael Maraya
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef IPFORENSICS_REPORTWRITER_H_
+#define IPFORENSICS_REPORTWRITER_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <memory>
+#include <string>
+#include <vector>
+#include "ipforensics/host.h"
+
+/**
+ *  @brief Base class for writing the host report in one output format
+ *  @details A ReportWriter formats each host straight into a large output 
+ *           buffer with the allocation-free Address formatters and hands the
+ *           buffer to write(2) only when it fills up, so a report takes a few
+ *           large writes however many hosts it has.  Descendant classes lay 
+ *           out the rows; begin(), host() and end() are called once per 
+ *           report, host and report respectively.  hosts() spreads the 
+ *           host() calls of a large report over several part() writers.
+ */
+class ReportWriter {
+ public:
+  /**
+   *  @brief Output formats
+   */
+  enum class Format {
+    /** Fixed-width table, the default and the only format read back */
+    kTable,
+    /** Comma-separated values with a header row */
+    kCSV,
+    /** One JSON object per host per line */
+    kNDJSON,
+    /** One JSON document with the hosts and the summary counts */
+    kJSON
+  };
+
+  /**
+   *  @brief Orders the hosts can be written in
+   */
+  enum class Order {
+    /** By MAC address, the order of the host table */
+    kMAC,
+    /** By primary IPv4 address, hosts without one last */
+    kIPv4,
+    /** By primary IPv6 address, hosts without one last */
+    kIPv6
+  };
+
+  /**
+   *  @brief Host counts shown after the hosts
+   */
+  struct Summary {
+    /** Number of hosts */
+    size_t hosts;
+
+    /** Hosts with only an IPv4 address */
+    size_t ipv4;
+
+    /** Hosts with only an IPv6 address */
+    size_t ipv6;
+
+    /** Hosts with both */
+    size_t dual;
+
+    /** Distinct addresses skipped because they were excluded */
+    size_t excluded;
+
+    /** Distinct broadcast, multicast and other fake addresses skipped */
+    size_t fake;
+  };
+
+ private:
+  /** Output buffer */
+  std::vector<char> buffer_;
+
+  /** Number of bytes of buffer_ in use */
+  size_t used_ {};
+
+  /** File descriptor written to, -1 if not open */
+  int fd_ {-1};
+
+  /** Name of the output file, empty for standard output */
+  std::string filename_;
+
+  /** Temporary file renamed over filename_, empty if written in place */
+  std::string temp_;
+
+ protected:
+  /** Show the vendor of each host */
+  bool vendors_ {};
+
+  /**
+   *  @brief Makes room in the buffer, flushing it if needed
+   *  @param size number of bytes about to be written
+   *  @retval char* where to write them
+   */
+  char* reserve(size_t size);
+
+  /**
+   *  @brief Marks the bytes written after reserve() as used
+   *  @param end end of the bytes written
+   */
+  void commit(const char* end);
+
+  /**
+   *  @brief Writes the buffer to the output
+   *  @throws std::runtime_error if the output cannot be written
+   */
+  void flush();
+
+  /**
+   *  @brief Upper bound on the bytes host() writes for a Host
+   *  @param host Host about to be written
+   *  @param vendor vendor name of the Host
+   *  @retval size_t number of bytes to reserve
+   */
+  static size_t bound(const Host& host, const char* vendor);
+
+ public:
+  /**
+   *  @brief Creates a ReportWriter with an empty buffer of 
+   *         ipf::kReportBufferSize bytes
+   *  @param vendors show the vendor of each host
+   */
+  explicit ReportWriter(bool vendors);
+
+  /**
+   *  @brief Closes the output if still open, ignoring errors
+   */
+  virtual ~ReportWriter();
+
+  /**
+   *  @brief Opens the output
+   *  @param filename file to write, atomically replaced by close() if it
+   *         exists, or empty for standard output
+   *  @throws std::runtime_error if the file cannot be opened
+   */
+  void open(const std::string& filename);
+
+  /**
+   *  @brief Writes the rest of the buffer and closes the output, renaming
+   *         the temporary file into place
+   *  @throws std::runtime_error if the output cannot be written
+   */
+  void close();
+
+  /**
+   *  @brief Writes whatever comes before the hosts
+   */
+  virtual void begin() = 0;
+
+  /**
+   *  @brief Writes one host
+   *  @param host Host to write
+   *  @param activity Activity of the Host
+   */
+  virtual void host(const Host& host, const Activity& activity) = 0;
+
+  /**
+   *  @brief Creates a writer of the same format and state, without an 
+   *         output, to format a share of the hosts into its buffer
+   *  @retval std::unique_ptr<ReportWriter> new writer
+   */
+  virtual std::unique_ptr<ReportWriter> part() const = 0;
+
+  /**
+   *  @brief Writes many hosts, formatting them on several threads
+   *  @param hosts hosts to write, in order
+   *  @param activities Activity of each Host, indexed by Host::slot()
+   *  @param threads number of threads to format with
+   *  @throws std::runtime_error if the output cannot be written
+   *  @throws std::bad_alloc if a formatting thread runs out of memory, 
+   *          rethrown once all threads have finished
+   */
+  void hosts(const std::vector<const Host*>& hosts,
+             const Activity* activities, size_t threads);
+
+  /**
+   *  @brief Writes whatever comes after the hosts
+   *  @param summary host counts
+   */
+  virtual void end(const Summary& summary) = 0;
+
+  /**
+   *  @brief Writes only the summary counts, in place of a whole report
+   *  @param summary host counts
+   */
+  virtual void summary(const Summary& summary) = 0;
+
+  /**
+   *  @brief Adds text that follows the report, such as the top talkers; only
+   *         the table format shows it
+   *  @param text text to add
+   */
+  virtual void text(const std::string& text);
+
+  /**
+   *  @brief Parses an output format name
+   *  @param name table, csv, ndjson or json
+   *  @retval Format matching the name
+   *  @throws std::invalid_argument if the name is not known
+   */
+  static Format format(const std::string& name);
+
+  /**
+   *  @brief Parses a host order name
+   *  @param name mac, ipv4 or ipv6
+   *  @retval Order matching the name
+   *  @throws std::invalid_argument if the name is not known
+   */
+  static Order order(const std::string& name);
+
+  /**
+   *  @brief Creates a ReportWriter for an output format
+   *  @param format output format
+   *  @param vendors show the vendor of each host
+   *  @retval std::unique_ptr<ReportWriter> new writer
+   */
+  static std::unique_ptr<ReportWriter> create(Format format, bool vendors);
+};
+
+/**
+ *  @brief Writes the fixed-width host table, byte for byte as operator<< for
+ *         Host and Activity would
+ */
+class TableWriter : public ReportWriter {
+ public:
+  /**
+   *  @brief Creates a TableWriter
+   *  @param vendors show the vendor column
+   */
+  explicit TableWriter(bool vendors) : ReportWriter(vendors) {}
+
+  /**
+   *  @brief Creates a TableWriter for a share of the hosts
+   *  @retval std::unique_ptr<ReportWriter> new writer
+   */
+  virtual std::unique_ptr<ReportWriter> part() const override;
+
+  /**
+   *  @brief Writes the column headers
+   */
+  virtual void begin() override;
+
+  /**
+   *  @brief Writes the row of a host and its alias rows
+   *  @param host Host to write
+   *  @param activity Activity of the Host
+   */
+  virtual void host(const Host& host, const Activity& activity) override;
+
+  /**
+   *  @brief Writes the footer and the summary line
+   *  @param summary host counts
+   */
+  virtual void end(const Summary& summary) override;
+
+  /**
+   *  @brief Writes the summary line
+   *  @param summary host counts
+   */
+  virtual void summary(const Summary& summary) override;
+
+  /**
+   *  @brief Appends text after the summary line
+   *  @param text text to add
+   */
+  virtual void text(const std::string& text) override;
+};
+
+/**
+ *  @brief Writes one comma-separated row per host, with the secondary 
+ *         addresses space-separated in their own columns
+ */
+class CSVWriter : public ReportWriter {
+ public:
+  /**
+   *  @brief Creates a CSVWriter
+   *  @param vendors add a vendor column
+   */
+  explicit CSVWriter(bool vendors) : ReportWriter(vendors) {}
+
+  /**
+   *  @brief Creates a CSVWriter for a share of the hosts
+   *  @retval std::unique_ptr<ReportWriter> new writer
+   */
+  virtual std::unique_ptr<ReportWriter> part() const override;
+
+  /**
+   *  @brief Writes the header row
+   */
+  virtual void begin() override;
+
+  /**
+   *  @brief Writes the row of a host
+   *  @param host Host to write
+   *  @param activity Activity of the Host
+   */
+  virtual void host(const Host& host, const Activity& activity) override;
+
+  /**
+   *  @brief Writes nothing; CSV has no summary
+   *  @param summary host counts
+   */
+  virtual void end(const Summary& summary) override;
+
+  /**
+   *  @brief Writes a header row and a row of the summary counts
+   *  @param summary host counts
+   */
+  virtual void summary(const Summary& summary) override;
+};
+
+/**
+ *  @brief Writes one JSON object per host, one per line
+ */
+class NDJSONWriter : public ReportWriter {
+ protected:
+  /**
+   *  @brief Writes the JSON object of a host without a line break
+   *  @param host Host to write
+   *  @param activity Activity of the Host
+   */
+  void object(const Host& host, const Activity& activity);
+
+ public:
+  /**
+   *  @brief Creates an NDJSONWriter
+   *  @param vendors add a vendor member
+   */
+  explicit NDJSONWriter(bool vendors) : ReportWriter(vendors) {}
+
+  /**
+   *  @brief Creates a NDJSONWriter for a share of the hosts
+   *  @retval std::unique_ptr<ReportWriter> new writer
+   */
+  virtual std::unique_ptr<ReportWriter> part() const override;
+
+  /**
+   *  @brief Writes nothing
+   */
+  virtual void begin() override;
+
+  /**
+   *  @brief Writes the object of a host on its own line
+   *  @param host Host to write
+   *  @param activity Activity of the Host
+   */
+  virtual void host(const Host& host, const Activity& activity) override;
+
+  /**
+   *  @brief Writes nothing; NDJSON has no summary
+   *  @param summary host counts
+   */
+  virtual void end(const Summary& summary) override;
+
+  /**
+   *  @brief Writes a summary object on its own line
+   *  @param summary host counts
+   */
+  virtual void summary(const Summary& summary) override;
+};
+
+/**
+ *  @brief Writes a JSON document with a hosts array of the NDJSONWriter 
+ *         objects and a summary object
+ */
+class JSONWriter : public NDJSONWriter {
+ private:
+  /** No host written yet */
+  bool first_ {true};
+
+ public:
+  /**
+   *  @brief Creates a JSONWriter
+   *  @param vendors add a vendor member
+   */
+  explicit JSONWriter(bool vendors) : NDJSONWriter(vendors) {}
+
+  /**
+   *  @brief Creates a JSONWriter for a share of the hosts, continuing the
+   *         hosts array
+   *  @retval std::unique_ptr<ReportWriter> new writer
+   */
+  virtual std::unique_ptr<ReportWriter> part() const override;
+
+  /**
+   *  @brief Opens the document and its hosts array
+   */
+  virtual void begin() override;
+
+  /**
+   *  @brief Writes the object of a host as the next array element
+   *  @param host Host to write
+   *  @param activity Activity of the Host
+   */
+  virtual void host(const Host& host, const Activity& activity) override;
+
+  /**
+   *  @brief Closes the hosts array and writes the summary object
+   *  @param summary host counts
+   */
+  virtual void end(const Summary& summary) override;
+};
+
+#endif  // IPFORENSICS_REPORTWRITER_H_
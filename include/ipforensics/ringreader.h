@@ -0,0 +1,182 @@
+/**
+ *  @file ringreader.h
+ *  @brief RingReader class definitions
+ */
+
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014 Michael Maraya
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef IPFORENSICS_RINGREADER_H_
+#define IPFORENSICS_RINGREADER_H_
+
+#include <stdint.h>
+#include <sys/uio.h>
+#include <vector>
+
+/**
+ *  @brief Sequential file reader that keeps several large reads in flight
+ *         through Linux io_uring
+ *  @details RingReader divides a region of memory into ipf::kRingChunks 
+ *           chunks of ipf::kRingChunkSize bytes, registers it with the kernel
+ *           and keeps a read queued for every chunk that is not being 
+ *           consumed, so decoding one chunk overlaps reading the next ones 
+ *           without an extra thread.  A chunk is queued again for the next 
+ *           part of the file as soon as the caller has moved past it.  On 
+ *           kernels (or sandboxes) without io_uring, available() returns false
+ *           and the caller is expected to fall back to plain reads.
+ */
+class RingReader {
+ private:
+  /** File descriptor being read */
+  int fd_;
+
+  /** io_uring file descriptor, -1 if io_uring is not available */
+  int ring_ {-1};
+
+  /** Chunks are registered with the kernel and read with READ_FIXED */
+  bool fixed_ {};
+
+  /** Submission queue ring mapping */
+  void* sq_ring_ {};
+
+  /** Size of the submission queue ring mapping */
+  size_t sq_ring_size_ {};
+
+  /** Completion queue ring mapping, may be the same as sq_ring_ */
+  void* cq_ring_ {};
+
+  /** Size of the completion queue ring mapping */
+  size_t cq_ring_size_ {};
+
+  /** Submission queue entries mapping */
+  void* sqes_ {};
+
+  /** Size of the submission queue entries mapping */
+  size_t sqes_size_ {};
+
+  /** Submission queue tail, mask and index array inside sq_ring_ */
+  unsigned* sq_tail_ {};
+  unsigned* sq_mask_ {};
+  unsigned* sq_array_ {};
+
+  /** Completion queue head, tail, mask and entries inside cq_ring_ */
+  unsigned* cq_head_ {};
+  unsigned* cq_tail_ {};
+  unsigned* cq_mask_ {};
+  void* cqes_ {};
+
+  /** Backing memory for the chunks plus one extra chunk for wraparound */
+  std::vector<uint8_t> memory_;
+
+  /** Page-aligned start of the first chunk inside memory_ */
+  uint8_t* chunks_ {};
+
+  /** One iovec per chunk, used when the chunks could not be registered */
+  std::vector<struct iovec> iovecs_;
+
+  /** Bytes read into each chunk, or kPending while the read is in flight */
+  std::vector<int64_t> length_;
+
+  /** File offset of chunk sequence number 0 */
+  uint64_t base_ {};
+
+  /** Sequence number of the oldest chunk still in use */
+  uint64_t head_ {};
+
+  /** Sequence number of the first chunk that came back short (end of file) */
+  uint64_t end_ {UINT64_MAX};
+
+  /** Number of reads queued but not yet submitted to the kernel */
+  unsigned queued_ {};
+
+  /** Number of reads queued or in flight */
+  unsigned in_flight_ {};
+
+  /** Reading has started, see RingReader::restart */
+  bool started_ {};
+
+  /** Marks a chunk whose read has not completed */
+  static const int64_t kPending {-1};
+
+  /**
+   *  @brief Queue the read for the supplied chunk sequence number
+   *  @param sequence chunk sequence number relative to base_
+   */
+  void queue(uint64_t sequence);
+
+  /**
+   *  @brief Submit queued reads and collect completed ones
+   *  @param wait block until at least one read completes
+   */
+  void reap(bool wait);
+
+  /**
+   *  @brief Wait for every read in flight, discarding their results
+   *  @details Never throws, so it is safe in the destructor.  Failed reads
+   *           are dropped; it gives up if io_uring_enter itself fails.
+   */
+  void drain();
+
+  /**
+   *  @brief Discard all chunks and start reading at the supplied offset
+   *  @param offset file offset of the first chunk
+   */
+  void restart(uint64_t offset);
+
+ public:
+  /**
+   *  @brief Sets up an io_uring instance for reading the supplied file
+   *  @param fd file descriptor open for reading
+   */
+  explicit RingReader(int fd);
+
+  /**
+   *  @brief Waits for reads in flight and releases the io_uring instance
+   */
+  ~RingReader();
+
+  RingReader(const RingReader&) = delete;
+  RingReader& operator=(const RingReader&) = delete;
+
+  /**
+   *  @brief Check if io_uring could be set up
+   *  @retval bool true if the reader can be used, false otherwise
+   */
+  bool available() const;
+
+  /**
+   *  @brief Access a range of the file
+   *  @details Offsets are expected to increase from call to call; chunks 
+   *           before offset are recycled.  A jump outside the chunks in use
+   *           restarts reading at offset.
+   *  @param offset file offset of the first byte required
+   *  @param length number of bytes required, at most ipf::kRingChunkSize
+   *  @retval const uint8_t* contiguous copy of the range, valid until the 
+   *          next call, or nullptr if the file ends before offset + length
+   *  @throws std::runtime_error if a read fails
+   */
+  const uint8_t* data(uint64_t offset, size_t length);
+};
+
+#endif  // IPFORENSICS_RINGREADER_H_
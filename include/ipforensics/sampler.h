@@ -0,0 +1,174 @@
+/**
+ *  @file sampler.h
+ *  @brief Sampler class definitions
+ */
+
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014 Michael Maraya
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef IPFORENSICS_SAMPLER_H_
+#define IPFORENSICS_SAMPLER_H_
+
+#include <stdint.h>
+#include <pcap/pcap.h>
+#include <string>
+#include <unordered_map>
+
+/**
+ *  @brief Decides which packets are decoded when only a sample is wanted and
+ *         estimates how many hosts the sample missed
+ *  @details Sampler is consulted with the raw record before a Packet is built
+ *           so skipped packets cost almost nothing.  It keeps a count of how 
+ *           many sampled packets each MAC address appeared in; hosts seen only
+ *           once or twice are what the coverage estimates are based on.
+ */
+class Sampler {
+ public:
+  /**
+   *  @brief How packets are selected
+   */
+  enum class Method {
+    /** Every rate-th packet */
+    kCount,
+    /** One in rate packets within each ipf::kSampleStratum second interval,
+     *  starting at a different position in each interval */
+    kTime,
+    /** All packets between the MAC address pairs whose hash selects them */
+    kFlow
+  };
+
+ private:
+  /** How packets are selected */
+  Method method_ {Method::kCount};
+
+  /** Keep one in rate_ packets; 1 keeps every packet */
+  uint32_t rate_ {1};
+
+  /** Number of packets offered to keep() */
+  uint64_t seen_ {};
+
+  /** Number of packets kept */
+  uint64_t kept_ {};
+
+  /** Start of the current time stratum in seconds */
+  int64_t stratum_ {-1};
+
+  /** Number of packets seen in the current time stratum */
+  uint32_t stratum_seen_ {};
+
+  /** Position of the kept packets within the current time stratum */
+  uint32_t stratum_pick_ {};
+
+  /** Number of sampled packets each unicast MAC address appeared in */
+  std::unordered_map<uint64_t, uint32_t> observations_;
+
+  /**
+   *  @brief Count one observation of the MAC address at p
+   *  @param p first byte of a MAC address in the raw packet
+   */
+  void observe(const uint8_t* p);
+
+ public:
+  /**
+   *  @brief Accessor method for the method_ property
+   *  @retval Method how packets are selected
+   */
+  Method method() const;
+
+  /**
+   *  @brief Accessor method for the rate_ property
+   *  @retval uint32_t one in rate packets is kept
+   */
+  uint32_t rate() const;
+
+  /**
+   *  @brief Accessor method for the seen_ property
+   *  @retval uint64_t number of packets offered
+   */
+  uint64_t seen() const;
+
+  /**
+   *  @brief Accessor method for the kept_ property
+   *  @retval uint64_t number of packets kept
+   */
+  uint64_t kept() const;
+
+  /**
+   *  @brief Mutator method for the method_ property
+   *  @param method how packets are selected
+   */
+  void set_method(Method method);
+
+  /**
+   *  @brief Mutator method for the rate_ property
+   *  @param rate keep one in rate packets
+   */
+  void set_rate(uint32_t rate);
+
+  /**
+   *  @brief Decide whether a packet should be decoded
+   *  @param header record header of the packet
+   *  @param data raw packet bytes, at least ipf::kDecodeLength long
+   *  @retval bool true if the packet is part of the sample
+   */
+  bool keep(const struct pcap_pkthdr& header, const uint8_t* data);
+
+  /**
+   *  @brief Good-Turing estimate of the sample coverage
+   *  @details One minus the share of host observations that belong to hosts
+   *           observed exactly once; this is the estimated probability that a
+   *           host observation in the full capture belongs to a host the 
+   *           sample found.
+   *  @retval double coverage between 0 and 1
+   */
+  double coverage() const;
+
+  /**
+   *  @brief Chao1 estimate of the number of hosts the sample missed
+   *  @details f1 * f1 / (2 * f2) where f1 and f2 are the number of hosts 
+   *           observed exactly once and twice, f1 * (f1 - 1) / 2 if f2 is 0.
+   *  @retval double estimated number of unicast hosts not found
+   */
+  double missed() const;
+
+  /**
+   *  @brief Parse a sampling method name
+   *  @param name count, time or flow
+   *  @retval Method matching the name
+   *  @throws std::invalid_argument if the name is not known
+   */
+  static Method method(const std::string& name);
+};
+
+/**
+ *  @brief Provide the std::string representation of a Sampler by overloading
+ *         the << operator for std::ostream
+ *  @param out std::ostream output stream
+ *  @param s Sampler instance to display as an std::string
+ *  @retval std::ostream address that contains the std::string representation of
+ *          this Sampler
+ */
+std::ostream& operator<<(std::ostream& out, const Sampler& s);
+
+#endif  // IPFORENSICS_SAMPLER_H_
@@ -0,0 +1,194 @@
+/**
+ *  @file sketch.h
+ *  @brief Sketch class definitions
+ */
+
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014 Michael Maraya
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef IPFORENSICS_SKETCH_H_
+#define IPFORENSICS_SKETCH_H_
+
+#include <stdint.h>
+#include <array>
+#include <map>
+#include <string>
+#include "ipforensics/address.h"
+#include "ipforensics/hyperloglog.h"
+
+/**
+ *  @brief Memory-bounded estimates of the host inventory
+ *  @details Sketch keeps HyperLogLog estimators of the distinct MAC, IPv4 and
+ *           IPv6 addresses seen, and of the MAC addresses seen with each
+ *           family.  The number of dual-stack hosts is estimated from those
+ *           by inclusion-exclusion, so its absolute error is that of the 
+ *           larger counts.  Each IPv4 /24 and IPv6 /64 subnet, up to 
+ *           ipf::kSketchMaxSubnets of them, also gets estimators of its 
+ *           distinct MAC and IP addresses; further subnets are only counted,
+ *           by one more estimator.  Every estimator is 4 KB whatever
+ *           the number of hosts, and sketches saved by different runs merge
+ *           into the sketch of the combined traffic.
+ */
+class Sketch {
+ public:
+  /**
+   *  @brief Estimators for one subnet
+   */
+  struct Subnet {
+    /** MAC addresses seen with an address in the subnet */
+    HyperLogLog macs;
+
+    /** addresses seen in the subnet */
+    HyperLogLog addresses;
+  };
+
+ private:
+  /** All MAC addresses */
+  HyperLogLog macs_;
+
+  /** All IPv4 addresses */
+  HyperLogLog ipv4_;
+
+  /** All IPv6 addresses */
+  HyperLogLog ipv6_;
+
+  /** MAC addresses seen with an IPv4 address */
+  HyperLogLog macs_ipv4_;
+
+  /** MAC addresses seen with an IPv6 address */
+  HyperLogLog macs_ipv6_;
+
+  /** IPv4 /24 subnets by their first three octets */
+  std::map<uint32_t, Subnet> ipv4_subnets_;
+
+  /** IPv6 /64 subnets by their first eight octets */
+  std::map<uint64_t, Subnet> ipv6_subnets_;
+
+  /** Subnets seen once there were already ipf::kSketchMaxSubnets */
+  HyperLogLog dropped_;
+
+  /**
+   *  @brief Finds or creates the estimators of a subnet
+   *  @param subnets IPv4 or IPv6 subnets
+   *  @param key subnet key
+   *  @param hash hash of the subnet, counted in dropped_ if it does not fit
+   *  @retval Subnet* estimators, nullptr if the subnet is new and there are
+   *          already ipf::kSketchMaxSubnets subnets
+   */
+  template <typename K>
+  Subnet* subnet(std::map<K, Subnet>* subnets, K key, uint64_t hash);
+
+ public:
+  /**
+   *  @brief Estimated number of distinct MAC addresses
+   *  @retval double estimate
+   */
+  double macs() const;
+
+  /**
+   *  @brief Estimated number of distinct IPv4 addresses
+   *  @retval double estimate
+   */
+  double ipv4() const;
+
+  /**
+   *  @brief Estimated number of distinct IPv6 addresses
+   *  @retval double estimate
+   */
+  double ipv6() const;
+
+  /**
+   *  @brief Estimated number of MAC addresses seen with both IPv4 and IPv6
+   *  @retval double estimate, never negative
+   */
+  double dual_stack() const;
+
+  /**
+   *  @brief Standard error of dual_stack()
+   *  @retval double error in hosts, from the three estimates it is made of
+   */
+  double dual_stack_error() const;
+
+  /**
+   *  @brief Estimated number of subnets without estimators of their own
+   *  @retval double estimate
+   */
+  double dropped_subnets() const;
+
+  /**
+   *  @brief Accessor method for the ipv4_subnets_ property
+   *  @retval std::map<uint32_t, Subnet> IPv4 /24 subnets by their first three
+   *          octets, most significant first
+   */
+  const std::map<uint32_t, Subnet>& ipv4_subnets() const;
+
+  /**
+   *  @brief Accessor method for the ipv6_subnets_ property
+   *  @retval std::map<uint64_t, Subnet> IPv6 /64 subnets by their first eight
+   *          octets, most significant first
+   */
+  const std::map<uint64_t, Subnet>& ipv6_subnets() const;
+
+  /**
+   *  @brief Counts one host observation
+   *  @param mac MAC address of the host
+   *  @param ipv4 IPv4 address the host was seen with, may be empty
+   *  @param ipv6 IPv6 address the host was seen with, may be empty
+   */
+  void add(const MACAddress& mac, const IPv4Address& ipv4,
+           const IPv6Address& ipv6);
+
+  /**
+   *  @brief Combines another sketch into this one
+   *  @param other sketch to merge
+   */
+  void merge(const Sketch& other);
+
+  /**
+   *  @brief Merges a sketch file into this sketch
+   *  @param filename file written by save()
+   *  @retval bool true if loaded, false if the file does not exist
+   *  @throws std::runtime_error if the file is not a valid sketch file
+   */
+  bool load(const std::string& filename);
+
+  /**
+   *  @brief Writes this sketch to a file
+   *  @param filename file to write, replaced atomically
+   *  @throws std::runtime_error if the file cannot be written
+   */
+  void save(const std::string& filename) const;
+};
+
+/**
+ *  @brief Provide the std::string representation of a Sketch by overloading
+ *         the << operator for std::ostream
+ *  @param out std::ostream output stream
+ *  @param s Sketch instance to display as an std::string
+ *  @retval std::ostream address that contains the std::string representation of
+ *          this Sketch
+ */
+std::ostream& operator<<(std::ostream& out, const Sketch& s);
+
+#endif  // IPFORENSICS_SKETCH_H_
@@ -0,0 +1,263 @@
+/**
+ *  @file snapshot.h
+ *  @brief Snapshot class definitions
+ */
+
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014 Michael Maraya
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef IPFORENSICS_SNAPSHOT_H_
+#define IPFORENSICS_SNAPSHOT_H_
+
+#include <stdint.h>
+#include <string>
+#include <utility>
+#include <vector>
+#include "ipforensics/ip4and6.h"
+
+/**
+ *  @brief Saves and restores the host table as a binary snapshot
+ *  @details A snapshot is a fixed header followed by one fixed-size Record 
+ *           per host, sorted by MAC address, and then the Alias entries of 
+ *           the hosts' secondary addresses.  It is read by mapping the file 
+ *           into memory, checking the header and the checksum of everything
+ *           after it, and appending the records to the host table in order,
+ *           with no text parsing.  Snapshots are written to a temporary file
+ *           and renamed into place.  Numbers are in the byte order of the 
+ *           machine that wrote them, which the header records.  The Record
+ *           and Alias layouts are shared with the DeltaLog kept beside the
+ *           snapshot.
+ */
+class Snapshot {
+ public:
+  /**
+   *  @brief Start of a snapshot file
+   */
+  struct Header {
+    /** ipf::kSnapshotMagic */
+    char magic[8];
+
+    /** ipf::kSnapshotVersion */
+    uint32_t version;
+
+    /** ipf::kSnapshotByteOrder as written by the saving machine */
+    uint32_t byte_order;
+
+    /** sizeof(Record) */
+    uint32_t record_size;
+
+    /** sizeof(Alias) */
+    uint32_t alias_size;
+
+    /** number of records */
+    uint64_t records;
+
+    /** number of aliases */
+    uint64_t aliases;
+
+    /** FNV-1a hash of the records and aliases */
+    uint64_t checksum;
+  };
+
+  /**
+   *  @brief One host
+   */
+  struct Record {
+    /** MAC address, as Host::pack(const MACAddress&) */
+    uint64_t mac;
+
+    /** primary IPv4 address, as Host::pack(const IPv4Address&) */
+    uint32_t ipv4;
+
+    /** kHasIPv4 and kHasIPv6 */
+    uint8_t flags;
+
+    /** zero */
+    uint8_t reserved[3];
+
+    /** primary IPv6 address */
+    uint8_t ipv6[16];
+
+    /** index of the host's first Alias */
+    uint32_t alias;
+
+    /** number of Alias entries of the host */
+    uint32_t alias_count;
+
+    /** Activity::packets */
+    uint64_t packets;
+
+    /** Activity::bytes */
+    uint64_t bytes;
+
+    /** Activity::first_seen */
+    int64_t first_seen;
+
+    /** Activity::last_seen */
+    int64_t last_seen;
+  };
+
+  /**
+   *  @brief One secondary address of a host
+   */
+  struct Alias {
+    /** address octets, the first 4 for IPv4 */
+    uint8_t address[16];
+
+    /** 4 or 6 */
+    uint8_t family;
+
+    /** zero */
+    uint8_t reserved[3];
+  };
+
+  /** Record::flags bit set when the host has a primary IPv4 address */
+  static const uint8_t kHasIPv4 {0x01};
+
+  /** Record::flags bit set when the host has a primary IPv6 address */
+  static const uint8_t kHasIPv6 {0x02};
+
+  /** Record::flags bit set when the host was removed, in a DeltaLog only */
+  static const uint8_t kRemoved {0x04};
+
+  /** FNV-1a 64-bit offset basis, the checksum of no bytes */
+  static const uint64_t kChecksumBasis {0xcbf29ce484222325ULL};
+
+ private:
+  /**
+   *  @brief Pointer to the main controller this Snapshot is associated with
+   */
+  IPForensics* ip_;
+
+  /**
+   *  @brief Checksum of the snapshot last saved or loaded
+   */
+  uint64_t checksum_ {};
+
+  /**
+   *  @brief Number of records in the snapshot last saved or loaded
+   */
+  uint64_t records_ {};
+
+ public:
+  /**
+   *  @brief Constructs a Snapshot for the supplied IPForensics instance
+   *  @param ip the IPForensics instance whose hosts are saved and restored
+   */
+  explicit Snapshot(IPForensics* ip);
+
+  /**
+   *  @brief Accessor method for the checksum_ property
+   *  @retval uint64_t checksum of the snapshot last saved or loaded
+   */
+  uint64_t checksum() const;
+
+  /**
+   *  @brief Accessor method for the records_ property
+   *  @retval uint64_t number of hosts in the snapshot last saved or loaded
+   */
+  uint64_t records() const;
+
+  /**
+   *  @brief Continues an FNV-1a hash over a block of bytes
+   *  @param data bytes to hash
+   *  @param size number of bytes
+   *  @param hash hash so far
+   *  @retval uint64_t hash including the block
+   */
+  static uint64_t checksum(const void* data, size_t size,
+                           uint64_t hash = kChecksumBasis);
+
+  /**
+   *  @brief Converts a Host to a Record and its secondary addresses to Aliases
+   *  @param host Host to convert
+   *  @param activity Activity of the Host
+   *  @param aliases receives the Host's Alias entries, which the Record 
+   *         indexes
+   *  @retval Record for the Host
+   */
+  static Record encode(const Host& host, const Activity& activity,
+                       std::vector<Alias>* aliases);
+
+  /**
+   *  @brief Converts a Record and its Aliases back to a Host
+   *  @param record Record to convert, with its Alias range already checked
+   *  @param aliases Alias entries the Record indexes
+   *  @param ip IPForensics supplying the per-host address caps
+   *  @param activity receives the Activity of the Host
+   *  @retval Host with all of its addresses
+   */
+  static Host decode(const Record& record, const Alias* aliases,
+                     IPForensics* ip, Activity* activity);
+
+  /**
+   *  @brief Writes all of a block to a file, retrying short writes
+   *  @param fd file descriptor to write to
+   *  @param data bytes to write
+   *  @param size number of bytes
+   *  @retval bool true if the whole block was written
+   */
+  static bool write(int fd, const void* data, size_t size);
+
+  /**
+   *  @brief Atomically replaces a file with the supplied blocks of bytes
+   *  @param filename file to replace
+   *  @param blocks pointer and size of each block, written in order
+   *  @throws std::runtime_error if the file cannot be written
+   */
+  static void replace(const std::string& filename,
+                      const std::vector<std::pair<const void*, size_t>>&
+                          blocks);
+
+  /**
+   *  @brief Writes the hosts of IPForensics to a snapshot file
+   *  @param filename file to write, replaced atomically
+   *  @throws std::runtime_error if the file cannot be written
+   */
+  void save(const std::string& filename);
+
+  /**
+   *  @brief Reads the records and aliases of a snapshot file without adding
+   *         them to IPForensics
+   *  @param filename file written by save()
+   *  @param records receives the records, sorted by MAC address
+   *  @param aliases receives the Alias entries the records index
+   *  @retval bool true if read, false if the file does not exist
+   *  @throws std::runtime_error if the file cannot be read or is not a valid
+   *          snapshot
+   */
+  bool read(const std::string& filename, std::vector<Record>* records,
+            std::vector<Alias>* aliases);
+
+  /**
+   *  @brief Adds the hosts in a snapshot file to IPForensics
+   *  @param filename file written by save()
+   *  @retval bool true if loaded, false if the file does not exist
+   *  @throws std::runtime_error if the file cannot be read or is not a valid
+   *          snapshot
+   */
+  bool load(const std::string& filename);
+};
+
+#endif  // IPFORENSICS_SNAPSHOT_H_
@@ -0,0 +1,70 @@
+/**
+ *  @file threads.h
+ *  @brief run_threads function template definition
+ */
+
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014 Michael Maraya
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef IPFORENSICS_THREADS_H_
+#define IPFORENSICS_THREADS_H_
+
+#include <stddef.h>
+#include <exception>
+#include <thread>  // NOLINT
+#include <vector>
+
+/**
+ *  @brief Runs a function on each of several threads and waits for them
+ *  @details An exception thrown by the function on any thread, the calling 
+ *           one included, is caught there and rethrown here once every thread
+ *           has been joined; if several throw, the one on the lowest thread 
+ *           index is rethrown.
+ *  @param threads number of threads, including the calling one
+ *  @param work function called with the thread index
+ */
+template <typename F>
+void run_threads(size_t threads, const F& work) {
+  std::vector<std::exception_ptr> errors(threads);
+  auto guarded = [&work, &errors](size_t t) {
+    try {
+      work(t);
+    } catch (...) {
+      errors[t] = std::current_exception();
+    }
+  };
+  std::vector<std::thread> workers;
+  for (size_t t = 1; t < threads; ++t) {
+    workers.emplace_back(guarded, t);
+  }
+  guarded(0);
+  for (std::thread& w : workers) {
+    w.join();
+  }
+  for (const std::exception_ptr& e : errors) {
+    if (e) std::rethrow_exception(e);
+  }
+}
+
+#endif  // IPFORENSICS_THREADS_H_
@@ -0,0 +1,129 @@
+/**
+ *  @file timerwheel.h
+ *  @brief TimerWheel class definitions
+ */
+
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014 Michael Maraya
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef IPFORENSICS_TIMERWHEEL_H_
+#define IPFORENSICS_TIMERWHEEL_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+/**
+ *  @brief Hierarchical timer wheel driven by packet time
+ *  @details Timers are kept in kLevels wheels of kSlots slots each.  Level 0 
+ *           slots are one tick wide and each higher level's slots span a full
+ *           turn of the level below, so scheduling is O(1) and a timer is
+ *           moved down at most kLevels - 1 times before it expires.  Time only
+ *           moves when advance() is called, so the wheel follows the capture's
+ *           clock rather than the wall clock.
+ */
+class TimerWheel {
+ public:
+  /**
+   *  @brief A pending expiry
+   */
+  struct Timer {
+    /** Host::slot() of the timed host */
+    uint32_t slot;
+
+    /** packed MAC address of the timed host, to detect reused slots */
+    uint64_t mac;
+
+    /** tick at which the timer expires */
+    int64_t deadline;
+  };
+
+ private:
+  /** number of wheels */
+  static const int kLevels {4};
+
+  /** log2 of the number of slots per wheel */
+  static const int kSlotBits {6};
+
+  /** number of slots per wheel */
+  static const int kSlots {1 << kSlotBits};
+
+  /** Pending timers by level and slot */
+  std::vector<Timer> wheels_[kLevels][kSlots];
+
+  /** Current tick, -1 until start() is called */
+  int64_t now_ {-1};
+
+  /** Number of pending timers */
+  size_t size_ {};
+
+  /**
+   *  @brief Moves every timer in one slot to where it now belongs
+   *  @param level wheel of the slot
+   *  @param slot slot within the wheel
+   *  @param expired receives the timers that are due
+   */
+  void cascade(int level, int slot, std::vector<Timer>* expired);
+
+ public:
+  /**
+   *  @brief Accessor method for the now_ property
+   *  @retval int64_t current tick, -1 if not started
+   */
+  int64_t now() const;
+
+  /**
+   *  @brief Number of pending timers
+   *  @retval size_t number of timers scheduled and not yet expired
+   */
+  size_t size() const;
+
+  /**
+   *  @brief Determines whether the wheel has been started
+   *  @retval bool true if start() was called, false otherwise
+   */
+  bool started() const;
+
+  /**
+   *  @brief Sets the current tick of a wheel that was not yet started
+   *  @param now tick to start at
+   */
+  void start(int64_t now);
+
+  /**
+   *  @brief Adds a timer
+   *  @param timer timer to add; deadlines not after now() expire on the next 
+   *         tick, deadlines beyond the range of the wheels are clamped to it
+   */
+  void schedule(const Timer& timer);
+
+  /**
+   *  @brief Moves time forward, collecting the timers that expire
+   *  @param now tick to move to; earlier ticks are ignored
+   *  @param expired receives the expired timers
+   */
+  void advance(int64_t now, std::vector<Timer>* expired);
+};
+
+#endif  // IPFORENSICS_TIMERWHEEL_H_
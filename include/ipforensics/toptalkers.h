@@ -0,0 +1,177 @@
+/**
+ *  @file toptalkers.h
+ *  @brief TopTalkers class definitions
+ */
+
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014 Michael Maraya
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef IPFORENSICS_TOPTALKERS_H_
+#define IPFORENSICS_TOPTALKERS_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <array>
+#include <iostream>  // NOLINT
+#include <unordered_map>
+#include <vector>
+#include "ipforensics/address.h"
+#include "ipforensics/countmin.h"
+
+/**
+ *  @brief Heavy-hitter tracking of the busiest MAC and IP addresses
+ *  @details Packets and bytes are counted per address in CountMin estimators,
+ *           and a min-heap of the k addresses with the largest estimates is 
+ *           kept for each ranking.  An address enters a full heap when its 
+ *           estimate passes the smallest one there, so memory stays fixed at 
+ *           four estimators plus 4k entries whatever the number of hosts.  
+ *           A packet counts for both its source and destination.
+ */
+class TopTalkers {
+ public:
+  /**
+   *  @brief What addresses are ranked by
+   */
+  enum class Ranking {
+    /** MAC addresses by packets */
+    kMACPackets,
+    /** MAC addresses by bytes */
+    kMACBytes,
+    /** IPv4 and IPv6 addresses by packets */
+    kIPPackets,
+    /** IPv4 and IPv6 addresses by bytes */
+    kIPBytes
+  };
+
+  /** number of rankings */
+  static const size_t kRankings {4};
+
+  /**
+   *  @brief One ranked address
+   */
+  struct Talker {
+    /** address octets: 6 for a MAC, 4 for IPv4 or 16 for IPv6 address */
+    std::vector<uint8_t> address;
+
+    /** hash of the address in the estimators */
+    uint64_t hash;
+
+    /** estimated count */
+    uint64_t count;
+  };
+
+ private:
+  /** Number of addresses ranked, 0 when not tracking */
+  size_t k_ {};
+
+  /** Count estimators, by Ranking */
+  std::array<CountMin, kRankings> counts_;
+
+  /** Min-heaps of the top k addresses, by Ranking */
+  std::array<std::vector<Talker>, kRankings> heaps_;
+
+  /** Position of each address in its heap, by Ranking */
+  std::array<std::unordered_map<uint64_t, size_t>, kRankings> positions_;
+
+  /**
+   *  @brief Counts an address and updates its heap
+   *  @param ranking estimator and heap to update
+   *  @param hash hash of the address
+   *  @param address the address, copied only if it enters the heap
+   *  @param count amount to add
+   */
+  void offer(Ranking ranking, uint64_t hash, const Address& address,
+             uint64_t count);
+
+  /**
+   *  @brief Restores the heap order below an entry whose count grew
+   *  @param ranking heap to update
+   *  @param i position of the entry
+   */
+  void sift_down(Ranking ranking, size_t i);
+
+  /**
+   *  @brief Restores the heap order above a new entry
+   *  @param ranking heap to update
+   *  @param i position of the entry
+   */
+  void sift_up(Ranking ranking, size_t i);
+
+  /**
+   *  @brief Swaps two heap entries and their positions
+   *  @param ranking heap to update
+   *  @param i position of one entry
+   *  @param j position of the other entry
+   */
+  void swap(Ranking ranking, size_t i, size_t j);
+
+ public:
+  /**
+   *  @brief Accessor method for the k_ property
+   *  @retval size_t number of addresses ranked, 0 when not tracking
+   */
+  size_t k() const;
+
+  /**
+   *  @brief Mutator method for the k_ property
+   *  @param k number of addresses to rank
+   */
+  void set_k(size_t k);
+
+  /**
+   *  @brief Counts one packet of a host
+   *  @param mac MAC address of the host
+   *  @param ipv4 IPv4 address of the host in the packet, may be empty
+   *  @param ipv6 IPv6 address of the host in the packet, may be empty
+   *  @param length packet length in bytes
+   */
+  void add(const MACAddress& mac, const IPv4Address& ipv4,
+           const IPv6Address& ipv6, uint32_t length);
+
+  /**
+   *  @brief The top addresses of a ranking
+   *  @param ranking what addresses are ranked by
+   *  @retval std::vector<Talker> up to k addresses, largest count first
+   */
+  std::vector<Talker> top(Ranking ranking) const;
+
+  /**
+   *  @brief Largest overcount of the counts of a ranking
+   *  @param ranking what addresses are ranked by
+   *  @retval uint64_t bound holding with probability CountMin::confidence()
+   */
+  uint64_t error(Ranking ranking) const;
+};
+
+/**
+ *  @brief Provide the std::string representation of TopTalkers by overloading
+ *         the << operator for std::ostream
+ *  @param out std::ostream output stream
+ *  @param t TopTalkers instance to display as an std::string
+ *  @retval std::ostream address that contains the std::string representation of
+ *          these TopTalkers
+ */
+std::ostream& operator<<(std::ostream& out, const TopTalkers& t);
+
+#endif  // IPFORENSICS_TOPTALKERS_H_
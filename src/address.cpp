@@ -28,13 +28,47 @@
  */
 
 #include <algorithm>
-#include <iomanip>
-#include <sstream>
+#include <ostream>
+#include <stdexcept>
 #include <string>
 #include <vector>
 #include "ipforensics/ip4and6.h"
 #include "ipforensics/address.h"
 
+namespace {
+
+/** lower-case hexadecimal digits */
+const char kHexDigits[] {"0123456789abcdef"};
+
+/**
+ *  @brief Writes a number in hexadecimal without leading zeros
+ *  @param value number to write
+ *  @param out buffer with room for 4 characters
+ *  @retval char* end of the text written
+ */
+char* hex16(uint16_t value, char* out) {
+  if (value >= 0x1000) *out++ = kHexDigits[value >> 12];
+  if (value >= 0x100) *out++ = kHexDigits[(value >> 8) & 0x0F];
+  if (value >= 0x10) *out++ = kHexDigits[(value >> 4) & 0x0F];
+  *out++ = kHexDigits[value & 0x0F];
+  return out;
+}
+
+/**
+ *  @brief Writes a number in decimal without leading zeros
+ *  @param value number to write
+ *  @param out buffer with room for 3 characters
+ *  @retval char* end of the text written
+ */
+char* dec8(uint8_t value, char* out) {
+  if (value >= 100) *out++ = static_cast<char>('0' + value / 100);
+  if (value >= 10) *out++ = static_cast<char>('0' + value / 10 % 10);
+  *out++ = static_cast<char>('0' + value % 10);
+  return out;
+}
+
+}  // namespace
+
 Address::Address() {
 }
 
@@ -42,7 +76,7 @@ Address::Address(std::vector<uint8_t> address) {
   address_ = address;
 }
 
-std::vector<uint8_t> Address::address() const {
+const std::vector<uint8_t>& Address::address() const {
   return address_;
 }
 
@@ -87,15 +121,21 @@ MACAddress::MACAddress(const std::string mac) {
 }
 
 std::string MACAddress::str() const {
-  std::stringstream ss;
-  if (!address_.empty()) {
-    for (size_t i = 0; i < ipf::kLengthMAC; ++i) {
-      if (i > 0) ss << ':';
-      ss << std::hex << std::setw(2) << std::setfill('0');
-      ss << static_cast<int>(address_[i]);
-    }
+  char text[ipf::kOutputLengthMAC];
+  return std::string(text, format(text));
+}
+
+char* MACAddress::format(char* out) const {
+  return address_.empty() ? out : format(address_.data(), out);
+}
+
+char* MACAddress::format(const uint8_t* octets, char* out) {
+  for (size_t i = 0; i < ipf::kLengthMAC; ++i) {
+    if (i > 0) *out++ = ':';
+    *out++ = kHexDigits[octets[i] >> 4];
+    *out++ = kHexDigits[octets[i] & 0x0F];
   }
-  return ss.str();
+  return out;
 }
 
 bool MACAddress::fake() const {
@@ -111,20 +151,24 @@ IPv4Address::IPv4Address() {
 /**
  *  @details While libpcap and WinPcap both have utilities to convert strings
  *           to IP Addresses, we decided to limit the dependencies on these
- *           external libraries to capturing packets
+ *           external libraries to capturing packets.  Anything after the first
+ *           space is ignored so fixed-width report columns can be passed in.
+ *           Octets out of range are rejected rather than wrapped into some 
+ *           other address.
  */
 IPv4Address::IPv4Address(std::string ipv4) {
-  size_t start = 0, end = ipv4.find('.');
-  while (end != std::string::npos) {
+  ipv4 = ipv4.substr(0, ipv4.find(' '));
+  size_t start = 0;
+  for (size_t i = 0; i < ipf::kLengthIPv4; ++i) {
+    size_t end = ipv4.find('.', start);
     std::string segment = ipv4.substr(start, end - start);
-    uint8_t value = static_cast<uint8_t>(std::stoi(segment, 0, 10));
-    Address::address_.push_back(value);
-    start = end + 1;
-    if (end == ipv4.rfind('.')) {
-      end = ipv4.length() - 1;
-    } else {
-      end = ipv4.find('.', start);
+    int value = std::stoi(segment, 0, 10);
+    if (value < 0 || value > 255) {
+      throw std::out_of_range("IPv4 octet " + segment + " out of range");
     }
+    Address::address_.push_back(static_cast<uint8_t>(value));
+    if (end == std::string::npos) break;
+    start = end + 1;
   }
 }
 
@@ -141,14 +185,20 @@ IPv4Address::IPv4Address(const uint32_t address) {
 }
 
 std::string IPv4Address::str() const {
-  std::stringstream ss;
-  if (!address_.empty()) {
-    for (size_t i = 0; i < ipf::kLengthIPv4; ++i) {
-      if (i > 0) ss << '.';
-      ss << static_cast<int>(address_[i]);
-    }
+  char text[ipf::kOutputLengthIPv4];
+  return std::string(text, format(text));
+}
+
+char* IPv4Address::format(char* out) const {
+  return address_.empty() ? out : format(address_.data(), out);
+}
+
+char* IPv4Address::format(const uint8_t* octets, char* out) {
+  for (size_t i = 0; i < ipf::kLengthIPv4; ++i) {
+    if (i > 0) *out++ = '.';
+    out = dec8(octets[i], out);
   }
-  return ss.str();
+  return out;
 }
 
 bool IPv4Address::fake() const {
@@ -178,64 +228,85 @@ bool IPv4Address::mask(IPv4Address addr, IPv4Address mask) const {
 IPv6Address::IPv6Address() {
 }
 
+/**
+ *  @details The groups before and after the zero compression (::), if any, are
+ *           parsed separately and the gap between them is filled with zeros.
+ *           Anything after the first space is ignored so fixed-width report 
+ *           columns can be passed in.
+ */
 IPv6Address::IPv6Address(const std::string ipv6) {
-  std::string v6 = ipv6;
-  if (v6.find(' ') != std::string::npos) {
-    v6 = v6.substr(0, v6.find(' ') + 1);
-  }
-  size_t colon = static_cast<size_t>(std::count(v6.begin(), v6.end(), ':'));
-  size_t zeroCompress = v6.find("::") + 1;
-  size_t start = 0, end = v6.find(':');
-  while (end != std::string::npos) {
-    if (start == zeroCompress) {
-      for (size_t i = 0 ; i < ipf::kLengthIPv6 - colon; i = i + 2) {
-        Address::address_.push_back(0);
-      }
-      start = zeroCompress + 1;
-      end = v6.find(':', start);
+  std::string v6 = ipv6.substr(0, ipv6.find(' '));
+  size_t zero_compress = v6.find("::");
+  std::vector<std::string> parts {v6};
+  if (zero_compress != std::string::npos) {
+    parts = {v6.substr(0, zero_compress), v6.substr(zero_compress + 2)};
+  }
+  std::vector<uint8_t> halves[2];
+  for (size_t i = 0; i < parts.size(); ++i) {
+    size_t start = 0;
+    while (start < parts[i].length()) {
+      size_t end = parts[i].find(':', start);
+      std::string segment = parts[i].substr(start, end - start);
+      uint16_t val = static_cast<uint16_t>(std::stoul(segment, nullptr, 16));
+      halves[i].push_back(static_cast<uint8_t>(val >> 8));
+      halves[i].push_back(static_cast<uint8_t>(val & 0x00FF));
       if (end == std::string::npos) break;
+      start = end + 1;
     }
-    std::string segment = "0x" + v6.substr(start, end - start);
-    uint16_t val = static_cast<uint16_t>(std::stoul(segment, nullptr, 16));
-    Address::address_.push_back(static_cast<uint8_t>(val >> 8));
-    Address::address_.push_back(static_cast<uint8_t>(val & 0x00FF));
-    start = end + 1;
-    if (end == v6.rfind(':')) {
-      end = v6.length() - 1;
-    } else {
-      end = v6.find(':', start + 1);
-    }
+  }
+  if (halves[0].size() + halves[1].size() > ipf::kLengthIPv6) {
+    throw std::invalid_argument("IPv6 address too long: " + v6);
+  }
+  address_ = halves[0];
+  if (parts.size() > 1) {
+    address_.resize(ipf::kLengthIPv6 - halves[1].size(), 0);
+    address_.insert(address_.end(), halves[1].begin(), halves[1].end());
   }
 }
 
 std::string IPv6Address::str() const {
-  std::string result {};
-  if (!address_.empty()) {
-    std::vector<uint16_t> ipv6 {};
-    for (size_t i = 0; i < ipf::kLengthIPv6; i+=2) {
-      ipv6.push_back(static_cast<uint16_t>(address_[i] << 8 | address_[i+1]));
-    }
-    std::stringstream ss;
-    ss << std::hex;
-    for (size_t i = 0; i < ipv6.size(); ++i) {
-      if (i > 0) ss << ':';
-      ss << ipv6[i];
+  char text[ipf::kOutputLengthIPv6];
+  return std::string(text, format(text));
+}
+
+char* IPv6Address::format(char* out) const {
+  return address_.empty() ? out : format(address_.data(), out);
+}
+
+/**
+ *  @details The first longest run of two or more zero groups is compressed
+ *           to ::, except that the first group is always written, so ::1 is
+ *           shown as 0::1 as in earlier reports.
+ */
+char* IPv6Address::format(const uint8_t* octets, char* out) {
+  const size_t groups {ipf::kLengthIPv6 / 2};
+  uint16_t group[groups];
+  for (size_t i = 0; i < groups; ++i) {
+    group[i] = static_cast<uint16_t>(octets[2 * i] << 8 | octets[2 * i + 1]);
+  }
+  size_t zero = 0, zeros = 0;
+  for (size_t i = 1; i < groups; ++i) {
+    if (group[i] != 0) continue;
+    size_t end = i;
+    while (end < groups && group[end] == 0) ++end;
+    if (end - i > zeros) {
+      zero = i;
+      zeros = end - i;
     }
-    // compress longest series of 0:0 to :: (zero compression)
-    result = ss.str();
-    for (size_t i = ipv6.size() - 1; i > 1; --i) {
-      std::string zero {};
-      for (size_t j = 1; j < i + 1; ++j) {
-        zero.append(":0");
-      }
-      size_t pos = ss.str().find(zero);
-      if (pos != std::string::npos) {
-        result.replace(pos, i * 2 + 1, "::");
-        break;
-      }
+    i = end;
+  }
+  if (zeros < 2) zeros = 0;
+  for (size_t i = 0; i < groups; ++i) {
+    if (zeros > 0 && i == zero) {
+      *out++ = ':';
+      *out++ = ':';
+      i += zeros - 1;
+      continue;
     }
+    if (i > 0 && !(zeros > 0 && i == zero + zeros)) *out++ = ':';
+    out = hex16(group[i], out);
   }
-  return result;
+  return out;
 }
 
 bool IPv6Address::fake() const {
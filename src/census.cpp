@@ -0,0 +1,149 @@
+/**
+ *  @file census.cpp
+ *  @brief HostCensus class implementation
+ */
+
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014 Michael Maraya
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <iomanip>
+#include <vector>
+#include "ipforensics/census.h"
+
+namespace {
+
+/** Index of a stack in the per-stack arrays */
+size_t index(HostCensus::Stack stack) {
+  return static_cast<size_t>(stack);
+}
+
+/** Index of a reason in the per-reason arrays */
+size_t index(HostCensus::Skip why) {
+  return static_cast<size_t>(why);
+}
+
+}  // namespace
+
+HostCensus::Stack HostCensus::stack(const Host& host) {
+  bool v4 = !host.ipv4().empty(), v6 = !host.ipv6().empty();
+  if (v4 && v6) return Stack::kDual;
+  if (v4) return Stack::kIPv4;
+  if (v6) return Stack::kIPv6;
+  return Stack::kNone;
+}
+
+uint64_t HostCensus::hosts() const {
+  return hosts_;
+}
+
+uint64_t HostCensus::count(Stack stack) const {
+  return stacks_[index(stack)];
+}
+
+uint64_t HostCensus::skipped(Skip why) const {
+  return skipped_mac_[index(why)].size() + skipped_ipv4_[index(why)].size() +
+         skipped_ipv6_[index(why)].size();
+}
+
+int HostCensus::interval() const {
+  return interval_;
+}
+
+void HostCensus::set_interval(int seconds) {
+  interval_ = seconds;
+}
+
+void HostCensus::add(const Host& host) {
+  ++hosts_;
+  ++stacks_[index(stack(host))];
+}
+
+void HostCensus::remove(const Host& host) {
+  --hosts_;
+  --stacks_[index(stack(host))];
+}
+
+void HostCensus::change(const Host& before, const Host& after) {
+  --stacks_[index(stack(before))];
+  ++stacks_[index(stack(after))];
+}
+
+void HostCensus::skip(Skip why, const MACAddress& mac) {
+  skipped_mac_[index(why)].insert(Host::pack(mac));
+}
+
+void HostCensus::skip(Skip why, const IPv4Address& ipv4) {
+  skipped_ipv4_[index(why)].insert(Host::pack(ipv4));
+}
+
+void HostCensus::skip(Skip why, const IPv6Address& ipv6) {
+  skipped_ipv6_[index(why)].insert(Host::pack(ipv6));
+}
+
+/**
+ *  @details Intervals are aligned to multiples of interval_ since the epoch.
+ *           Intervals without packets are skipped rather than recorded with 
+ *           unchanged counts, so a long quiet period costs nothing.
+ */
+void HostCensus::tick(int64_t time) {
+  if (interval_ <= 0) return;
+  int64_t now = time / 1000000;
+  int64_t start = now - now % interval_;
+  if (start_ >= 0 && start > start_) {
+    series_.push_back({start_, hosts_, stacks_});
+  }
+  if (start > start_) start_ = start;
+}
+
+std::vector<HostCensus::Bucket> HostCensus::series() const {
+  std::vector<Bucket> result = series_;
+  if (start_ >= 0) result.push_back({start_, hosts_, stacks_});
+  return result;
+}
+
+/**
+ *  @details One row per interval with its start time, the host counts by
+ *           stack and the share of hosts with IPv6, as in the summary line.
+ */
+std::ostream& operator<<(std::ostream& out, const HostCensus& c) {
+  std::ios::fmtflags fmt(out.flags());
+  out << "Interval Start       " << std::right;
+  out << std::setw(10) << "Hosts" << ' ' << std::setw(10) << "IPv4 only";
+  out << ' ' << std::setw(10) << "IPv6 only" << ' ';
+  out << std::setw(10) << "Dual-stack" << ' ' << std::setw(8) << "Migrated";
+  out << '\n' << std::fixed << std::setprecision(0);
+  for (const HostCensus::Bucket& b : c.series()) {
+    uint64_t v6 = b.stacks[index(HostCensus::Stack::kIPv6)];
+    uint64_t dual = b.stacks[index(HostCensus::Stack::kDual)];
+    double pc = b.hosts == 0 ? 0 : static_cast<double>(dual + v6) /
+                                   static_cast<double>(b.hosts) * 100;
+    out << std::left << std::setw(20) << utc_time(b.start * 1000000) << ' ';
+    out << std::right << std::setw(10) << b.hosts << ' ';
+    out << std::setw(10) << b.stacks[index(HostCensus::Stack::kIPv4)] << ' ';
+    out << std::setw(10) << v6 << ' ' << std::setw(10) << dual << ' ';
+    out << std::setw(7) << pc << "%\n";
+  }
+  out.flags(fmt);
+  return out;
+}
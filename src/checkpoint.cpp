@@ -0,0 +1,129 @@
+/**
+ *  @file checkpoint.cpp
+ *  @brief Checkpoint class implementation
+ */
+
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014 Michael Maraya
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <fstream>  // NOLINT
+#include <iostream>  // NOLINT
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include "ipforensics/checkpoint.h"
+#include "ipforensics/ip46file.h"
+#include "ipforensics/snapshot.h"
+
+Checkpoint::Checkpoint(IPForensics* ip) {
+  ip_ = ip;
+}
+
+const std::string& Checkpoint::error() const {
+  return error_;
+}
+
+/**
+ *  @details The checkpoint is a header line, the capture file name, the byte
+ *           offset, and one host row per line.  It is built in memory and 
+ *           written with Snapshot::replace, so it is on disk before it 
+ *           replaces the previous checkpoint.
+ */
+void Checkpoint::save(const std::string& file, uint64_t offset) const {
+  std::ostringstream out;
+  out << ipf::kCheckpointHeader << '\n' << file << '\n' << offset << '\n';
+  for (const Host& h : ip_->hosts()) {
+    out << h << ' ' << ip_->activity(h) << '\n';
+    for (const Host& alias : h.aliases()) {
+      out << alias << '\n';
+    }
+  }
+  std::string text = out.str();
+  Snapshot::replace(ip_->checkpoint_file(), {{text.data(), text.size()}});
+}
+
+/**
+ *  @details Rows are checked as the report loader checks them.  Everything 
+ *           is parsed before anything is handed back, so a truncated or 
+ *           corrupt checkpoint leaves the hosts and the read position as 
+ *           they were.
+ */
+bool Checkpoint::load(std::string* file, uint64_t* offset) {
+  error_.clear();
+  const std::string& filename = ip_->checkpoint_file();
+  std::ifstream fs(filename);
+  if (!fs.is_open()) return false;
+  std::string line, name, offset_str;
+  size_t number {1};
+  auto fail = [&](const std::string& problem) {
+    error_ = filename + ':' + std::to_string(number) + ": " + problem;
+    return false;
+  };
+  std::getline(fs, line);
+  if (line != ipf::kCheckpointHeader) return fail("not a checkpoint file");
+  ++number;
+  if (!std::getline(fs, name)) return fail("missing capture file name");
+  ++number;
+  uint64_t position;
+  try {
+    if (!std::getline(fs, offset_str)) throw std::invalid_argument("");
+    size_t used {0};
+    position = std::stoull(offset_str, &used);
+    if (used != offset_str.length()) throw std::invalid_argument("");
+  } catch (std::exception const &e) {
+    return fail("malformed offset");
+  }
+  IP46File::HostList hosts;
+  Host host;
+  Activity activity {};
+  while (std::getline(fs, line)) {
+    ++number;
+    // save() ends every row with a newline, so a row without one was cut
+    if (fs.eof()) return fail("row cut short");
+    Host row;
+    Activity row_activity {};
+    const char* problem = IP46File::read_row(line, &row, &row_activity);
+    if (problem != nullptr) return fail(problem);
+    if (row.mac().empty()) {
+      if (host.mac().empty()) return fail("address row without a host");
+      IP46File::attach(row, &host, ip_);
+      continue;
+    }
+    if (!host.mac().empty()) hosts.push_back({host, activity});
+    host = row;
+    activity = row_activity;
+  }
+  if (fs.bad()) return fail("read error");
+  if (!host.mac().empty()) hosts.push_back({host, activity});
+  fs.close();
+  for (const auto& h : hosts) {
+    ip_->replace_host(h.first, h.second);
+    if (ip_->verbose()) {
+      std::cout << "Loaded host " << h.first << std::endl;
+    }
+  }
+  *file = name;
+  *offset = position;
+  return true;
+}
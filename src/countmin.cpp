@@ -0,0 +1,83 @@
+/**
+ *  @file countmin.cpp
+ *  @brief CountMin class implementation
+ */
+
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014 Michael Maraya
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include "ipforensics/countmin.h"
+
+namespace {
+
+/** Index of the counter for a hash in a row, using 16 hash bits per row */
+size_t cell(uint64_t hash, size_t row) {
+  return row * CountMin::kWidth +
+         static_cast<size_t>((hash >> (16 * row)) & (CountMin::kWidth - 1));
+}
+
+}  // namespace
+
+CountMin::CountMin() : counts_(kWidth * kDepth, 0) {
+}
+
+double CountMin::epsilon() {
+  return std::exp(1.0) / static_cast<double>(kWidth);
+}
+
+double CountMin::confidence() {
+  return 1.0 - std::exp(-static_cast<double>(kDepth));
+}
+
+uint64_t CountMin::total() const {
+  return total_;
+}
+
+uint64_t CountMin::error() const {
+  return static_cast<uint64_t>(std::ceil(epsilon() * total_));
+}
+
+/**
+ *  @details Conservative update: each counter is raised to the item's new
+ *           estimate, if below it, rather than incremented.
+ */
+uint64_t CountMin::add(uint64_t hash, uint64_t count) {
+  total_ += count;
+  uint64_t updated = estimate(hash) + count;
+  for (size_t row = 0; row < kDepth; ++row) {
+    uint64_t& counter = counts_[cell(hash, row)];
+    counter = std::max(counter, updated);
+  }
+  return updated;
+}
+
+uint64_t CountMin::estimate(uint64_t hash) const {
+  uint64_t result = UINT64_MAX;
+  for (size_t row = 0; row < kDepth; ++row) {
+    result = std::min(result, counts_[cell(hash, row)]);
+  }
+  return result;
+}
@@ -0,0 +1,251 @@
+/**
+ *  @file deltalog.cpp
+ *  @brief DeltaLog class implementation
+ */
+
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014 Michael Maraya
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "ipforensics/deltalog.h"
+#include "ipforensics/snapshot.h"
+
+static_assert(sizeof(DeltaLog::Header) == 32, "unexpected Header padding");
+static_assert(sizeof(DeltaLog::Batch) == 24, "unexpected Batch padding");
+
+namespace {
+
+/**
+ *  @brief Reads a whole file
+ *  @param filename file to read
+ *  @param data receives the contents of the file
+ *  @retval bool true if read, false if the file does not exist
+ *  @throws std::runtime_error if the file cannot be read
+ */
+bool read_file(const std::string& filename, std::vector<uint8_t>* data) {
+  int fd = open(filename.c_str(), O_RDONLY);
+  if (fd < 0) {
+    if (errno == ENOENT) return false;
+    throw std::runtime_error("Could not open delta log " + filename);
+  }
+  struct stat st;
+  bool ok = fstat(fd, &st) == 0;
+  if (ok) data->resize(static_cast<size_t>(st.st_size));
+  size_t done = 0;
+  while (ok && done < data->size()) {
+    ssize_t n = read(fd, data->data() + done, data->size() - done);
+    if (n < 0 && errno == EINTR) continue;
+    ok = n > 0;
+    if (ok) done += static_cast<size_t>(n);
+  }
+  close(fd);
+  if (!ok) throw std::runtime_error("Could not read delta log " + filename);
+  return true;
+}
+
+}  // namespace
+
+std::string DeltaLog::filename() const {
+  return filename_;
+}
+
+uint64_t DeltaLog::records() const {
+  return records_;
+}
+
+void DeltaLog::set_filename(const std::string& filename) {
+  filename_ = filename;
+}
+
+void DeltaLog::set_base(uint64_t base, uint64_t records) {
+  based_ = true;
+  base_ = base;
+  base_records_ = records;
+}
+
+void DeltaLog::reset() {
+  based_ = false;
+  records_ = 0;
+  size_ = 0;
+}
+
+bool DeltaLog::due(uint64_t records) const {
+  return !based_ ||
+         (records_ + records) * ipf::kDeltaLogCompaction > base_records_;
+}
+
+/**
+ *  @details Complete batches are checked before any of them is applied, and 
+ *           the first incomplete or damaged batch ends the log.  Records are
+ *           copied out of the file since batches after the first are not
+ *           aligned.  A removed host's record only carries its MAC address.
+ */
+uint64_t DeltaLog::replay(IPForensics* ip) {
+  records_ = 0;
+  size_ = 0;
+  std::vector<uint8_t> data;
+  if (!read_file(filename_, &data)) return 0;
+  Header header;
+  if (data.size() < sizeof(header) ||
+      std::memcmp(data.data(), ipf::kDeltaLogMagic, sizeof(header.magic))) {
+    throw std::runtime_error(filename_ + ": not a delta log");
+  }
+  std::memcpy(&header, data.data(), sizeof(header));
+  if (header.version != ipf::kSnapshotVersion ||
+      header.byte_order != ipf::kSnapshotByteOrder ||
+      header.record_size != sizeof(Snapshot::Record) ||
+      header.alias_size != sizeof(Snapshot::Alias)) {
+    throw std::runtime_error(filename_ + ": unsupported delta log format");
+  }
+  // a log left by a crash during compaction belongs to the older snapshot
+  if (!based_ || header.base != base_) return 0;
+  std::vector<std::vector<Snapshot::Record>> records;
+  std::vector<std::vector<Snapshot::Alias>> aliases;
+  size_t offset = sizeof(header);
+  while (data.size() - offset >= sizeof(Batch)) {
+    Batch batch;
+    std::memcpy(&batch, data.data() + offset, sizeof(batch));
+    size_t left = data.size() - offset - sizeof(batch);
+    if (batch.records > left / sizeof(Snapshot::Record) ||
+        batch.aliases > left / sizeof(Snapshot::Alias) ||
+        batch.records * sizeof(Snapshot::Record) +
+        batch.aliases * sizeof(Snapshot::Alias) > left) {
+      break;
+    }
+    const uint8_t* body = data.data() + offset + sizeof(batch);
+    size_t record_bytes = batch.records * sizeof(Snapshot::Record);
+    size_t alias_bytes = batch.aliases * sizeof(Snapshot::Alias);
+    if (Snapshot::checksum(body, record_bytes + alias_bytes) !=
+        batch.checksum) {
+      break;
+    }
+    records.emplace_back(batch.records);
+    aliases.emplace_back(batch.aliases);
+    std::memcpy(records.back().data(), body, record_bytes);
+    std::memcpy(aliases.back().data(), body + record_bytes, alias_bytes);
+    for (const Snapshot::Record& r : records.back()) {
+      if (r.alias > batch.aliases ||
+          r.alias_count > batch.aliases - r.alias) {
+        throw std::runtime_error(filename_ + ": alias index out of range");
+      }
+    }
+    offset += sizeof(batch) + record_bytes + alias_bytes;
+  }
+  for (size_t i = 0; i < records.size(); ++i) {
+    for (const Snapshot::Record& r : records[i]) {
+      if (r.flags & Snapshot::kRemoved) {
+        ip->drop_host(Host::unpack(r.mac));
+      } else {
+        Activity activity;
+        Host host = Snapshot::decode(r, aliases[i].data(), ip, &activity);
+        ip->replace_host(host, activity);
+      }
+      ++records_;
+    }
+  }
+  size_ = offset;
+  return records_;
+}
+
+/**
+ *  @details Removed hosts go first so a host removed and added again in the
+ *           same run ends up present.  A new log is written whole with 
+ *           Snapshot::replace().  Otherwise anything after the last complete
+ *           batch is cut off and the batch is written in one piece and 
+ *           flushed to disk before the append counts as done.
+ */
+void DeltaLog::append(const IPForensics& ip) {
+  std::vector<Snapshot::Record> records;
+  std::vector<Snapshot::Alias> aliases;
+  for (uint64_t mac : ip.removed()) {
+    Snapshot::Record r {};
+    r.mac = mac;
+    r.flags = Snapshot::kRemoved;
+    records.push_back(r);
+  }
+  for (const Host& h : ip.hosts()) {
+    if (ip.changed(h)) {
+      records.push_back(Snapshot::encode(h, ip.activity(h), &aliases));
+    }
+  }
+  if (records.empty()) return;
+  size_t record_bytes = records.size() * sizeof(Snapshot::Record);
+  size_t alias_bytes = aliases.size() * sizeof(Snapshot::Alias);
+  Batch batch {};
+  batch.records = records.size();
+  batch.aliases = aliases.size();
+  batch.checksum = Snapshot::checksum(records.data(), record_bytes);
+  batch.checksum = Snapshot::checksum(aliases.data(), alias_bytes,
+                                      batch.checksum);
+  if (size_ == 0) {
+    Header header {};
+    std::memcpy(header.magic, ipf::kDeltaLogMagic, sizeof(header.magic));
+    header.version = ipf::kSnapshotVersion;
+    header.byte_order = ipf::kSnapshotByteOrder;
+    header.record_size = sizeof(Snapshot::Record);
+    header.alias_size = sizeof(Snapshot::Alias);
+    header.base = base_;
+    Snapshot::replace(filename_, {{&header, sizeof(header)},
+                                  {&batch, sizeof(batch)},
+                                  {records.data(), record_bytes},
+                                  {aliases.data(), alias_bytes}});
+    size_ = sizeof(header);
+  } else {
+    std::vector<uint8_t> buffer(sizeof(batch) + record_bytes + alias_bytes);
+    std::memcpy(buffer.data(), &batch, sizeof(batch));
+    std::memcpy(buffer.data() + sizeof(batch), records.data(), record_bytes);
+    std::memcpy(buffer.data() + sizeof(batch) + record_bytes, aliases.data(),
+                alias_bytes);
+    int fd = open(filename_.c_str(), O_WRONLY);
+    if (fd < 0) {
+      throw std::runtime_error("Could not open delta log " + filename_);
+    }
+    off_t end = static_cast<off_t>(size_);
+    bool ok = ftruncate(fd, end) == 0 && lseek(fd, end, SEEK_SET) == end &&
+              Snapshot::write(fd, buffer.data(), buffer.size()) &&
+              fdatasync(fd) == 0;
+    ok = close(fd) == 0 && ok;
+    if (!ok) {
+      throw std::runtime_error("Could not append to delta log " + filename_);
+    }
+  }
+  size_ += sizeof(batch) + record_bytes + alias_bytes;
+  records_ += records.size();
+}
+
+void DeltaLog::compacted(uint64_t base, uint64_t records) {
+  set_base(base, records);
+  records_ = 0;
+  size_ = 0;
+  if (unlink(filename_.c_str()) != 0 && errno != ENOENT) {
+    throw std::runtime_error("Could not remove delta log " + filename_);
+  }
+}
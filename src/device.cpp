@@ -31,6 +31,7 @@
 #include <vector>
 #include "ipforensics/ip4and6.h"
 #include "ipforensics/device.h"
+#include "ipforensics/publisher.h"
 
 Device::Device(IPForensics* ipf) {
   ipf_ = ipf;
@@ -57,6 +58,10 @@ IPv4Address Device::mask() const {
   return mask_;
 }
 
+std::vector<std::pair<IPv6Address, int>> Device::ipv6_prefixes() const {
+  return ipv6_prefixes_;
+}
+
 std::vector<Packet> Device::packets() const {
   return ipf_->packets();
 }
@@ -81,6 +86,10 @@ void Device::set_mask(const IPv4Address mask) {
   mask_ = mask;
 }
 
+void Device::add_ipv6_prefix(const IPv6Address net, int length) {
+  ipv6_prefixes_.push_back(std::make_pair(net, length));
+}
+
 /**
  * @details This method currently only handles Ethernet frames so an exception 
  *          will be thrown if other types are detected
@@ -88,6 +97,50 @@ void Device::set_mask(const IPv4Address mask) {
  *        link-layer header type for the live capture is not IEEE 802.3 Ethernet
  */
 int Device::capture(const int n) {
+  pcap_t* pcap = open();
+  const unsigned char * packet = NULL;
+  struct pcap_pkthdr header;
+  for (int i = 0; i < n; ++i) {
+    packet = pcap_next(pcap, &header);
+    if (packet != NULL && ipf_->sampler_.keep(header, packet)) {
+      ipf_->packets_.push_back(Packet(header, packet));
+    }
+  }
+  pcap_close(pcap);
+  return static_cast<int>(packets().size());
+}
+
+/**
+ * @details The Publisher is polled whenever the second of the packet time
+ *          changes and whenever the read times out, so a write that comes due
+ *          on a quiet network still starts within ipf::kTimeout milliseconds.
+ */
+int Device::stream(const int n, Publisher* publisher,
+                   const volatile sig_atomic_t* stop) {
+  pcap_t* pcap = open();
+  const unsigned char* packet = NULL;
+  struct pcap_pkthdr* header = NULL;
+  int count {0};
+  time_t second {0};
+  while (!*stop && (n == 0 || count < n)) {
+    int result = pcap_next_ex(pcap, &header, &packet);
+    if (result < 0) break;
+    if (result == 1) {
+      ++count;
+      if (ipf_->sampler_.keep(*header, packet)) {
+        ipf_->process_packet(Packet(*header, packet));
+      }
+    }
+    if (result == 0 || header->ts.tv_sec != second) {
+      if (result == 1) second = header->ts.tv_sec;
+      publisher->poll();
+    }
+  }
+  pcap_close(pcap);
+  return count;
+}
+
+pcap_t* Device::open() const {
   char error[PCAP_ERRBUF_SIZE] {};
   pcap_t* pcap = pcap_open_live(name_.c_str(), ipf::kSnapLength, true,
                                 ipf::kTimeout, error);
@@ -98,16 +151,7 @@ int Device::capture(const int n) {
     pcap_close(pcap);
     throw std::runtime_error("Link-layer type not IEEE 802.3 Ethernet");
   }
-  const unsigned char * packet = NULL;
-  struct pcap_pkthdr header;
-  for (int i = 0; i < n; ++i) {
-    packet = pcap_next(pcap, &header);
-    if (packet != NULL) {
-      ipf_->packets_.push_back(Packet(packet));
-    }
-  }
-  pcap_close(pcap);
-  return static_cast<int>(packets().size());
+  return pcap;
 }
 
 std::ostream &operator<<(std::ostream &out, const Device &d) {
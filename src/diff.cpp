@@ -0,0 +1,274 @@
+/**
+ *  @file diff.cpp
+ *  @brief Diff class implementation
+ */
+
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014 Michael Maraya
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <algorithm>
+#include <array>
+#include <cstdio>
+#include <cstring>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "ipforensics/diff.h"
+#include "ipforensics/threads.h"
+
+namespace {
+
+/** One address of a host: the family, 4 or 6, then 16 octets */
+typedef std::array<uint8_t, 17> Key;
+
+/**
+ *  @brief Lists every address of a Record, the primary ones first
+ *  @param record Record to list
+ *  @param aliases Alias entries the Record indexes
+ *  @param keys receives the addresses
+ */
+void addresses(const Snapshot::Record& record,
+               const Snapshot::Alias* aliases, std::vector<Key>* keys) {
+  keys->clear();
+  if (record.flags & Snapshot::kHasIPv4) {
+    Key k {};
+    k[0] = 4;
+    for (size_t i = 0; i < ipf::kLengthIPv4; ++i) {
+      k[1 + i] = static_cast<uint8_t>(record.ipv4 >> (8 * i));
+    }
+    keys->push_back(k);
+  }
+  if (record.flags & Snapshot::kHasIPv6) {
+    Key k {};
+    k[0] = 6;
+    std::memcpy(&k[1], record.ipv6, sizeof(record.ipv6));
+    keys->push_back(k);
+  }
+  for (uint32_t j = record.alias; j < record.alias + record.alias_count; ++j) {
+    Key k {};
+    k[0] = aliases[j].family;
+    std::memcpy(&k[1], aliases[j].address, sizeof(aliases[j].address));
+    keys->push_back(k);
+  }
+}
+
+/**
+ *  @brief Determines if two Records hold the same addresses in the same 
+ *         order, the common case, without listing them
+ *  @param a first Record
+ *  @param a_aliases Alias entries the first Record indexes
+ *  @param b second Record
+ *  @param b_aliases Alias entries the second Record indexes
+ *  @retval bool true if the addresses are the same
+ */
+bool same(const Snapshot::Record& a, const Snapshot::Alias* a_aliases,
+          const Snapshot::Record& b, const Snapshot::Alias* b_aliases) {
+  const uint8_t families = Snapshot::kHasIPv4 | Snapshot::kHasIPv6;
+  if ((a.flags & families) != (b.flags & families)) return false;
+  if ((a.flags & Snapshot::kHasIPv4) && a.ipv4 != b.ipv4) return false;
+  if ((a.flags & Snapshot::kHasIPv6) &&
+      std::memcmp(a.ipv6, b.ipv6, sizeof(a.ipv6)) != 0) {
+    return false;
+  }
+  return a.alias_count == b.alias_count &&
+         std::memcmp(a_aliases + a.alias, b_aliases + b.alias,
+                     a.alias_count * sizeof(Snapshot::Alias)) == 0;
+}
+
+/**
+ *  @brief Determines if a list of addresses includes an IPv6 address
+ *  @param keys addresses to check
+ *  @retval bool true if any address is IPv6
+ */
+bool has_ipv6(const std::vector<Key>& keys) {
+  for (const Key& k : keys) {
+    if (k[0] == 6) return true;
+  }
+  return false;
+}
+
+/**
+ *  @brief Appends a space, a prefix and the text of an address
+ *  @param prefix '+', '-' or '\0' for none
+ *  @param k address to append
+ *  @param line receives the text
+ */
+void append(char prefix, const Key& k, std::string* line) {
+  char text[ipf::kOutputLengthIPv6 + 2];
+  char* out = text;
+  *out++ = ' ';
+  if (prefix != '\0') *out++ = prefix;
+  out = k[0] == 4 ? IPv4Address::format(&k[1], out) :
+                    IPv6Address::format(&k[1], out);
+  line->append(text, out);
+}
+
+/**
+ *  @brief Appends a change marker and the text of a MAC address
+ *  @param marker '+', '-' or '~'
+ *  @param mac MAC address, as Host::pack(const MACAddress&)
+ *  @param line receives the text
+ */
+void begin(char marker, uint64_t mac, std::string* line) {
+  uint8_t octets[6];
+  for (size_t i = sizeof(octets); i > 0; --i) {
+    octets[i - 1] = static_cast<uint8_t>(mac);
+    mac >>= 8;
+  }
+  char text[ipf::kOutputLengthMAC + 2];
+  char* out = text;
+  *out++ = marker;
+  *out++ = ' ';
+  out = MACAddress::format(octets, out);
+  line->append(text, out);
+}
+
+}  // namespace
+
+Diff::Diff(IPForensics* ip, const std::string& before,
+           const std::string& after) {
+  ip_ = ip;
+  before_ = before;
+  after_ = after;
+}
+
+IPForensics* Diff::ip() const {
+  return ip_;
+}
+
+std::string Diff::before() const {
+  return before_;
+}
+
+std::string Diff::after() const {
+  return after_;
+}
+
+const std::vector<std::string>& Diff::errors() const {
+  return errors_;
+}
+
+const Diff::Counts& Diff::counts() const {
+  return counts_;
+}
+
+/**
+ *  @details The two files are read on two threads with Merge::read().  The
+ *           lines are gathered into ipf::kReportBufferSize chunks before 
+ *           they are written, so a large diff takes a few large writes.  Added
+ *           and removed hosts list all of their addresses, primary ones 
+ *           first; changed hosts list the addresses gained, marked '+', and 
+ *           then those lost, marked '-'.
+ */
+void Diff::run(std::ostream* out) {
+  Merge reader(ip_);
+  reader.add_file(before_);
+  reader.add_file(after_);
+  Merge::Run runs[2];
+  std::string failures[2];
+  auto work = [&](size_t i) {
+    try {
+      reader.read(reader.files()[i], &runs[i]);
+    } catch (std::exception const &e) {
+      failures[i] = e.what();
+    }
+  };
+  run_threads(2, work);
+  for (const std::string& f : failures) {
+    if (!f.empty()) throw std::runtime_error(f);
+  }
+  errors_ = runs[0].errors;
+  errors_.insert(errors_.end(), runs[1].errors.begin(), runs[1].errors.end());
+  counts_ = Counts();
+  const std::vector<Snapshot::Record>& a = runs[0].records;
+  const std::vector<Snapshot::Record>& b = runs[1].records;
+  const Snapshot::Alias* a_aliases = runs[0].aliases.data();
+  const Snapshot::Alias* b_aliases = runs[1].aliases.data();
+  std::string buffer;
+  buffer.reserve(ipf::kReportBufferSize + 4096);
+  std::vector<Key> before, after, gained, lost;
+  size_t i = 0, j = 0;
+  while (i < a.size() || j < b.size()) {
+    size_t start = buffer.size();
+    if (j == b.size() || (i < a.size() && a[i].mac < b[j].mac)) {
+      begin('-', a[i].mac, &buffer);
+      addresses(a[i], a_aliases, &before);
+      for (const Key& k : before) append('\0', k, &buffer);
+      ++counts_.removed;
+      ++i;
+    } else if (i == a.size() || b[j].mac < a[i].mac) {
+      begin('+', b[j].mac, &buffer);
+      addresses(b[j], b_aliases, &after);
+      for (const Key& k : after) append('\0', k, &buffer);
+      ++counts_.added;
+      ++j;
+    } else {
+      bool unchanged = same(a[i], a_aliases, b[j], b_aliases);
+      if (!unchanged) {
+        // compare as sets, since the same addresses may be listed in any order
+        addresses(a[i], a_aliases, &before);
+        addresses(b[j], b_aliases, &after);
+        std::sort(before.begin(), before.end());
+        std::sort(after.begin(), after.end());
+        gained.clear();
+        lost.clear();
+        std::set_difference(after.begin(), after.end(), before.begin(),
+                            before.end(), std::back_inserter(gained));
+        std::set_difference(before.begin(), before.end(), after.begin(),
+                            after.end(), std::back_inserter(lost));
+        unchanged = gained.empty() && lost.empty();
+      }
+      if (unchanged) {
+        ++counts_.unchanged;
+      } else {
+        begin('~', b[j].mac, &buffer);
+        for (const Key& k : gained) append('+', k, &buffer);
+        for (const Key& k : lost) append('-', k, &buffer);
+        ++counts_.changed;
+        if (!has_ipv6(before) && has_ipv6(after)) ++counts_.gained_ipv6;
+      }
+      ++i;
+      ++j;
+    }
+    if (buffer.size() == start) continue;
+    buffer += '\n';
+    if (buffer.size() >= ipf::kReportBufferSize) {
+      out->write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+      buffer.clear();
+    }
+  }
+  char line[256];
+  int length = std::snprintf(line, sizeof(line), "Added: %zu; removed: %zu;"
+                             " changed: %zu; unchanged: %zu; gained IPv6: "
+                             "%zu\n", counts_.added, counts_.removed,
+                             counts_.changed, counts_.unchanged,
+                             counts_.gained_ipv6);
+  buffer.append(line, static_cast<size_t>(length));
+  out->write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+  out->flush();
+  if (!*out) {
+    throw std::runtime_error("could not write the differences");
+  }
+}
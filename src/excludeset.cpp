@@ -0,0 +1,248 @@
+/**
+ *  @file excludeset.cpp
+ *  @brief ExcludeSet class implementation
+ */
+
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014 Michael Maraya
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <algorithm>
+#include <cctype>
+#include <fstream>  // NOLINT
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "ipforensics/excludeset.h"
+#include "ipforensics/ip4and6.h"
+
+namespace {
+
+/** table_ value of an empty slot */
+const uint64_t kEmpty {UINT64_MAX};
+
+/** tag of MAC address keys */
+const uint64_t kTagMAC {1ULL << 48};
+
+/** tag of IPv4 address keys */
+const uint64_t kTagIPv4 {2ULL << 48};
+
+/** Determines whether text is a MAC address in report notation */
+bool is_mac(const std::string& text) {
+  if (text.length() != ipf::kOutputLengthMAC) return false;
+  for (size_t i = 0; i < text.length(); ++i) {
+    if (i % 3 == 2) {
+      if (text[i] != ':') return false;
+    } else if (!isxdigit(static_cast<unsigned char>(text[i]))) {
+      return false;
+    }
+  }
+  return true;
+}
+
+/** Parses an IPv4 address, rejecting anything but four dotted octets 0-255 */
+IPv4Address parse_ipv4(const std::string& text) {
+  if (text.find_first_not_of("0123456789.") != std::string::npos ||
+      std::count(text.begin(), text.end(), '.') != 3) {
+    throw std::invalid_argument("bad IPv4 address");
+  }
+  return IPv4Address(text);
+}
+
+}  // namespace
+
+size_t ExcludeSet::size() const {
+  return addresses_ + ipv4_networks_.size() + ipv6_networks_.size();
+}
+
+bool ExcludeSet::empty() const {
+  return size() == 0;
+}
+
+/**
+ *  @details 64-bit finalizer from MurmurHash3.
+ */
+uint64_t ExcludeSet::hash(uint64_t key) {
+  key ^= key >> 33;
+  key *= 0xff51afd7ed558ccdULL;
+  key ^= key >> 33;
+  key *= 0xc4ceb9fe1a85ec53ULL;
+  key ^= key >> 33;
+  return key;
+}
+
+uint64_t ExcludeSet::fold(const Host::PackedIPv6& ipv6) {
+  uint64_t high {0}, low {0};
+  for (size_t i = 0; i < 8; ++i) {
+    high = (high << 8) | ipv6[i];
+    low = (low << 8) | ipv6[i + 8];
+  }
+  return high ^ hash(low);
+}
+
+/**
+ *  @details The upper 36 bits of the hash pick the bits, six at a time; the
+ *           lower bits pick the word.
+ */
+uint64_t ExcludeSet::bloom_bits(uint64_t h) {
+  uint64_t bits {0};
+  for (int i = 0; i < ipf::kExcludeBloomBits; ++i) {
+    bits |= 1ULL << ((h >> (28 + 6 * i)) & 63);
+  }
+  return bits;
+}
+
+bool ExcludeSet::maybe(uint64_t h) const {
+  if (bloom_.empty()) return true;
+  uint64_t bits = bloom_bits(h);
+  return (bloom_[h & (bloom_.size() - 1)] & bits) == bits;
+}
+
+bool ExcludeSet::find(uint64_t key) const {
+  if (table_.empty()) return false;
+  uint64_t h = hash(key);
+  if (!maybe(h)) return false;
+  size_t mask = table_.size() - 1;
+  for (size_t i = h & mask; table_[i] != kEmpty; i = (i + 1) & mask) {
+    if (table_[i] == key) return true;
+  }
+  return false;
+}
+
+/**
+ *  @details table_ is sized to a power of two at most half full, so probe
+ *           sequences stay short.
+ */
+void ExcludeSet::build(const std::vector<uint64_t>& keys) {
+  size_t capacity {16};
+  while (capacity < keys.size() * 2) capacity <<= 1;
+  table_.assign(capacity, kEmpty);
+  size_t mask = capacity - 1;
+  size_t unique {0};
+  for (uint64_t key : keys) {
+    size_t i = hash(key) & mask;
+    while (table_[i] != kEmpty && table_[i] != key) i = (i + 1) & mask;
+    if (table_[i] == kEmpty) ++unique;
+    table_[i] = key;
+  }
+  addresses_ = unique + ipv6_.size();
+  bloom_.clear();
+  if (addresses_ < ipf::kExcludeBloomEntries) return;
+  size_t words {1};
+  while (words * 64 < addresses_ * ipf::kExcludeBloomBitsPerEntry) words <<= 1;
+  bloom_.assign(words, 0);
+  for (uint64_t key : keys) {
+    uint64_t h = hash(key);
+    bloom_[h & (words - 1)] |= bloom_bits(h);
+  }
+  for (const Host::PackedIPv6& ipv6 : ipv6_) {
+    uint64_t h = hash(fold(ipv6));
+    bloom_[h & (words - 1)] |= bloom_bits(h);
+  }
+}
+
+/**
+ *  @details A line is a MAC address if it has the xx:xx:xx:xx:xx:xx form, 
+ *           otherwise IPv6 if it contains a colon, and IPv4 otherwise.  A
+ *           network with a full-length prefix is stored as an address.
+ */
+void ExcludeSet::load(const std::string& filename) {
+  std::ifstream fs(filename);
+  if (!fs.is_open()) {
+    throw std::runtime_error("Could not open exclude file " + filename);
+  }
+  *this = ExcludeSet();
+  std::vector<uint64_t> keys;
+  std::string line;
+  for (int number = 1; std::getline(fs, line); ++number) {
+    line = line.substr(0, line.find('#'));
+    size_t start = line.find_first_not_of(" \t\r");
+    if (start == std::string::npos) continue;
+    std::string text = line.substr(start, line.find_last_not_of(" \t\r") -
+                                   start + 1);
+    try {
+      if (is_mac(text)) {
+        keys.push_back(kTagMAC | Host::pack(MACAddress(text)));
+        continue;
+      }
+      size_t slash = text.find('/');
+      std::string address = text.substr(0, slash);
+      bool v6 = (address.find(':') != std::string::npos);
+      int bits = v6 ? 128 : 32;
+      int length = bits;
+      if (slash != std::string::npos) {
+        size_t used {0};
+        length = std::stoi(text.substr(slash + 1), &used);
+        if (used != text.length() - slash - 1 || length < 0 || length > bits) {
+          throw std::invalid_argument("bad prefix length");
+        }
+      }
+      if (v6) {
+        Host::PackedIPv6 packed = Host::pack(IPv6Address(address));
+        if (length == bits) {
+          ipv6_.insert(packed);
+        } else {
+          ipv6_networks_.insert(packed, length);
+        }
+      } else {
+        Host::PackedIPv4 packed = Host::pack(parse_ipv4(address));
+        if (length == bits) {
+          keys.push_back(kTagIPv4 | packed);
+        } else {
+          PrefixTrie::Key key {};
+          for (size_t i = 0; i < ipf::kLengthIPv4; ++i) {
+            key[i] = static_cast<uint8_t>(packed >> (8 * i));
+          }
+          ipv4_networks_.insert(key, length);
+        }
+      }
+    } catch (std::exception const &e) {
+      throw std::runtime_error(filename + ':' + std::to_string(number) +
+                               ": invalid entry '" + text + "'");
+    }
+  }
+  build(keys);
+}
+
+bool ExcludeSet::excluded(const MACAddress& mac) const {
+  return find(kTagMAC | Host::pack(mac));
+}
+
+bool ExcludeSet::excluded(const IPv4Address& ipv4) const {
+  Host::PackedIPv4 packed = Host::pack(ipv4);
+  if (find(kTagIPv4 | packed)) return true;
+  if (ipv4_networks_.empty()) return false;
+  PrefixTrie::Key key {};
+  for (size_t i = 0; i < ipf::kLengthIPv4; ++i) {
+    key[i] = static_cast<uint8_t>(packed >> (8 * i));
+  }
+  return ipv4_networks_.contains(key, 32);
+}
+
+bool ExcludeSet::excluded(const IPv6Address& ipv6) const {
+  Host::PackedIPv6 packed = Host::pack(ipv6);
+  if (!ipv6_.empty() && maybe(hash(fold(packed))) && ipv6_.count(packed)) {
+    return true;
+  }
+  return !ipv6_networks_.empty() && ipv6_networks_.contains(packed, 128);
+}
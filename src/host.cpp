@@ -27,11 +27,93 @@
  * SOFTWARE.
  */
 
+#include <time.h>
+#include <algorithm>
 #include <iomanip>
 #include <iostream>  // NOLINT we mostly use this for logging
+#include <vector>
 #include "ipforensics/address.h"
 #include "ipforensics/host.h"
 
+void Activity::update(int64_t time, uint32_t length) {
+  ++packets;
+  bytes += length;
+  if (first_seen == 0 || time < first_seen) first_seen = time;
+  if (time > last_seen) last_seen = time;
+}
+
+void Activity::merge(const Activity& other) {
+  packets += other.packets;
+  bytes += other.bytes;
+  if (first_seen == 0 || (other.first_seen != 0 &&
+                          other.first_seen < first_seen)) {
+    first_seen = other.first_seen;
+  }
+  last_seen = std::max(last_seen, other.last_seen);
+}
+
+/**
+ *  @details Uses one-second resolution and ISO 8601 format.
+ */
+std::string utc_time(int64_t time) {
+  char text[32] {};
+  time_t seconds = static_cast<time_t>(time / 1000000);
+  struct tm utc;
+  if (time != 0 && gmtime_r(&seconds, &utc) != nullptr) {
+    strftime(text, sizeof(text), "%Y-%m-%dT%H:%M:%SZ", &utc);
+  }
+  return text;
+}
+
+/**
+ *  @details Times are displayed in UTC, or left blank if not yet seen.
+ */
+std::ostream& operator<<(std::ostream& out, const Activity& a) {
+  std::ios::fmtflags fmt(out.flags());
+  out << std::right << std::setfill(' ') << std::dec;
+  out << std::setw(10) << a.packets << ' ';
+  out << std::setw(14) << a.bytes << ' ';
+  out << std::left;
+  out << std::setw(20) << utc_time(a.first_seen) << ' ';
+  out << std::setw(20) << utc_time(a.last_seen);
+  out.flags(fmt);
+  return out;
+}
+
+Host::PackedIPv4 Host::pack(const IPv4Address& ipv4) {
+  const std::vector<uint8_t>& octets = ipv4.address();
+  PackedIPv4 packed {0};
+  for (size_t i = 0; i < octets.size() && i < 4; ++i) {
+    packed |= static_cast<PackedIPv4>(octets[i]) << (8 * i);
+  }
+  return packed;
+}
+
+Host::PackedIPv6 Host::pack(const IPv6Address& ipv6) {
+  const std::vector<uint8_t>& octets = ipv6.address();
+  PackedIPv6 packed {};
+  std::copy_n(octets.begin(), std::min(octets.size(), packed.size()),
+              packed.begin());
+  return packed;
+}
+
+uint64_t Host::pack(const MACAddress& mac) {
+  uint64_t packed {0};
+  for (uint8_t octet : mac.address()) {
+    packed = (packed << 8) | octet;
+  }
+  return packed;
+}
+
+MACAddress Host::unpack(uint64_t mac) {
+  std::vector<uint8_t> octets(6);
+  for (size_t i = octets.size(); i > 0; --i) {
+    octets[i - 1] = static_cast<uint8_t>(mac);
+    mac >>= 8;
+  }
+  return MACAddress(octets);
+}
+
 Host::Host() {
 }
 
@@ -41,36 +123,139 @@ Host::Host(const MACAddress mac) {
 
 Host::Host(const MACAddress mac, const IPv4Address v4, const IPv6Address v6) {
   mac_ = mac;
-  ipv4_ = v4;
-  ipv6_ = v6;
+  set_ipv4(v4);
+  set_ipv6(v6);
 }
 
-MACAddress Host::mac() const {
+const MACAddress& Host::mac() const {
   return mac_;
 }
 
-IPv4Address Host::ipv4() const {
+const IPv4Address& Host::ipv4() const {
   return ipv4_;
 }
 
-IPv6Address Host::ipv6() const {
+const IPv6Address& Host::ipv6() const {
   return ipv6_;
 }
 
+std::vector<IPv4Address> Host::ipv4s() const {
+  std::vector<IPv4Address> result;
+  for (size_t i = 0; i < ipv4s_.size(); ++i) {
+    result.push_back(IPv4Address(ipv4s_[i]));
+  }
+  return result;
+}
+
+std::vector<IPv6Address> Host::ipv6s() const {
+  std::vector<IPv6Address> result;
+  for (size_t i = 0; i < ipv6s_.size(); ++i) {
+    result.push_back(IPv6Address(std::vector<uint8_t>(ipv6s_[i].begin(),
+                                                      ipv6s_[i].end())));
+  }
+  return result;
+}
+
+const AddressSet<Host::PackedIPv4, Host::kInlineIPv4>& Host::packed_ipv4s()
+    const {
+  return ipv4s_;
+}
+
+const AddressSet<Host::PackedIPv6, Host::kInlineIPv6>& Host::packed_ipv6s()
+    const {
+  return ipv6s_;
+}
+
+uint32_t Host::slot() const {
+  return slot_;
+}
+
 void Host::set_ipv4(const IPv4Address ipv4) {
   ipv4_ = ipv4;
+  if (!ipv4.empty()) ipv4s_.insert(pack(ipv4), SIZE_MAX);
 }
 
 void Host::set_ipv6(const IPv6Address ipv6) {
   ipv6_ = ipv6;
+  if (!ipv6.empty()) ipv6s_.insert(pack(ipv6), SIZE_MAX);
+}
+
+/**
+ *  @details Broadcast and multicast addresses are only accepted as the primary
+ *           address, where IPForensics::clean_hosts() can still find them.
+ */
+bool Host::add_ipv4(const IPv4Address& ipv4, size_t cap) {
+  if (ipv4.empty()) return false;
+  if (ipv4_.empty()) {
+    set_ipv4(ipv4);
+    return true;
+  }
+  if (ipv4.fake()) return false;
+  return ipv4s_.insert(pack(ipv4), cap);
+}
+
+/**
+ *  @details Multicast addresses are only accepted as the primary address, 
+ *           where IPForensics::clean_hosts() can still find them.
+ */
+bool Host::add_ipv6(const IPv6Address& ipv6, size_t cap) {
+  if (ipv6.empty()) return false;
+  if (ipv6_.empty()) {
+    set_ipv6(ipv6);
+    return true;
+  }
+  if (ipv6.fake()) return false;
+  return ipv6s_.insert(pack(ipv6), cap);
+}
+
+bool Host::adds_ipv4(const IPv4Address& ipv4, size_t cap) const {
+  if (ipv4.empty()) return false;
+  if (ipv4_.empty()) return true;
+  if (ipv4.fake()) return false;
+  return ipv4s_.size() < cap && !ipv4s_.contains(pack(ipv4));
+}
+
+bool Host::adds_ipv6(const IPv6Address& ipv6, size_t cap) const {
+  if (ipv6.empty()) return false;
+  if (ipv6_.empty()) return true;
+  if (ipv6.fake()) return false;
+  return ipv6s_.size() < cap && !ipv6s_.contains(pack(ipv6));
+}
+
+/**
+ *  @details Both address lists are walked in the order the addresses were 
+ *           first seen, skipping the primary addresses, and paired up row by
+ *           row until both are exhausted.
+ */
+std::vector<Host> Host::aliases() const {
+  std::vector<Host> result;
+  std::vector<IPv4Address> v4;
+  std::vector<IPv6Address> v6;
+  for (const IPv4Address& a : ipv4s()) {
+    if (a != ipv4_) v4.push_back(a);
+  }
+  for (const IPv6Address& a : ipv6s()) {
+    if (a != ipv6_) v6.push_back(a);
+  }
+  for (size_t i = 0; i < v4.size() || i < v6.size(); ++i) {
+    Host alias;
+    if (i < v4.size()) alias.ipv4_ = v4[i];
+    if (i < v6.size()) alias.ipv6_ = v6[i];
+    result.push_back(alias);
+  }
+  return result;
+}
+
+void Host::set_slot(const uint32_t slot) {
+  slot_ = slot;
 }
 
 /**
- *  @details Uses the std::string.compare() function to compare the characters
- *           of the MAC address
+ *  @details Compares the octets of the MAC addresses, which orders Hosts the
+ *           same way as their printed MAC addresses without formatting them
  */
 bool operator<(const Host& lhs, const Host& rhs) {
-  return (rhs.mac().str().compare(lhs.mac().str()) > 0);
+  return lhs.mac().address() < rhs.mac().address();
 }
 
 /**
@@ -81,11 +266,10 @@ bool operator>(const Host& lhs, const Host& rhs) {
 }
 
 /**
- *  @details Performs an std::string comparison of the string representation of
- *           the MAC addresses
+ *  @details Compares the octets of the MAC addresses
  */
 bool operator==(const Host& lhs, const Host& rhs) {
-  return (lhs.mac().str().compare(rhs.mac().str()) == 0);
+  return lhs.mac().address() == rhs.mac().address();
 }
 
 /**
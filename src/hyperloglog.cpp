@@ -0,0 +1,105 @@
+/**
+ *  @file hyperloglog.cpp
+ *  @brief HyperLogLog class implementation
+ */
+
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014 Michael Maraya
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <string>
+#include "ipforensics/hyperloglog.h"
+
+double HyperLogLog::error() {
+  return 1.04 / std::sqrt(static_cast<double>(kRegisters));
+}
+
+/**
+ *  @details 64-bit finalizer from MurmurHash3.
+ */
+uint64_t HyperLogLog::hash(uint64_t key) {
+  key ^= key >> 33;
+  key *= 0xff51afd7ed558ccdULL;
+  key ^= key >> 33;
+  key *= 0xc4ceb9fe1a85ec53ULL;
+  key ^= key >> 33;
+  return key;
+}
+
+/**
+ *  @details The top kPrecision bits pick the register; the rank is the 
+ *           position of the first set bit in the rest.
+ */
+void HyperLogLog::add(uint64_t hash) {
+  size_t index = static_cast<size_t>(hash >> (64 - kPrecision));
+  uint64_t rest = (hash << kPrecision) | (uint64_t {1} << (kPrecision - 1));
+  uint8_t rank = static_cast<uint8_t>(__builtin_clzll(rest) + 1);
+  if (rank > registers_[index]) registers_[index] = rank;
+}
+
+double HyperLogLog::estimate() const {
+  double m = static_cast<double>(kRegisters);
+  double sum {0};
+  size_t zeros {0};
+  for (uint8_t r : registers_) {
+    sum += std::ldexp(1.0, -r);
+    if (r == 0) ++zeros;
+  }
+  double alpha = 0.7213 / (1 + 1.079 / m);
+  double estimate = alpha * m * m / sum;
+  if (estimate <= 2.5 * m && zeros > 0) {
+    estimate = m * std::log(m / static_cast<double>(zeros));
+  }
+  return estimate;
+}
+
+void HyperLogLog::merge(const HyperLogLog& other) {
+  for (size_t i = 0; i < kRegisters; ++i) {
+    registers_[i] = std::max(registers_[i], other.registers_[i]);
+  }
+}
+
+std::string HyperLogLog::hex() const {
+  static const char digits[] = "0123456789abcdef";
+  std::string text(kRegisters * 2, '0');
+  for (size_t i = 0; i < kRegisters; ++i) {
+    text[i * 2] = digits[registers_[i] >> 4];
+    text[i * 2 + 1] = digits[registers_[i] & 0x0F];
+  }
+  return text;
+}
+
+void HyperLogLog::set_hex(const std::string& text) {
+  if (text.length() != kRegisters * 2) {
+    throw std::invalid_argument("wrong number of sketch registers");
+  }
+  for (size_t i = 0; i < kRegisters; ++i) {
+    size_t used {0};
+    int value = std::stoi(text.substr(i * 2, 2), &used, 16);
+    if (used != 2) throw std::invalid_argument("bad sketch register");
+    registers_[i] = static_cast<uint8_t>(value);
+  }
+}
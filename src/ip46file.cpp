@@ -27,11 +27,27 @@
  * SOFTWARE.
  */
 
+#include <arpa/inet.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+#include <algorithm>
 #include <cctype>
+#include <cstdlib>
+#include <cstring>
 #include <fstream>  // NOLINT
+#include <iterator>
 #include <set>
+#include <stdexcept>
 #include <string>
+#include <thread>  // NOLINT
+#include <utility>
+#include <vector>
 #include "ipforensics/ip46file.h"
+#include "ipforensics/threads.h"
 
 IP46File::IP46File(IPForensics* ip) {
   ip_ = ip;
@@ -41,6 +57,55 @@ IPForensics* IP46File::ip() const {
   return ip_;
 }
 
+const std::vector<std::string>& IP46File::errors() const {
+  return errors_;
+}
+
+size_t IP46File::error_count() const {
+  return error_count_;
+}
+
+size_t IP46File::threads() const {
+  return threads_;
+}
+
+void IP46File::set_threads(size_t threads) {
+  threads_ = threads;
+}
+
+namespace {
+
+/**
+ *  @brief Finds the layout of a report from its first header line
+ *  @param header1 first line of the file
+ *  @param header2 receives the second header line of the layout
+ *  @param footer receives the footer of the layout
+ *  @retval bool true if header1 is the first header line of a known layout
+ */
+bool layout(const std::string& header1, const std::string** header2,
+            const std::string** footer) {
+  if (header1 == ipf::kHeader1) {
+    *header2 = &ipf::kHeader2;
+    *footer = &ipf::kFooter1;
+  } else if (header1 == ipf::kVendorHeader1) {
+    *header2 = &ipf::kVendorHeader2;
+    *footer = &ipf::kVendorFooter1;
+  } else if (header1 == ipf::kLegacyHeader1) {
+    *header2 = &ipf::kLegacyHeader2;
+    *footer = &ipf::kLegacyFooter1;
+  } else {
+    return false;
+  }
+  return true;
+}
+
+}  // namespace
+
+/**
+ *  @details Only the two header lines are checked.  The rows are checked as
+ *           they are loaded, so a bad row is reported and skipped instead of
+ *           making the whole file invalid.
+ */
 bool IP46File::valid() const {
   if (ip_ == nullptr) return false;
   if (ip_->out_file().empty()) return false;
@@ -48,60 +113,474 @@ bool IP46File::valid() const {
   if (fs.is_open() == false) return false;
   std::string line;
   std::getline(fs, line);
-  if (line != ipf::kHeader1) return false;
+  const std::string *header2, *footer;
+  if (!layout(line, &header2, &footer)) return false;
   std::getline(fs, line);
-  if (line != ipf::kHeader2) return false;
-  bool end = false;
-  while (std::getline(fs, line)) {
-    if (line == ipf::kFooter1) {
-      end = true;
-      break;
+  return line == *header2;
+}
+
+namespace {
+
+/**
+ *  @brief Reads a run of decimal digits
+ *  @param text first digit
+ *  @param length number of digits
+ *  @retval int value of the digits, -1 if any is not a digit
+ */
+int digits(const char* text, size_t length) {
+  int value = 0;
+  for (size_t i = 0; i < length; ++i) {
+    if (!isdigit(static_cast<unsigned char>(text[i]))) return -1;
+    value = value * 10 + (text[i] - '0');
+  }
+  return value;
+}
+
+/**
+ *  @brief Converts a report time column back to microseconds since the epoch
+ *  @param text ISO 8601 UTC time as written by operator<<(std::ostream&, 
+ *         const Activity&), without padding
+ *  @param length length of the text
+ *  @param time receives microseconds since the epoch
+ *  @retval bool true if the text is a time in that form
+ */
+bool parse_time(const char* text, size_t length, int64_t* time) {
+  static const char kForm[] {"dddd-dd-ddTdd:dd:ddZ"};
+  if (length != sizeof(kForm) - 1) return false;
+  for (size_t i = 0; i < length; ++i) {
+    if (kForm[i] == 'd' ? !isdigit(static_cast<unsigned char>(text[i]))
+                        : text[i] != kForm[i]) {
+      return false;
     }
-    for (int i = 0; i < ipf::kLengthMAC; ++i) {
-      size_t offset = static_cast<size_t>(i * 3);
-      if (!isxdigit(line[offset++])) return false;
-      if (!isxdigit(line[offset++])) return false;
-      if ((i < ipf::kLengthMAC - 1) && (line[offset] != ':')) return false;
+  }
+  struct tm utc {};
+  utc.tm_year = digits(text, 4) - 1900;
+  utc.tm_mon = digits(text + 5, 2) - 1;
+  utc.tm_mday = digits(text + 8, 2);
+  utc.tm_hour = digits(text + 11, 2);
+  utc.tm_min = digits(text + 14, 2);
+  utc.tm_sec = digits(text + 17, 2);
+  *time = static_cast<int64_t>(timegm(&utc)) * 1000000;
+  return true;
+}
+
+/**
+ *  @brief Finds a fixed-width column of a row without its padding
+ *  @param row start of the row
+ *  @param length length of the row
+ *  @param offset position of the column
+ *  @param width width of the column
+ *  @retval std::pair<const char*, size_t> start and length of the column
+ *          text, length 0 if blank or past the end of the row
+ */
+std::pair<const char*, size_t> column(const char* row, size_t length,
+                                      size_t offset, size_t width) {
+  if (offset >= length) return {row, 0};
+  const char* text = row + offset;
+  size_t n = std::min(width, length - offset);
+  while (n > 0 && text[n - 1] == ' ') --n;
+  return {text, n};
+}
+
+/**
+ *  @brief Reads a hexadecimal digit
+ *  @param c character to read
+ *  @retval int value of the digit, -1 if c is not one
+ */
+int hex(char c) {
+  if (c >= '0' && c <= '9') return c - '0';
+  if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+  if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+  return -1;
+}
+
+/**
+ *  @brief Reads a MAC address in the xx:xx:xx:xx:xx:xx form
+ *  @param text column text
+ *  @param length length of the text
+ *  @param octets receives ipf::kLengthMAC octets
+ *  @retval bool true if the text is a MAC address in that form
+ */
+bool parse_mac(const char* text, size_t length, uint8_t* octets) {
+  if (length != ipf::kOutputLengthMAC) return false;
+  for (size_t i = 0; i < ipf::kLengthMAC; ++i) {
+    const char* octet = text + i * 3;
+    int high = hex(octet[0]), low = hex(octet[1]);
+    if (high < 0 || low < 0 || (i < ipf::kLengthMAC - 1 && octet[2] != ':')) {
+      return false;
     }
+    octets[i] = static_cast<uint8_t>(high << 4 | low);
   }
-  fs.close();
-  return end;
+  return true;
 }
 
-void IP46File::load() {
-  std::ifstream fs(ip_->out_file());
-  if (fs.is_open()) {
-    std::string line, mac_str, v4_str, v6_str;
-    std::getline(fs, line);
-    std::getline(fs, line);
-    while (std::getline(fs, line)) {
-      if (line == ipf::kFooter1) {
-        break;
-      }
-      Host host;
-      MACAddress mac;
-      mac_str = line.substr(ipf::kOutputOffsetMAC, ipf::kOutputLengthMAC);
-      if (mac_str.find_first_not_of(' ') != std::string::npos) {
-        mac = MACAddress(mac_str);
-        host = Host(mac);
-      }
-      IPv4Address v4;
-      v4_str = line.substr(ipf::kOutputOffsetIPv4, ipf::kOutputLengthIPv4);
-      if (v4_str.find_first_not_of(' ') != std::string::npos) {
-        v4 = IPv4Address(v4_str);
-        host.set_ipv4(v4);
+/**
+ *  @brief Reads an IPv4 or IPv6 address
+ *  @param family AF_INET or AF_INET6
+ *  @param text column text
+ *  @param length length of the text
+ *  @param octets receives ipf::kLengthIPv4 or ipf::kLengthIPv6 octets
+ *  @retval bool true if the text is an address of the family
+ */
+bool parse_address(int family, const char* text, size_t length,
+                   uint8_t* octets) {
+  char address[INET6_ADDRSTRLEN];
+  if (length >= sizeof(address)) return false;
+  std::memcpy(address, text, length);
+  address[length] = '\0';
+  return inet_pton(family, address, octets) == 1;
+}
+
+/**
+ *  @brief Reads a right-aligned counter column
+ *  @param text column text
+ *  @param length length of the text
+ *  @param value receives the counter, 0 if blank
+ *  @retval bool true if the column is blank or a decimal number
+ */
+bool parse_count(const char* text, size_t length, uint64_t* value) {
+  *value = 0;
+  size_t i = 0;
+  while (i < length && text[i] == ' ') ++i;
+  for (; i < length; ++i) {
+    if (!isdigit(static_cast<unsigned char>(text[i]))) return false;
+    *value = *value * 10 + static_cast<uint64_t>(text[i] - '0');
+  }
+  return true;
+}
+
+/**
+ *  @brief Reads one row of a report, checking every column
+ *  @param row start of the row
+ *  @param length length of the row, without the line break
+ *  @param host receives the MAC, IPv4 and IPv6 addresses of the row
+ *  @param activity receives the counters and times of the row
+ *  @retval const char* description of the first bad column, nullptr if the
+ *          row is good
+ */
+const char* parse_row(const char* row, size_t length, Host* host,
+                      Activity* activity) {
+  std::pair<const char*, size_t> mac, v4, v6;
+  mac = column(row, length, ipf::kOutputOffsetMAC, ipf::kOutputLengthMAC);
+  v4 = column(row, length, ipf::kOutputOffsetIPv4, ipf::kOutputLengthIPv4);
+  v6 = column(row, length, ipf::kOutputOffsetIPv6, ipf::kOutputLengthIPv6);
+  if (mac.second == 0 && v4.second == 0 && v6.second == 0) {
+    return "row has no addresses";
+  }
+  uint8_t octets[ipf::kLengthIPv6];
+  MACAddress mac_address;
+  IPv4Address ipv4;
+  IPv6Address ipv6;
+  if (mac.second > 0) {
+    if (!parse_mac(mac.first, mac.second, octets)) {
+      return "malformed MAC address";
+    }
+    mac_address = MACAddress(std::vector<uint8_t>(octets,
+                                                  octets + ipf::kLengthMAC));
+  }
+  if (v4.second > 0) {
+    if (!parse_address(AF_INET, v4.first, v4.second, octets)) {
+      return "malformed IPv4 address";
+    }
+    ipv4 = IPv4Address(std::vector<uint8_t>(octets, octets + ipf::kLengthIPv4));
+  }
+  if (v6.second > 0) {
+    if (!parse_address(AF_INET6, v6.first, v6.second, octets)) {
+      return "malformed IPv6 address";
+    }
+    ipv6 = IPv6Address(std::vector<uint8_t>(octets, octets + ipf::kLengthIPv6));
+  }
+  *host = Host(mac_address, ipv4, ipv6);
+  *activity = Activity();
+  if (length > ipf::kOutputOffsetBytes) {
+    std::pair<const char*, size_t> packets, bytes, first, last;
+    packets = column(row, length, ipf::kOutputOffsetPackets,
+                     ipf::kOutputLengthPackets);
+    bytes = column(row, length, ipf::kOutputOffsetBytes,
+                   ipf::kOutputLengthBytes);
+    first = column(row, length, ipf::kOutputOffsetFirstSeen,
+                   ipf::kOutputLengthTime);
+    last = column(row, length, ipf::kOutputOffsetLastSeen,
+                  ipf::kOutputLengthTime);
+    if (!parse_count(packets.first, packets.second, &activity->packets)) {
+      return "malformed packet count";
+    }
+    if (!parse_count(bytes.first, bytes.second, &activity->bytes)) {
+      return "malformed byte count";
+    }
+    if (first.second > 0 &&
+        !parse_time(first.first, first.second, &activity->first_seen)) {
+      return "malformed first-seen time";
+    }
+    if (last.second > 0 &&
+        !parse_time(last.first, last.second, &activity->last_seen)) {
+      return "malformed last-seen time";
+    }
+  }
+  return nullptr;
+}
+
+/**
+ *  @brief Rows of a report parsed by one thread
+ */
+struct Chunk {
+  /** first row of the chunk, never an address continuation row */
+  const char* begin;
+
+  /** end of the chunk */
+  const char* end;
+
+  /** Hosts read, with their continuation rows attached */
+  IP46File::HostList hosts;
+
+  /** line within the chunk, counted from 0, and description of bad rows */
+  std::vector<std::pair<size_t, const char*>> errors;
+
+  /** number of lines read */
+  size_t lines {};
+
+  /** true if the chunk ended at the footer */
+  bool footer {};
+};
+
+/**
+ *  @brief Parses the rows of one chunk, stopping at the footer
+ *  @param chunk rows to parse and their results
+ *  @param footer footer line of the report layout
+ *  @param ip IPForensics supplying the per-host address caps
+ *  @details A bad host row is skipped along with its continuation rows.
+ */
+void parse_chunk(Chunk* chunk, const std::string& footer, IPForensics* ip) {
+  Host host;
+  Activity activity;
+  bool open = false, skip = false;
+  for (const char* row = chunk->begin; row < chunk->end; ) {
+    const char* eol = static_cast<const char*>(
+        std::memchr(row, '\n', static_cast<size_t>(chunk->end - row)));
+    if (eol == nullptr) eol = chunk->end;
+    size_t length = static_cast<size_t>(eol - row);
+    size_t line = chunk->lines++;
+    if (length == footer.length() &&
+        std::memcmp(row, footer.data(), length) == 0) {
+      chunk->footer = true;
+      break;
+    }
+    Host parsed;
+    Activity parsed_activity;
+    const char* error = parse_row(row, length, &parsed, &parsed_activity);
+    bool continuation = column(row, length, ipf::kOutputOffsetMAC,
+                               ipf::kOutputLengthMAC).second == 0;
+    row = eol + 1;
+    if (continuation) {
+      if (error == nullptr && open) {
+        IP46File::attach(parsed, &host, ip);
+      } else if (error == nullptr && !skip) {
+        error = "address row without a host";
       }
-      IPv6Address v6;
-      v6_str = line.substr(ipf::kOutputOffsetIPv6, ipf::kOutputLengthIPv6);
-      if (v6_str.find_first_not_of(' ') != std::string::npos) {
-        v6 = IPv6Address(v6_str);
-        host.set_ipv6(v6);
+    } else {
+      if (open) chunk->hosts.emplace_back(host, activity);
+      open = (error == nullptr);
+      skip = !open;
+      if (open) {
+        host = parsed;
+        activity = parsed_activity;
       }
-      ip_->add_host(host);
-      if (ip_->verbose()) {
-        std::cout << "Loaded host " << host << std::endl;
+    }
+    if (error != nullptr) chunk->errors.emplace_back(line, error);
+  }
+  if (open) chunk->hosts.emplace_back(host, activity);
+}
+
+/**
+ *  @brief Finds the start of the first host row at or after a position
+ *  @param position somewhere in the rows of a report
+ *  @param end end of the report
+ *  @retval const char* start of the next line that is not an address 
+ *          continuation row, or end
+ */
+const char* next_host_row(const char* position, const char* end) {
+  const char* row = static_cast<const char*>(
+      std::memchr(position, '\n', static_cast<size_t>(end - position)));
+  while (row != nullptr && ++row < end && (*row == ' ' || *row == '\n')) {
+    row = static_cast<const char*>(
+        std::memchr(row, '\n', static_cast<size_t>(end - row)));
+  }
+  return row == nullptr ? end : row;
+}
+
+}  // namespace
+
+/**
+ *  @details Each column is optional except the MAC address; blank columns 
+ *           leave the corresponding Host property empty.  Rows written before
+ *           activity was recorded leave the Activity empty.
+ */
+Host IP46File::parse(const std::string& line, Activity* activity) {
+  Host host;
+  std::string mac_str, v4_str, v6_str;
+  mac_str = line.substr(ipf::kOutputOffsetMAC, ipf::kOutputLengthMAC);
+  if (mac_str.find_first_not_of(' ') != std::string::npos) {
+    host = Host(MACAddress(mac_str));
+  }
+  if (line.length() > ipf::kOutputOffsetIPv4) {
+    v4_str = line.substr(ipf::kOutputOffsetIPv4, ipf::kOutputLengthIPv4);
+    if (v4_str.find_first_not_of(' ') != std::string::npos) {
+      host.set_ipv4(IPv4Address(v4_str));
+    }
+  }
+  if (line.length() > ipf::kOutputOffsetIPv6) {
+    v6_str = line.substr(ipf::kOutputOffsetIPv6, ipf::kOutputLengthIPv6);
+    if (v6_str.find_first_not_of(' ') != std::string::npos) {
+      host.set_ipv6(IPv6Address(v6_str));
+    }
+  }
+  if (activity != nullptr && line.length() > ipf::kOutputOffsetBytes) {
+    *activity = Activity();
+    activity->packets = std::strtoull(line.substr(ipf::kOutputOffsetPackets,
+        ipf::kOutputLengthPackets).c_str(), nullptr, 10);
+    activity->bytes = std::strtoull(line.substr(ipf::kOutputOffsetBytes,
+        ipf::kOutputLengthBytes).c_str(), nullptr, 10);
+    std::pair<const char*, size_t> first, last;
+    first = column(line.data(), line.length(), ipf::kOutputOffsetFirstSeen,
+                   ipf::kOutputLengthTime);
+    last = column(line.data(), line.length(), ipf::kOutputOffsetLastSeen,
+                  ipf::kOutputLengthTime);
+    parse_time(first.first, first.second, &activity->first_seen);
+    parse_time(last.first, last.second, &activity->last_seen);
+  }
+  return host;
+}
+
+const char* IP46File::read_row(const std::string& line, Host* host,
+                               Activity* activity) {
+  return parse_row(line.data(), line.length(), host, activity);
+}
+
+void IP46File::attach(const Host& row, Host* host, IPForensics* ip) {
+  host->add_ipv4(row.ipv4(), ip->max_ipv4());
+  host->add_ipv6(row.ipv6(), ip->max_ipv6());
+}
+
+void IP46File::add(const Host& host, const Activity& activity,
+                   IPForensics* ip) {
+  if (host.mac().empty()) return;
+  ip->add_host(host, activity);
+  if (ip->verbose()) {
+    std::cout << "Loaded host " << host << std::endl;
+  }
+}
+
+/**
+ *  @details The file is mapped once and read in a single pass.  Large files
+ *           are split at host rows into one chunk per thread, and the chunks
+ *           are joined in file order, stopping at the chunk that holds the 
+ *           footer.  Bad rows are skipped and recorded with their line 
+ *           numbers.
+ */
+bool IP46File::read(const std::string& filename, HostList* hosts) {
+  errors_.clear();
+  error_count_ = 0;
+  int fd = open(filename.c_str(), O_RDONLY);
+  if (fd < 0) {
+    if (errno == ENOENT) return false;
+    throw std::runtime_error("Could not open " + filename);
+  }
+  struct stat st;
+  if (fstat(fd, &st) != 0 || st.st_size == 0) {
+    close(fd);
+    return false;
+  }
+  size_t size = static_cast<size_t>(st.st_size);
+  void* map = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (map == MAP_FAILED) throw std::runtime_error("Could not map " + filename);
+  madvise(map, size, MADV_SEQUENTIAL);
+  const char* data = static_cast<const char*>(map);
+  const char* end = data + size;
+  // the two header lines pick the layout
+  const char* eol1 = static_cast<const char*>(std::memchr(data, '\n', size));
+  const char* eol2 = eol1 == nullptr ? nullptr : static_cast<const char*>(
+      std::memchr(eol1 + 1, '\n', static_cast<size_t>(end - eol1 - 1)));
+  const std::string *header2, *footer;
+  if (eol2 == nullptr ||
+      !layout(std::string(data, eol1), &header2, &footer) ||
+      std::string(eol1 + 1, eol2) != *header2) {
+    munmap(map, size);
+    return false;
+  }
+  const char* body = eol2 + 1;
+  size_t threads = threads_ > 0 ? threads_ :
+                   std::thread::hardware_concurrency();
+  threads = std::min<size_t>(threads, static_cast<size_t>(end - body) /
+                                      ipf::kLoadChunkBytes);
+  threads = std::max<size_t>(threads, 1);
+  std::vector<Chunk> chunks(threads);
+  const char* begin = body;
+  for (size_t i = 0; i < threads; ++i) {
+    chunks[i].begin = begin;
+    if (i + 1 < threads) {
+      begin = next_host_row(std::max(begin, body + static_cast<size_t>(
+          end - body) / threads * (i + 1)), end);
+    } else {
+      begin = end;
+    }
+    chunks[i].end = begin;
+  }
+  try {
+    run_threads(threads, [&](size_t i) {
+      parse_chunk(&chunks[i], *footer, ip_);
+    });
+  } catch (...) {
+    munmap(map, size);
+    throw;
+  }
+  munmap(map, size);
+  // lines are numbered from 1, and the rows start on line 3
+  size_t line = 3, total = 0;
+  bool footer_found = false;
+  for (const Chunk& c : chunks) {
+    total += c.hosts.size();
+    for (const std::pair<size_t, const char*>& e : c.errors) {
+      if (errors_.size() < ipf::kMaxRowErrors) {
+        errors_.push_back(filename + ':' + std::to_string(line + e.first) +
+                          ": " + e.second);
       }
+      ++error_count_;
+    }
+    line += c.lines;
+    if (c.footer) {
+      footer_found = true;
+      break;
     }
-    fs.close();
   }
+  if (!footer_found) {
+    errors_.push_back(filename + ": no footer, the file may be truncated");
+    ++error_count_;
+  }
+  hosts->reserve(hosts->size() + total);
+  for (Chunk& c : chunks) {
+    std::move(c.hosts.begin(), c.hosts.end(), std::back_inserter(*hosts));
+    if (c.footer) break;
+  }
+  return true;
+}
+
+/**
+ *  @details Reports are written in MAC order, so the sorted rows are 
+ *           appended to the host table without searching it.
+ */
+bool IP46File::load() {
+  HostList hosts;
+  if (!read(ip_->out_file(), &hosts)) return false;
+  auto by_mac = [](const std::pair<Host, Activity>& a,
+                   const std::pair<Host, Activity>& b) {
+    return a.first < b.first;
+  };
+  if (!std::is_sorted(hosts.begin(), hosts.end(), by_mac)) {
+    std::stable_sort(hosts.begin(), hosts.end(), by_mac);
+  }
+  for (const std::pair<Host, Activity>& h : hosts) {
+    add(h.first, h.second, ip_);
+  }
+  return true;
 }
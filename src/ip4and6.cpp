@@ -27,13 +27,96 @@
  * SOFTWARE.
  */
 
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <algorithm>
+#include <chrono>  // NOLINT
+#include <csignal>
 #include <iomanip>
 #include <fstream> // NOLINT
+#include <map>
+#include <memory>
 #include <sstream>
 #include <string>
+#include <thread>  // NOLINT
 #include <vector>
 #include <set>
 #include "ipforensics/ip4and6.h"
+#include "ipforensics/checkpoint.h"
+#include "ipforensics/oui.h"
+#include "ipforensics/pcapfile.h"
+#include "ipforensics/publisher.h"
+#include "ipforensics/radixsort.h"
+#include "ipforensics/snapshot.h"
+
+namespace {
+
+/** Empty addresses standing in for dropped ones without a copy */
+const IPv4Address kNoIPv4;
+const IPv6Address kNoIPv6;
+
+/** Set by the signal handler to end IPForensics::load_sequence */
+volatile sig_atomic_t stop_requested {0};
+
+void request_stop(int) {
+  stop_requested = 1;
+}
+
+/**
+ *  @brief Sorts hosts by one of their primary addresses
+ *  @param hosts hosts in MAC order
+ *  @param ipv6 sort by IPv6 rather than IPv4 address
+ *  @param threads number of threads to sort with
+ *  @retval std::vector<const Host*> hosts by address, those without one last,
+ *          ties in MAC order
+ */
+template <size_t N>
+std::vector<const Host*> by_address(const std::set<Host>& hosts, bool ipv6,
+                                    size_t threads) {
+  std::vector<Keyed<N, const Host*>> items(hosts.size());
+  size_t i = 0;
+  for (const Host& h : hosts) {
+    const std::vector<uint8_t>& address = ipv6 ? h.ipv6().address() :
+                                                 h.ipv4().address();
+    Keyed<N, const Host*>& item = items[i++];
+    item.key.fill(0);
+    item.key[0] = address.empty() ? 1 : 0;
+    std::copy_n(address.begin(), std::min(address.size(), N - 1),
+                item.key.begin() + 1);
+    item.value = &h;
+  }
+  radix_sort(&items, threads);
+  std::vector<const Host*> sorted;
+  sorted.reserve(items.size());
+  for (const Keyed<N, const Host*>& item : items) {
+    sorted.push_back(item.value);
+  }
+  return sorted;
+}
+
+/**
+ *  @brief Determines whether an IPv6 address replaces a link-local primary
+ *         address
+ *  @param primary current primary IPv6 address of a Host, may be empty
+ *  @param ipv6 IPv6 address seen with the Host, may be empty
+ *  @retval bool true if primary is link-local and ipv6 is not
+ */
+bool replaces_link_local(const IPv6Address& primary, const IPv6Address& ipv6) {
+  return !primary.address().empty() && !ipv6.address().empty() &&
+         primary.address()[0] == ipf::kLinkLocalIPv6[0] &&
+         primary.address()[1] == ipf::kLinkLocalIPv6[1] &&
+         ipv6.address()[0] != ipf::kLinkLocalIPv6[0] &&
+         ipv6.address()[1] != ipf::kLinkLocalIPv6[1];
+}
+
+}  // namespace
+
+IPForensics::IPForensics() {
+  max_ipv4_ = ipf::kMaxAddressesIPv4;
+  max_ipv6_ = ipf::kMaxAddressesIPv6;
+}
 
 bool IPForensics::verbose() const {
   return verbose_;
@@ -43,7 +126,7 @@ std::vector<Device> IPForensics::devices() const {
   return devices_;
 }
 
-std::set<Host> IPForensics::hosts() const {
+const std::set<Host>& IPForensics::hosts() const {
   return hosts_;
 }
 
@@ -63,10 +146,120 @@ std::string IPForensics::exclude_file() const {
   return exclude_file_;
 }
 
+std::string IPForensics::snapshot_file() const {
+  return snapshot_file_;
+}
+
+std::string IPForensics::checkpoint_file() const {
+  return checkpoint_file_;
+}
+
+bool IPForensics::resume() const {
+  return resume_;
+}
+
+bool IPForensics::follow() const {
+  return follow_;
+}
+
+int IPForensics::daemon() const {
+  return daemon_;
+}
+
+bool IPForensics::uring() const {
+  return uring_;
+}
+
+bool IPForensics::stats() const {
+  return stats_;
+}
+
+bool IPForensics::skip_payload() const {
+  return skip_payload_;
+}
+
 int IPForensics::packet_count() const {
   return packet_count_;
 }
 
+/**
+ *  @details Hosts that are not stored in IPForensics::hosts_ share a single
+ *           empty Activity.
+ */
+const Activity& IPForensics::activity(const Host& host) const {
+  static const Activity none {};
+  if (host.slot() >= activity_.size()) return none;
+  return activity_[host.slot()];
+}
+
+int IPForensics::idle_timeout() const {
+  return idle_timeout_;
+}
+
+std::string IPForensics::evict_file() const {
+  return evict_file_;
+}
+
+uint64_t IPForensics::evicted() const {
+  return evicted_;
+}
+
+bool IPForensics::vendors() const {
+  return vendors_;
+}
+
+ReportWriter::Format IPForensics::format() const {
+  return format_;
+}
+
+bool IPForensics::summary_only() const {
+  return summary_only_;
+}
+
+ReportWriter::Order IPForensics::order() const {
+  return order_;
+}
+
+const HostCensus& IPForensics::census() const {
+  return census_;
+}
+
+const TopTalkers& IPForensics::top() const {
+  return top_;
+}
+
+const Sketch& IPForensics::sketch() const {
+  return sketch_;
+}
+
+bool IPForensics::sketching() const {
+  return sketching_;
+}
+
+bool IPForensics::sketch_only() const {
+  return sketch_only_;
+}
+
+std::string IPForensics::sketch_file() const {
+  return sketch_file_;
+}
+
+size_t IPForensics::max_ipv4() const {
+  return max_ipv4_;
+}
+
+size_t IPForensics::max_ipv6() const {
+  return max_ipv6_;
+}
+
+const IPIndex& IPForensics::index() const {
+  return index_;
+}
+
+const Sampler& IPForensics::sampler() const {
+  return sampler_;
+}
+
 std::vector<Packet> IPForensics::packets() {
   return packets_;
 }
@@ -91,10 +284,102 @@ void IPForensics::set_exclude_file(std::string exclude_file) {
   exclude_file_ = exclude_file;
 }
 
+void IPForensics::set_snapshot_file(std::string snapshot_file) {
+  snapshot_file_ = snapshot_file;
+  journal_.set_filename(snapshot_file + ipf::kDeltaLogSuffix);
+}
+
+void IPForensics::set_checkpoint_file(std::string checkpoint_file) {
+  checkpoint_file_ = checkpoint_file;
+}
+
+void IPForensics::set_resume(bool resume) {
+  resume_ = resume;
+}
+
+void IPForensics::set_follow(bool follow) {
+  follow_ = follow;
+}
+
+void IPForensics::set_daemon(int daemon) {
+  daemon_ = daemon;
+}
+
+void IPForensics::set_uring(bool uring) {
+  uring_ = uring;
+}
+
+void IPForensics::set_stats(bool stats) {
+  stats_ = stats;
+}
+
+void IPForensics::set_skip_payload(bool skip_payload) {
+  skip_payload_ = skip_payload;
+}
+
 void IPForensics::set_packet_count(int packet_count) {
   packet_count_ = packet_count;
 }
 
+void IPForensics::set_sampler(Sampler::Method method, uint32_t rate) {
+  sampler_.set_method(method);
+  sampler_.set_rate(rate);
+}
+
+void IPForensics::set_idle_timeout(int seconds) {
+  idle_timeout_ = seconds;
+}
+
+void IPForensics::set_evict_file(std::string evict_file) {
+  evict_file_ = evict_file;
+}
+
+void IPForensics::set_vendors(bool vendors) {
+  vendors_ = vendors;
+}
+
+void IPForensics::set_format(ReportWriter::Format format) {
+  format_ = format;
+}
+
+void IPForensics::set_summary_only(bool summary_only) {
+  summary_only_ = summary_only;
+}
+
+void IPForensics::set_order(ReportWriter::Order order) {
+  order_ = order;
+}
+
+void IPForensics::set_census_interval(int seconds) {
+  census_.set_interval(seconds);
+}
+
+void IPForensics::set_top(size_t k) {
+  top_.set_k(k);
+}
+
+void IPForensics::set_sketching(bool sketching) {
+  sketching_ = sketching;
+}
+
+void IPForensics::set_sketch_only(bool sketch_only) {
+  sketch_only_ = sketch_only;
+  if (sketch_only) sketching_ = true;
+}
+
+void IPForensics::set_sketch_file(std::string sketch_file) {
+  sketch_file_ = sketch_file;
+  if (!sketch_file.empty()) sketching_ = true;
+}
+
+void IPForensics::set_max_ipv4(size_t max) {
+  max_ipv4_ = max;
+}
+
+void IPForensics::set_max_ipv6(size_t max) {
+  max_ipv6_ = max;
+}
+
 /**
  *  @details Loads all available network devices from the host system, setting
  *           each device's name, description, loopback status, network address
@@ -117,6 +402,21 @@ void IPForensics::load_devices() {
         d.set_net(IPv4Address(net));
         d.set_mask(IPv4Address(mask));
       }
+      for (pcap_addr_t* a = devp->addresses; a != NULL; a = a->next) {
+        if (a->addr == NULL || a->netmask == NULL) continue;
+        if (a->addr->sa_family != AF_INET6) continue;
+        const uint8_t* addr = reinterpret_cast<sockaddr_in6*>(a->addr)
+            ->sin6_addr.s6_addr;
+        const uint8_t* netmask = reinterpret_cast<sockaddr_in6*>(a->netmask)
+            ->sin6_addr.s6_addr;
+        std::vector<uint8_t> network(ipf::kLengthIPv6);
+        int length {0};
+        for (size_t i = 0; i < ipf::kLengthIPv6; ++i) {
+          network[i] = addr[i] & netmask[i];
+          length += __builtin_popcount(netmask[i]);
+        }
+        d.add_ipv6_prefix(IPv6Address(network), length);
+      }
       devices_.push_back(d);
       devp = devp->next;
     }
@@ -136,29 +436,15 @@ void IPForensics::load_devices() {
  */
 void IPForensics::load_hosts(Device device) {
   for (Packet packet : device.packets()) {
-    // add the source host
-    auto it = hosts_.find(static_cast<Host>(packet.mac_src()));
-    if (it == hosts_.end()) {
-      add_host(packet.mac_src(), packet.ipv4_src(), packet.ipv6_src());
-    } else {
-      update_host(it, packet.ipv4_src(), packet.ipv6_src());
-    }
-    // add the destination host
-    it = hosts_.find(static_cast<Host>(packet.mac_dst()));
-    if (it == hosts_.end()) {
-      add_host(packet.mac_dst(), packet.ipv4_dst(), packet.ipv6_dst());
-    } else {
-      update_host(it, packet.ipv4_dst(), packet.ipv6_dst());
-    }
+    process_packet(packet);
   }
   // remove multicast and broadcast hosts
-  IPv4Address net = device.net(), mask = device.mask();
-  clean_hosts(&net, &mask);
+  clean_hosts();
 }
 
 /**
- *  @todo Add command-line parameters for IPv4 network address and mask so we 
- *        can remove broadcast and multicast hosts from the result
+ *  @details Non-local addresses are only filtered out when local networks were
+ *           given with the --local option.
  */
 void IPForensics::load_hosts(std::string filename) {
   // open the filename
@@ -179,15 +465,17 @@ void IPForensics::load_hosts(std::string filename) {
   if (packet_count_ > 0) {
     for (int i = 0; i < packet_count_; ++i) {
       packet = pcap_next(pcap, &header);
-      if (packet != NULL) {
-        packets_.push_back(Packet(packet));
+      if (packet != NULL && sampler_.keep(header, packet)) {
+        packets_.push_back(Packet(header, packet));
       }
     }
   } else {
     // if packet_count_ is not set, read all packets
     packet = pcap_next(pcap, &header);
     while (packet != NULL) {
-      packets_.push_back(Packet(packet));
+      if (sampler_.keep(header, packet)) {
+        packets_.push_back(Packet(header, packet));
+      }
       packet = pcap_next(pcap, &header);
     }
   }
@@ -195,51 +483,405 @@ void IPForensics::load_hosts(std::string filename) {
   pcap_close(pcap);
   // extract hosts from packets
   for (Packet p : packets_) {
-    // add the source host
-    std::set<Host>::iterator it = hosts_.find(static_cast<Host>(p.mac_src()));
-    if (it == hosts_.end()) {
-      add_host(p.mac_src(), p.ipv4_src(), p.ipv6_src());
-    } else {
-      update_host(it, p.ipv4_src(), p.ipv6_src());
+    process_packet(p);
+  }
+  // remove meaningless hosts
+  clean_hosts();
+}
+
+/**
+ *  @details Records are processed as soon as they have been completely written.
+ *           Before draining the current file we check whether the next file in
+ *           the rotation exists; if it does, the writer has finished with the
+ *           current file and we move on once it is drained.  When following,
+ *           the output file is rewritten after every batch of new records so 
+ *           it stays current, unless daemon_ is set, in which case a 
+ *           Publisher writes it in the background on its own schedule.  A 
+ *           checkpoint is saved every 
+ *           ipf::kCheckpointPackets packets, when moving to the next file and
+ *           before returning, so a later run with resume_ set only reads the
+ *           records and files that were added since.
+ *  @throws std::runtime_error if a file is missing or is not a libpcap-format
+ *          Ethernet file, or if a checkpoint cannot be written
+ */
+int IPForensics::load_sequence(std::string filename) {
+  stop_requested = 0;
+  std::signal(SIGINT, request_stop);
+  std::signal(SIGTERM, request_stop);
+  int count {0}, unsaved {0};
+  std::string name = filename;
+  uint64_t offset {0};
+  Checkpoint checkpoint(this);
+  if (resume_) {
+    if (checkpoint.load(&name, &offset)) {
+      if (verbose_) {
+        std::cout << "Resuming \'" << name << "\' at offset " << offset;
+        std::cout << " with " << hosts_.size() << " hosts" << std::endl;
+      }
+    } else if (!checkpoint.error().empty()) {
+      std::cout << ipf::kProgramName << ": not resuming: ";
+      std::cout << checkpoint.error() << std::endl;
     }
-    // add the destination host
-    it = hosts_.find(static_cast<Host>(p.mac_dst()));
-    if (it == hosts_.end()) {
-      add_host(p.mac_dst(), p.ipv4_dst(), p.ipv6_dst());
-    } else {
-      update_host(it, p.ipv4_dst(), p.ipv6_dst());
+  }
+  std::unique_ptr<Publisher> publisher;
+  if (daemon_ > 0) publisher.reset(new Publisher(this, daemon_));
+  time_t second {0};
+  struct pcap_pkthdr header;
+  const uint8_t* data = nullptr;
+  bool done {false};
+  while (!done && !stop_requested) {
+    PcapFile file(name);
+    if (skip_payload_) {
+      struct stat st;
+      bool large = (stat(name.c_str(), &st) == 0 &&
+                    static_cast<uint64_t>(st.st_size) >= ipf::kDirectFileSize);
+      file.set_mode(large ? PcapFile::Mode::kDirect : PcapFile::Mode::kHeaders);
+    } else if (uring_ && !follow_) {
+      file.set_mode(PcapFile::Mode::kRing);
+    }
+    while (!file.open()) {
+      if (!follow_) {
+        throw std::runtime_error(name + ": No such file or directory");
+      }
+      if (stop_requested) break;
+      if (publisher) publisher->poll();
+      file.wait(ipf::kFollowInterval);
+    }
+    if (stop_requested) break;
+    if (file.link_type() != DLT_EN10MB) {
+      throw std::runtime_error("Link-layer type not IEEE 802.3 Ethernet");
+    }
+    file.seek(std::max(offset, file.offset()));
+    if (verbose_) {
+      std::cout << "Reading \'" << name << "\' from offset " << file.offset();
+      std::cout << std::endl;
+    }
+    while (!stop_requested) {
+      std::string next = PcapFile::rotation(name);
+      bool rotated = (access(next.c_str(), F_OK) == 0);
+      int before = count;
+      while (!stop_requested && file.next(&header, &data)) {
+        ++count;
+        if (sampler_.keep(header, data)) {
+          Packet packet(header, data);
+          process_packet(packet);
+          if (verbose_) {
+            std::cout << packet << std::endl;
+          }
+        }
+        if (packet_count_ > 0 && count >= packet_count_) {
+          done = true;
+          stop_requested = 1;
+        }
+        if (!checkpoint_file_.empty() && ++unsaved >= ipf::kCheckpointPackets) {
+          checkpoint.save(name, file.offset());
+          unsaved = 0;
+        }
+        if (publisher && header.ts.tv_sec != second) {
+          second = header.ts.tv_sec;
+          publisher->poll();
+        }
+      }
+      offset = file.offset();
+      if (publisher) {
+        publisher->poll();
+      } else if (follow_ && count != before && !out_file_.empty()) {
+        clean_hosts();
+        results();
+      }
+      if (rotated) {
+        name = next;
+        offset = 0;
+        if (!checkpoint_file_.empty()) checkpoint.save(name, offset);
+        break;
+      }
+      if (!follow_) {
+        done = true;
+        break;
+      }
+      if (!stop_requested) {
+        file.wait(ipf::kFollowInterval);
+      }
     }
   }
-  // remove meaningless hosts
-  clean_hosts(nullptr, nullptr);
+  publisher.reset();
+  std::signal(SIGINT, SIG_DFL);
+  std::signal(SIGTERM, SIG_DFL);
+  if (!checkpoint_file_.empty()) checkpoint.save(name, offset);
+  clean_hosts();
+  return count;
 }
 
 void IPForensics::add_host(const Host host) {
-  hosts_.insert(host);
+  insert_host(host, Activity());
 }
 
 void IPForensics::add_host(MACAddress mac, IPv4Address ipv4, IPv6Address ipv6) {
-  hosts_.insert(Host(mac, ipv4, ipv6));
+  insert_host(Host(mac, ipv4, ipv6), Activity());
 }
 
-void IPForensics::update_host(std::set<Host>::iterator it, IPv4Address ipv4,
-                              IPv6Address ipv6) {
-  Host h = *it;
-  if (h.ipv4().address().empty() && !ipv4.address().empty()) {
-    h.set_ipv4(ipv4);
+void IPForensics::add_host(const Host host, const Activity& activity) {
+  insert_host(host, activity);
+}
+
+void IPForensics::replace_host(const Host& host, const Activity& activity) {
+  drop_host(host.mac());
+  insert_host(host, activity);
+}
+
+void IPForensics::drop_host(const MACAddress& mac) {
+  auto it = hosts_.find(Host(mac));
+  if (it == hosts_.end()) return;
+  index_.release(*it);
+  remove_host(it);
+}
+
+bool IPForensics::changed(const Host& host) const {
+  return host.slot() < changed_.size() && changed_[host.slot()];
+}
+
+const std::vector<uint64_t>& IPForensics::removed() const {
+  return removed_;
+}
+
+/**
+ *  @details Slots released by removed hosts are reused before activity_ grows.
+ *           Snapshots, reports and merges supply hosts in MAC order, so a Host
+ *           that sorts after every existing one is appended without a search.
+ */
+uint32_t IPForensics::insert_host(Host host, const Activity& activity) {
+  bool last = hosts_.empty() || *hosts_.rbegin() < host;
+  if (!last) {
+    auto it = hosts_.find(host);
+    if (it != hosts_.end()) return it->slot();
   }
-  if (h.ipv6().address().empty() && !ipv6.address().empty()) {
-    h.set_ipv6(ipv6);
+  uint32_t slot;
+  if (free_slots_.empty()) {
+    slot = static_cast<uint32_t>(activity_.size());
+    activity_.push_back(activity);
+    changed_.push_back(true);
+  } else {
+    slot = free_slots_.back();
+    free_slots_.pop_back();
+    activity_[slot] = activity;
+    changed_[slot] = true;
   }
-  // replace previous IPv6 address if it is link-local
-  if (!h.ipv6().address().empty() && !ipv6.address().empty()) {
-    if (h.ipv6().address()[0] == ipf::kLinkLocalIPv6[0] &&
-        h.ipv6().address()[1] == ipf::kLinkLocalIPv6[1] &&
-        ipv6.address()[0] != ipf::kLinkLocalIPv6[0] &&
-        ipv6.address()[1] != ipf::kLinkLocalIPv6[1]) {
-      h.set_ipv6(ipv6);
+  host.set_slot(slot);
+  if (last) {
+    hosts_.insert(hosts_.end(), host);
+  } else {
+    hosts_.insert(host);
+  }
+  census_.add(host);
+  return slot;
+}
+
+std::set<Host>::iterator IPForensics::remove_host(
+    std::set<Host>::iterator it) {
+  free_slots_.push_back(it->slot());
+  changed_[it->slot()] = false;
+  if (!snapshot_file_.empty()) removed_.push_back(Host::pack(it->mac()));
+  census_.remove(*it);
+  return hosts_.erase(it);
+}
+
+void IPForensics::process_packet(const Packet& packet) {
+  if (census_.interval() > 0) census_.tick(packet.time());
+  if (idle_timeout_ > 0) expire_hosts(packet.time());
+  // add the source host
+  observe_host(packet.mac_src(), packet.ipv4_src(), packet.ipv6_src(), packet,
+               true);
+  // add the destination host
+  observe_host(packet.mac_dst(), packet.ipv4_dst(), packet.ipv6_dst(), packet,
+               false);
+}
+
+/**
+ *  @details Excluded MAC addresses are skipped before any host-table work.
+ *           Broadcast, multicast, non-local and excluded addresses are dropped
+ *           before they reach the host.  A packet whose addresses were all
+ *           dropped is ignored, whether or not its host is known, so it 
+ *           neither creates a host nor counts in one's activity, and no 
+ *           clean-up pass is needed later.  Fake and excluded addresses are
+ *           counted in census_ as they are dropped.  The same observations 
+ *           feed the top talkers and the estimated inventory, which is all 
+ *           that is kept in sketch-only mode.  Only a sender's addresses, or
+ *           addresses known to be local, are claimed in index_, since a 
+ *           destination behind the gateway shows every remote address with 
+ *           the gateway's MAC.
+ */
+void IPForensics::observe_host(const MACAddress& mac, const IPv4Address& ipv4,
+                               const IPv6Address& ipv6, const Packet& packet,
+                               bool source) {
+  if (mac.fake()) {
+    census_.skip(HostCensus::Skip::kFake, mac);
+    return;
+  }
+  if (!exclude_.empty() && exclude_.excluded(mac)) {
+    census_.skip(HostCensus::Skip::kExcluded, mac);
+    return;
+  }
+  const IPv4Address& v4 = usable(ipv4) ? ipv4 : kNoIPv4;
+  const IPv6Address& v6 = usable(ipv6) ? ipv6 : kNoIPv6;
+  if (v4.empty() && !ipv4.empty()) {
+    if (ipv4.fake()) {
+      census_.skip(HostCensus::Skip::kFake, ipv4);
+    } else if (!exclude_.empty() && exclude_.excluded(ipv4)) {
+      census_.skip(HostCensus::Skip::kExcluded, ipv4);
+    }
+  }
+  if (v6.empty() && !ipv6.empty()) {
+    if (ipv6.fake()) {
+      census_.skip(HostCensus::Skip::kFake, ipv6);
+    } else if (!exclude_.empty() && exclude_.excluded(ipv6)) {
+      census_.skip(HostCensus::Skip::kExcluded, ipv6);
+    }
+  }
+  bool dropped = v4.empty() && v6.empty() && !(ipv4.empty() && ipv6.empty());
+  if (top_.k() > 0 && !dropped) {
+    top_.add(mac, v4, v6, packet.length());
+  }
+  if (sketching_) {
+    if (!dropped) sketch_.add(mac, v4, v6);
+    if (sketch_only_) return;
+  }
+  if (dropped) return;
+  uint32_t slot;
+  auto it = hosts_.find(static_cast<Host>(mac));
+  if (it == hosts_.end()) {
+    slot = insert_host(Host(mac, v4, v6), Activity());
+    if (timers_.started()) arm_timer(slot, mac, packet.time());
+  } else {
+    slot = it->slot();
+    update_host(it, v4, v6);
+  }
+  activity_[slot].update(packet.time(), packet.length());
+  changed_[slot] = true;
+  // detect addresses changing hands as they happen
+  uint32_t conflicts[] {IPIndex::kNoConflict, IPIndex::kNoConflict};
+  if (source || !local_ipv4_.empty()) {
+    conflicts[0] = index_.claim(v4, mac, packet.time());
+  }
+  if (source || !local_ipv6_.empty()) {
+    conflicts[1] = index_.claim(v6, mac, packet.time());
+  }
+  for (uint32_t c : conflicts) {
+    if (c != IPIndex::kNoConflict && verbose_) {
+      std::cout << "Conflict: " << index_.conflicts()[c] << std::endl;
+    }
+  }
+}
+
+void IPForensics::arm_timer(uint32_t slot, const MACAddress& mac,
+                            int64_t seen) {
+  timers_.schedule({slot, Host::pack(mac), seen / 1000000 + idle_timeout_});
+}
+
+/**
+ *  @details Timers are not moved when a host is seen again.  When a timer 
+ *           expires, the host's last-seen time decides whether it is evicted 
+ *           or re-armed, so each packet costs nothing here and each host at
+ *           most one re-arm per timeout period.  Hosts already present when 
+ *           the first packet arrives, such as those loaded from the output 
+ *           file, count as seen at that packet.
+ */
+void IPForensics::expire_hosts(int64_t time) {
+  int64_t now = time / 1000000;
+  if (!timers_.started()) {
+    timers_.start(now);
+    for (const Host& h : hosts_) {
+      arm_timer(h.slot(), h.mac(), std::max(activity(h).last_seen, time));
+    }
+  }
+  if (now <= timers_.now()) return;
+  std::vector<TimerWheel::Timer> expired;
+  timers_.advance(now, &expired);
+  std::vector<std::pair<Host, Activity>> evicted;
+  for (const TimerWheel::Timer& t : expired) {
+    // skip timers of hosts that were removed, or whose slot was reused
+    auto it = hosts_.find(Host(Host::unpack(t.mac)));
+    if (it == hosts_.end() || it->slot() != t.slot) continue;
+    int64_t deadline = activity_[t.slot].last_seen / 1000000 + idle_timeout_;
+    if (deadline > now) {
+      timers_.schedule({t.slot, t.mac, deadline});
+      continue;
     }
+    if (verbose_) {
+      std::cout << "Evicted idle host " << *it << std::endl;
+    }
+    if (!evict_file_.empty()) {
+      evicted.push_back(std::make_pair(*it, activity_[t.slot]));
+    }
+    index_.release(*it);
+    remove_host(it);
+    ++evicted_;
   }
+  if (!evicted.empty()) write_evicted(evicted);
+}
+
+/**
+ *  @details The file gets the report column headers when it is created, and
+ *           rows in the report format after that.
+ */
+void IPForensics::write_evicted(
+    const std::vector<std::pair<Host, Activity>>& hosts) {
+  std::ifstream existing(evict_file_);
+  bool fresh = !existing.good() ||
+               existing.peek() == std::ifstream::traits_type::eof();
+  existing.close();
+  std::ofstream ofs(evict_file_, std::ofstream::out | std::ofstream::app);
+  if (!ofs.is_open()) {
+    throw std::runtime_error("Could not open eviction file " + evict_file_);
+  }
+  if (fresh) {
+    ofs << ipf::kHeader1 << '\n' << ipf::kHeader2 << '\n';
+  }
+  for (const std::pair<Host, Activity>& h : hosts) {
+    ofs << h.first << ' ' << h.second << '\n';
+    for (const Host& alias : h.first.aliases()) {
+      ofs << alias << '\n';
+    }
+  }
+  ofs.close();
+  if (ofs.fail()) {
+    throw std::runtime_error("Could not write to eviction file " +
+                             evict_file_);
+  }
+}
+
+/**
+ *  @details Every new address is recorded up to the per-family caps.  The 
+ *           first address of each family becomes the primary one, except that
+ *           a link-local IPv6 primary address is replaced by the first 
+ *           non-link-local one.
+ */
+bool IPForensics::update_addresses(Host* host, const IPv4Address& ipv4,
+                                   const IPv6Address& ipv6) const {
+  bool changed = host->add_ipv4(ipv4, max_ipv4_);
+  changed |= host->add_ipv6(ipv6, max_ipv6_);
+  // replace previous IPv6 address if it is link-local
+  if (replaces_link_local(host->ipv6(), ipv6)) {
+    host->set_ipv6(ipv6);
+    changed = true;
+  }
+  return changed;
+}
+
+/**
+ *  @details The stored Host is checked in place, and only copied and 
+ *           re-inserted when an address is new, so packets from known 
+ *           addresses cost a few comparisons and no allocation.
+ */
+void IPForensics::update_host(std::set<Host>::iterator it,
+                              const IPv4Address& ipv4,
+                              const IPv6Address& ipv6) {
+  if (!it->adds_ipv4(ipv4, max_ipv4_) && !it->adds_ipv6(ipv6, max_ipv6_) &&
+      !replaces_link_local(it->ipv6(), ipv6)) {
+    return;
+  }
+  Host h = *it;
+  if (!update_addresses(&h, ipv4, ipv6)) return;
+  census_.change(*it, h);
   hosts_.erase(it);
   hosts_.insert(h);
 }
@@ -248,27 +890,166 @@ void IPForensics::update_host(std::set<Host>::iterator it, IPv4Address ipv4,
  *  @details This helper method removes "fake" hosts from IPForensics::hosts_
  *           such as multicast and broadcast addresses.
  */
-void IPForensics::clean_hosts(IPv4Address* net, IPv4Address *mask) {
+void IPForensics::clean_hosts() {
   std::set<Host>::iterator it;
   for (it = hosts_.begin(); it != hosts_.end(); ) {
-    Host host = *it;
-    bool remove {false};
-    if (host.mac().fake() || host.ipv4().fake() || host.ipv6().fake()) {
-      remove = true;
-    }
-    if (!host.ipv4().address().empty() && net != nullptr) {
-      if (!host.ipv4().mask(*net, *mask)) {
-        remove = true;
-      }
-    }
-    if (remove) {
-      hosts_.erase(it++);
+    if (it->mac().fake() || it->ipv4().fake() || it->ipv6().fake()) {
+      if (it->mac().fake()) census_.skip(HostCensus::Skip::kFake, it->mac());
+      if (it->ipv4().fake()) census_.skip(HostCensus::Skip::kFake, it->ipv4());
+      if (it->ipv6().fake()) census_.skip(HostCensus::Skip::kFake, it->ipv6());
+      it = remove_host(it);
     } else {
       ++it;
     }
   }
 }
 
+bool IPForensics::usable(const IPv4Address& ipv4) const {
+  return !ipv4.empty() && !ipv4.fake() && local(ipv4) &&
+         (exclude_.empty() || !exclude_.excluded(ipv4));
+}
+
+bool IPForensics::usable(const IPv6Address& ipv6) const {
+  return !ipv6.empty() && !ipv6.fake() && local(ipv6) &&
+         (exclude_.empty() || !exclude_.excluded(ipv6));
+}
+
+void IPForensics::load_exclude() {
+  auto start = std::chrono::steady_clock::now();
+  exclude_.load(exclude_file_);
+  if (verbose_) {
+    std::chrono::duration<double, std::milli> elapsed =
+        std::chrono::steady_clock::now() - start;
+    std::cout << "Loaded " << exclude_.size() << " exclusion(s) from ";
+    std::cout << exclude_file_ << " in " << std::fixed << std::setprecision(1);
+    std::cout << elapsed.count() << " ms" << std::endl;
+    std::cout.unsetf(std::ios::fixed);
+  }
+}
+
+/**
+ *  @details Hosts loaded from the snapshot and its log count as saved.
+ */
+bool IPForensics::load_snapshot() {
+  Snapshot snapshot(this);
+  if (!snapshot.load(snapshot_file_)) return false;
+  journal_.set_base(snapshot.checksum(), snapshot.records());
+  uint64_t replayed = journal_.replay(this);
+  clear_changes();
+  if (replayed > 0 && verbose_) {
+    std::cout << "Replayed " << replayed << " changes from ";
+    std::cout << journal_.filename() << std::endl;
+  }
+  return true;
+}
+
+/**
+ *  @details The delta log is used once there is a snapshot for it to apply
+ *           to, until DeltaLog::due() says it has grown enough that writing
+ *           every host again is worth it.
+ */
+void IPForensics::save_snapshot() {
+  uint64_t changes = removed_.size() +
+      static_cast<uint64_t>(std::count(changed_.begin(), changed_.end(), true));
+  if (journal_.due(changes)) {
+    Snapshot snapshot(this);
+    snapshot.save(snapshot_file_);
+    journal_.compacted(snapshot.checksum(), snapshot.records());
+    if (verbose_) {
+      std::cout << "Saved " << snapshot.records() << " hosts to ";
+      std::cout << snapshot_file_ << std::endl;
+    }
+  } else {
+    journal_.append(*this);
+    if (verbose_) {
+      std::cout << "Saved " << changes << " changes to ";
+      std::cout << journal_.filename() << std::endl;
+    }
+  }
+  clear_changes();
+}
+
+void IPForensics::clear_changes() {
+  std::fill(changed_.begin(), changed_.end(), false);
+  removed_.clear();
+}
+
+bool IPForensics::load_sketch() {
+  bool loaded = sketch_.load(sketch_file_);
+  if (loaded && verbose_) {
+    std::cout << "Merged sketch from " << sketch_file_ << std::endl;
+  }
+  return loaded;
+}
+
+void IPForensics::add_local(const IPv4Address& net, int length) {
+  std::vector<uint8_t> octets = net.address();
+  PrefixTrie::Key key {};
+  std::copy_n(octets.begin(), std::min(octets.size(), key.size()), key.begin());
+  local_ipv4_.insert(key, std::min(length, 32));
+}
+
+void IPForensics::add_local(const IPv6Address& net, int length) {
+  local_ipv6_.insert(Host::pack(net), length);
+}
+
+/**
+ *  @details A line is taken to be IPv6 if it contains a colon.
+ */
+void IPForensics::load_local(const std::string& filename) {
+  std::ifstream fs(filename);
+  if (!fs.is_open()) {
+    throw std::runtime_error("Could not open local networks file " + filename);
+  }
+  std::string line;
+  for (int number = 1; std::getline(fs, line); ++number) {
+    line = line.substr(0, line.find('#'));
+    size_t start = line.find_first_not_of(" \t\r");
+    if (start == std::string::npos) continue;
+    std::string text = line.substr(start, line.find_last_not_of(" \t\r") -
+                                   start + 1);
+    size_t slash = text.find('/');
+    std::string address = text.substr(0, slash);
+    bool v6 = (address.find(':') != std::string::npos);
+    try {
+      int length = v6 ? 128 : 32;
+      if (slash != std::string::npos) {
+        size_t used {0};
+        length = std::stoi(text.substr(slash + 1), &used);
+        if (used != text.length() - slash - 1 || length < 0 ||
+            length > (v6 ? 128 : 32)) {
+          throw std::invalid_argument("bad prefix length");
+        }
+      }
+      if (v6) {
+        add_local(IPv6Address(address), length);
+      } else {
+        IPv4Address ipv4(address);
+        if (ipv4.address().size() != ipf::kLengthIPv4) {
+          throw std::invalid_argument("bad IPv4 address");
+        }
+        add_local(ipv4, length);
+      }
+    } catch (std::exception const &e) {
+      throw std::runtime_error(filename + ':' + std::to_string(number) +
+                               ": invalid network '" + text + "'");
+    }
+  }
+}
+
+bool IPForensics::local(const IPv4Address& ipv4) const {
+  if (local_ipv4_.empty()) return true;
+  std::vector<uint8_t> octets = ipv4.address();
+  PrefixTrie::Key key {};
+  std::copy_n(octets.begin(), std::min(octets.size(), key.size()), key.begin());
+  return local_ipv4_.contains(key, 32);
+}
+
+bool IPForensics::local(const IPv6Address& ipv6) const {
+  if (local_ipv6_.empty()) return true;
+  return local_ipv6_.contains(Host::pack(ipv6), 128);
+}
+
 /**
  *  @details The list of available packet devices is loaded from the system and
  *           matched against the command-line supplied device name.  Packets are
@@ -308,6 +1089,33 @@ int IPForensics::load_from_device() {
     std::cout << " to capture " << packet_count_ << " packet(s).";
     std::cout << std::endl;
   }
+  // treat the device's networks as local
+  if (!device.net().empty() && !device.mask().empty()) {
+    int length {0};
+    IPv4Address mask = device.mask();
+    for (uint8_t octet : mask.address()) {
+      length += __builtin_popcount(octet);
+    }
+    add_local(device.net(), length);
+  }
+  for (const std::pair<IPv6Address, int>& prefix : device.ipv6_prefixes()) {
+    add_local(prefix.first, prefix.second);
+  }
+  // capture until interrupted, writing the hosts in the background
+  if (daemon_ > 0) {
+    stop_requested = 0;
+    std::signal(SIGINT, request_stop);
+    std::signal(SIGTERM, request_stop);
+    int packet_count {0};
+    {
+      Publisher publisher(this, daemon_);
+      packet_count = device.stream(packet_count_, &publisher, &stop_requested);
+    }
+    std::signal(SIGINT, SIG_DFL);
+    std::signal(SIGTERM, SIG_DFL);
+    clean_hosts();
+    return packet_count;
+  }
   // capture packets
   int packet_count = device.capture(packet_count_);
   // display packets captured
@@ -336,8 +1144,25 @@ int IPForensics::load_from_file() {
     std::cout << " packet(s) from " << '\'' << in_file_ << '\'';
     std::cout << std::endl;
   }
-  // extract packets and hosts from file
-  load_hosts(in_file_);
+  auto start = std::chrono::steady_clock::now();
+  int count {0};
+  if (follow_ || skip_payload_ || uring_ || !checkpoint_file_.empty()) {
+    // follow the file or keep track of the read position, displaying packets
+    // as they are read
+    count = load_sequence(in_file_);
+  } else {
+    // extract packets and hosts from file
+    load_hosts(in_file_);
+    count = static_cast<int>(sampler_.seen());
+  }
+  // display read throughput
+  if (stats_) {
+    std::chrono::duration<double> seconds =
+        std::chrono::steady_clock::now() - start;
+    std::cerr << count << " packet(s) read in " << seconds.count();
+    std::cerr << " seconds (" << static_cast<uint64_t>(count / seconds.count());
+    std::cerr << " packets/s)" << std::endl;
+  }
   // display packets read
   if (verbose_) {
     for (Packet p : packets_) {
@@ -345,7 +1170,59 @@ int IPForensics::load_from_file() {
     }
   }
   // return number of packets read
-  return int (packets_.size());
+  return count;
+}
+
+/**
+ *  @details Vendors are listed from the most to the least hosts, with
+ *           locally administered and unregistered MAC addresses counted as
+ *           ipf::kRandomVendor and ipf::kUnknownVendor.
+ */
+void IPForensics::vendor_counts(std::ostream* out) const {
+  std::map<std::string, uint64_t> counts;
+  for (const Host& h : hosts_) {
+    const char* vendor = OUI::vendor(h.mac());
+    ++counts[*vendor == '\0' ? ipf::kUnknownVendor : vendor];
+  }
+  std::vector<std::pair<uint64_t, std::string>> sorted;
+  for (const auto& c : counts) {
+    sorted.push_back({c.second, c.first});
+  }
+  std::stable_sort(sorted.begin(), sorted.end(),
+                   [](const std::pair<uint64_t, std::string>& a,
+                      const std::pair<uint64_t, std::string>& b) {
+                     return a.first > b.first;
+                   });
+  *out << "Hosts by vendor: ";
+  for (size_t i = 0; i < sorted.size(); ++i) {
+    if (i > 0) *out << "; ";
+    *out << sorted[i].second << ": " << sorted[i].first;
+  }
+  *out << '\n';
+}
+
+/**
+ *  @details The host table is already in MAC order.  Address orders are 
+ *           radix sorted from it, on every core for large tables, so hosts 
+ *           sharing an address keep their MAC order.
+ */
+std::vector<const Host*> IPForensics::sorted_hosts() const {
+  size_t threads = 1;
+  if (hosts_.size() >= ipf::kParallelSortHosts) {
+    threads = std::max(1u, std::thread::hardware_concurrency());
+  }
+  if (order_ == ReportWriter::Order::kIPv4) {
+    return by_address<ipf::kLengthIPv4 + 1>(hosts_, false, threads);
+  }
+  if (order_ == ReportWriter::Order::kIPv6) {
+    return by_address<ipf::kLengthIPv6 + 1>(hosts_, true, threads);
+  }
+  std::vector<const Host*> sorted;
+  sorted.reserve(hosts_.size());
+  for (const Host& h : hosts_) {
+    sorted.push_back(&h);
+  }
+  return sorted;
 }
 
 /**
@@ -353,44 +1230,83 @@ int IPForensics::load_from_file() {
  *           header (MAC Address, IPv4 Address, IPv6 Address), a column header
  *           separator using the character '=", the MAC, IPv4 and IPv6 addresses
  *           for hosts found sorted by MAC address, a footer separator using the
- *           character '=', and a host count summary.
- *  @throws std::runtime_error if the output file cannot be opened or written to
+ *           character '=', and a host count summary, with the counts over 
+ *           time if a census interval is set.  In sketch-only mode 
+ *           there is no host table or summary.  The top talkers follow if 
+ *           tracked, then the estimated inventory when sketching, which is 
+ *           also saved to the sketch file if there is one.  Hosts are saved
+ *           to the snapshot file or its delta log, if any, except in 
+ *           sketch-only mode.  The hosts and summary are written by the
+ *           ReportWriter of the chosen format, on every core for large 
+ *           tables; the sections after them only appear in the table format.
+ *           The summary counts are kept by census_ as hosts change, so 
+ *           summary-only mode writes them without visiting a single host.
+ *           It always writes to the console, never over the inventory in the
+ *           output file, and keeps the sections after the summary.
+ *  @throws std::runtime_error if the output, sketch or snapshot file cannot be
+ *          opened or written to
  */
 void IPForensics::results() {
-  std::stringstream result;
-  // output hosts
-  result << ipf::kHeader1 << std::endl << ipf::kHeader2 << std::endl;
-  for (Host h : hosts()) {
-    result << h << std::endl;
-  }
-  // output summary
-  size_t hosts = hosts_.size(), v4 = 0, v6 = 0, dual = 0;
-  for (Host h : hosts_) {
-    if (!h.ipv4().empty() && h.ipv6().empty()) ++v4;
-    if (!h.ipv6().empty() && h.ipv4().empty()) ++v6;
-    if (!h.ipv4().empty() && !h.ipv6().empty()) ++dual;
-  }
-  double pc = static_cast<double>(dual + v6) / static_cast<double>(hosts) * 100;
-  result << ipf::kFooter1 << '\n';
-  result << "Hosts: " << hosts;
-  result << "; IPv4 only: " << v4;
-  result << "; IPv6 only: " << v6;
-  result << "; dual-stack: " << dual;
-  result << std::fixed << std::setprecision(0);
-  result << "; migrated: " << pc << "%" << std::endl;
+  if (!sketch_file_.empty()) {
+    sketch_.save(sketch_file_);
+  }
+  if (!snapshot_file_.empty() && !sketch_only_) {
+    save_snapshot();
+  }
   // display or save results
-  if (out_file_.empty()) {
-    std::cout << result.str();
-  } else {
-    std::ofstream ofs(out_file_, std::ofstream::out);
-    if (!ofs.is_open()) {
-      throw std::runtime_error("Could not open output file " + out_file_);
+  std::unique_ptr<ReportWriter> writer = ReportWriter::create(format_,
+                                                              vendors_);
+  writer->open(summary_only_ ? std::string() : out_file_);
+  std::stringstream result;
+  if (!sketch_only_) {
+    // output hosts and summary, counted as the hosts changed
+    ReportWriter::Summary summary {
+        census_.hosts(), census_.count(HostCensus::Stack::kIPv4),
+        census_.count(HostCensus::Stack::kIPv6),
+        census_.count(HostCensus::Stack::kDual),
+        census_.skipped(HostCensus::Skip::kExcluded),
+        census_.skipped(HostCensus::Skip::kFake)};
+    if (summary_only_) {
+      writer->summary(summary);
+    } else {
+      writer->begin();
+      writer->hosts(sorted_hosts(), activity_.data(),
+                    std::max(1u, std::thread::hardware_concurrency()));
+      writer->end(summary);
     }
-    ofs << result.str();
-    if (ofs.bad()) {
-      ofs.close();
-      throw std::runtime_error("Could not write to output file " + out_file_);
+    if (sampler_.rate() > 1) {
+      result << sampler_ << std::endl;
+    }
+    if (evicted_ > 0) {
+      result << "Idle hosts evicted: " << evicted_ << std::endl;
+    }
+    if (verbose_ && (summary.excluded > 0 || summary.fake > 0)) {
+      result << "Addresses skipped: " << summary.excluded << " excluded; ";
+      result << summary.fake << " fake" << std::endl;
+    }
+    if (vendors_) {
+      vendor_counts(&result);
+    }
+    if (census_.interval() > 0) {
+      result << "Hosts by " << census_.interval() << " second interval:\n";
+      result << census_;
+    }
+    if (!index_.conflicts().empty()) {
+      result << "Address conflicts: " << index_.conflicts().size() << std::endl;
+      for (const Conflict& c : index_.conflicts()) {
+        result << c << std::endl;
+      }
+    }
+  }
+  if (top_.k() > 0) {
+    result << top_;
+  }
+  if (sketching_) {
+    result << sketch_;
+    if (sketch_only_ && sampler_.rate() > 1) {
+      result << sampler_ << std::endl;
     }
-    ofs.close();
   }
+  writer->text(result.str());
+  writer->close();
 }
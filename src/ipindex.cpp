@@ -0,0 +1,129 @@
+/**
+ *  @file ipindex.cpp
+ *  @brief IPIndex class implementation
+ */
+
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014 Michael Maraya
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <iostream>  // NOLINT
+#include <string>
+#include <vector>
+#include "ipforensics/ipindex.h"
+
+std::ostream& operator<<(std::ostream& out, const Conflict& c) {
+  out << "Address " << c.address << " moved from " << c.first << " to ";
+  out << c.second << " at " << utc_time(c.first_time);
+  if (c.changes > 1) {
+    out << "; " << c.changes << " changes, last at " << utc_time(c.last_time);
+  }
+  return out;
+}
+
+/**
+ *  @details FNV-1a over the 16 octets.
+ */
+size_t PackedIPv6Hash::operator()(const Host::PackedIPv6& a) const {
+  uint64_t hash {14695981039346656037ULL};
+  for (uint8_t octet : a) {
+    hash = (hash ^ octet) * 1099511628211ULL;
+  }
+  return static_cast<size_t>(hash);
+}
+
+const std::vector<Conflict>& IPIndex::conflicts() const {
+  return conflicts_;
+}
+
+MACAddress IPIndex::owner(const IPv4Address& ipv4) const {
+  auto it = ipv4_.find(Host::pack(ipv4));
+  if (it == ipv4_.end()) return MACAddress();
+  return Host::unpack(it->second.mac);
+}
+
+MACAddress IPIndex::owner(const IPv6Address& ipv6) const {
+  auto it = ipv6_.find(Host::pack(ipv6));
+  if (it == ipv6_.end()) return MACAddress();
+  return Host::unpack(it->second.mac);
+}
+
+/**
+ *  @details Group addresses (I/G bit set) never hold an address.  An index 
+ *           is returned rather than a pointer, as a later claim may grow 
+ *           conflicts_ and move it.
+ */
+uint32_t IPIndex::claim(const IPv4Address& ipv4, const MACAddress& mac,
+                        int64_t time) {
+  if (ipv4.empty() || ipv4.fake() || mac.empty()) return kNoConflict;
+  if (mac.address()[0] & 0x01) return kNoConflict;
+  Host::PackedIPv4 packed = Host::pack(ipv4);
+  if (packed == 0) return kNoConflict;
+  auto result = ipv4_.insert({packed, Claim {Host::pack(mac), kNoConflict}});
+  return claim(&result.first->second, result.second, ipv4, mac, time);
+}
+
+uint32_t IPIndex::claim(const IPv6Address& ipv6, const MACAddress& mac,
+                        int64_t time) {
+  if (ipv6.empty() || ipv6.fake() || mac.empty()) return kNoConflict;
+  if (mac.address()[0] & 0x01) return kNoConflict;
+  Host::PackedIPv6 packed = Host::pack(ipv6);
+  if (packed == Host::PackedIPv6 {}) return kNoConflict;
+  auto result = ipv6_.insert({packed, Claim {Host::pack(mac), kNoConflict}});
+  return claim(&result.first->second, result.second, ipv6, mac, time);
+}
+
+uint32_t IPIndex::claim(Claim* claim, bool inserted, const Address& address,
+                        const MACAddress& mac, int64_t time) {
+  if (inserted) return kNoConflict;
+  uint64_t packed = Host::pack(mac);
+  if (claim->mac == packed) return kNoConflict;
+  uint32_t conflict {kNoConflict};
+  if (claim->conflict == kNoConflict) {
+    claim->conflict = static_cast<uint32_t>(conflicts_.size());
+    Conflict raised;
+    raised.address = address.str();
+    raised.first = Host::unpack(claim->mac);
+    raised.second = mac;
+    raised.first_time = time;
+    conflicts_.push_back(raised);
+    conflict = claim->conflict;
+  }
+  Conflict& c = conflicts_[claim->conflict];
+  ++c.changes;
+  c.last_time = time;
+  claim->mac = packed;
+  return conflict;
+}
+
+void IPIndex::release(const Host& host) {
+  uint64_t mac = Host::pack(host.mac());
+  for (const IPv4Address& ipv4 : host.ipv4s()) {
+    auto it = ipv4_.find(Host::pack(ipv4));
+    if (it != ipv4_.end() && it->second.mac == mac) ipv4_.erase(it);
+  }
+  for (const IPv6Address& ipv6 : host.ipv6s()) {
+    auto it = ipv6_.find(Host::pack(ipv6));
+    if (it != ipv6_.end() && it->second.mac == mac) ipv6_.erase(it);
+  }
+}
@@ -28,10 +28,13 @@
  */
 
 #include <fstream>  // NOLINT
+#include <stdexcept>
 #include <string>
 #include <vector>
 #include "ipforensics/main.h"
+#include "ipforensics/diff.h"
 #include "ipforensics/ip46file.h"
+#include "ipforensics/merge.h"
 
 /**
  *  @brief IPForensics program entry point
@@ -87,6 +90,65 @@ int main(int argc, char* argv[]) {
       return 1;
     }
   }
+  // decode only one in --sample rate packets, selected --sample-by method
+  it = find(args.begin(), args.end(), "--sample");
+  if (it != args.end()) {
+    // anything but a whole number from 1 to UINT32_MAX leaves rate at 0
+    int64_t rate {0};
+    if (next(it) != args.end()) {
+      try {
+        size_t used {0};
+        rate = stoll(*next(it), &used);
+        if (used != next(it)->size()) rate = 0;
+      } catch (std::exception const &) {
+        rate = 0;
+      }
+    }
+    if (rate < 1 || rate > UINT32_MAX) {
+      std::cout << ipf::kProgramName << ": option --sample requires an";
+      std::cout << " argument from 1 to " << UINT32_MAX << "\n";
+      usage();
+      return 1;
+    }
+    Sampler::Method method = Sampler::Method::kCount;
+    std::vector<std::string>::iterator by;
+    by = find(args.begin(), args.end(), "--sample-by");
+    try {
+      if (by != args.end() && next(by) != args.end()) {
+        method = Sampler::method(*next(by));
+      }
+      ip.set_sampler(method, static_cast<uint32_t>(rate));
+    } catch (std::exception const &e) {
+      std::cout << ipf::kProgramName << ": invalid sampling option: ";
+      std::cout << e.what() << std::endl;
+      return 1;
+    }
+  }
+  // keep at most --max-ipv4 and --max-ipv6 addresses for each host
+  const std::string families[] = {"--max-ipv4", "--max-ipv6"};
+  for (const std::string& option : families) {
+    it = find(args.begin(), args.end(), option);
+    if (it == args.end()) continue;
+    if (next(it) == args.end()) {
+      std::cout << ipf::kProgramName << ": option " << option;
+      std::cout << " requires an argument\n";
+      usage();
+      return 1;
+    }
+    try {
+      int max = stoi(*next(it));
+      if (max < 1) throw std::out_of_range("must be at least 1");
+      if (option == "--max-ipv4") {
+        ip.set_max_ipv4(static_cast<size_t>(max));
+      } else {
+        ip.set_max_ipv6(static_cast<size_t>(max));
+      }
+    } catch (std::exception const &e) {
+      std::cout << "Could not convert \'" << option << ' ' << *next(it);
+      std::cout << "\' into a number: " << e.what() << std::endl;
+      return 1;
+    }
+  }
   // read packets from -r filename
   it = find(args.begin(), args.end(), "-r");
   if (it != args.end()) {
@@ -98,6 +160,239 @@ int main(int argc, char* argv[]) {
       return 1;
     }
   }
+  // keep reading the -r filename as it grows
+  it = find(args.begin(), args.end(), "--follow");
+  if (it != args.end()) {
+    if (ip.in_file().empty()) {
+      std::cout << ipf::kProgramName << ": option --follow requires -r\n";
+      usage();
+      return 1;
+    }
+    ip.set_follow(true);
+  }
+  // run until interrupted, writing the hosts every --daemon seconds
+  it = find(args.begin(), args.end(), "--daemon");
+  if (it != args.end()) {
+    if (next(it) != args.end()) {
+      try {
+        int seconds = stoi(*next(it));
+        if (seconds < 1) throw std::out_of_range("must be at least 1");
+        ip.set_daemon(seconds);
+      } catch (std::exception const &e) {
+        std::cout << "Could not convert \'--daemon " << *next(it);
+        std::cout << "\' into a number: " << e.what() << std::endl;
+        return 1;
+      }
+    } else {
+      std::cout << ipf::kProgramName << ": option --daemon requires an";
+      std::cout << " argument\n";
+      usage();
+      return 1;
+    }
+    if (!ip.in_file().empty()) ip.set_follow(true);
+  }
+  // read only the decoded bytes of each -r record
+  it = find(args.begin(), args.end(), "--skip-payload");
+  if (it != args.end()) {
+    ip.set_skip_payload(true);
+  }
+  // read -r records through io_uring
+  it = find(args.begin(), args.end(), "--uring");
+  if (it != args.end()) {
+    ip.set_uring(true);
+  }
+  // display -r read throughput
+  it = find(args.begin(), args.end(), "--stats");
+  if (it != args.end()) {
+    ip.set_stats(true);
+  }
+  // save progress to --checkpoint filename
+  it = find(args.begin(), args.end(), "--checkpoint");
+  if (it != args.end()) {
+    if (next(it) != args.end() && !ip.in_file().empty()) {
+      ip.set_checkpoint_file(*next(it));
+    } else {
+      std::cout << ipf::kProgramName << ": option --checkpoint requires an";
+      std::cout << " argument and -r\n";
+      usage();
+      return 1;
+    }
+  }
+  // continue from the last --checkpoint
+  it = find(args.begin(), args.end(), "--resume");
+  if (it != args.end()) {
+    if (ip.checkpoint_file().empty()) {
+      std::cout << ipf::kProgramName << ": option --resume requires";
+      std::cout << " --checkpoint\n";
+      usage();
+      return 1;
+    }
+    ip.set_resume(true);
+  }
+  // attribute only addresses on the --local networks to hosts
+  it = find(args.begin(), args.end(), "--local");
+  if (it != args.end()) {
+    if (next(it) != args.end()) {
+      try {
+        ip.load_local(*next(it));
+      } catch (std::exception const &e) {
+        std::cout << ipf::kProgramName << ": " << e.what() << std::endl;
+        return 1;
+      }
+    } else {
+      std::cout << ipf::kProgramName << ": option --local requires an";
+      std::cout << " argument\n";
+      usage();
+      return 1;
+    }
+  }
+  // evict hosts idle for --idle-timeout seconds
+  it = find(args.begin(), args.end(), "--idle-timeout");
+  if (it != args.end()) {
+    if (next(it) != args.end()) {
+      try {
+        int seconds = stoi(*next(it));
+        if (seconds < 1) throw std::out_of_range("must be at least 1");
+        ip.set_idle_timeout(seconds);
+      } catch (std::exception const &e) {
+        std::cout << "Could not convert \'--idle-timeout " << *next(it);
+        std::cout << "\' into a number: " << e.what() << std::endl;
+        return 1;
+      }
+    } else {
+      std::cout << ipf::kProgramName << ": option --idle-timeout requires an";
+      std::cout << " argument\n";
+      usage();
+      return 1;
+    }
+  }
+  // append evicted hosts to --evict-to filename
+  it = find(args.begin(), args.end(), "--evict-to");
+  if (it != args.end()) {
+    if (next(it) == args.end()) {
+      std::cout << ipf::kProgramName << ": option --evict-to requires an";
+      std::cout << " argument\n";
+      usage();
+      return 1;
+    }
+    if (ip.idle_timeout() == 0) {
+      std::cout << ipf::kProgramName << ": option --evict-to requires";
+      std::cout << " --idle-timeout\n";
+      usage();
+      return 1;
+    }
+    ip.set_evict_file(*next(it));
+  }
+  // add a vendor column and per-vendor counts with --vendor
+  it = find(args.begin(), args.end(), "--vendor");
+  if (it != args.end()) {
+    ip.set_vendors(true);
+  }
+  // write the report as a table, CSV, NDJSON or JSON with --format
+  it = find(args.begin(), args.end(), "--format");
+  if (it != args.end()) {
+    if (next(it) != args.end()) {
+      try {
+        ip.set_format(ReportWriter::format(*next(it)));
+      } catch (std::exception const &e) {
+        std::cout << ipf::kProgramName << ": " << e.what() << std::endl;
+        return 1;
+      }
+    } else {
+      std::cout << ipf::kProgramName << ": option --format requires an";
+      std::cout << " argument\n";
+      usage();
+      return 1;
+    }
+  }
+  // write the hosts by MAC, IPv4 or IPv6 address with --sort
+  it = find(args.begin(), args.end(), "--sort");
+  if (it != args.end()) {
+    if (next(it) != args.end()) {
+      try {
+        ip.set_order(ReportWriter::order(*next(it)));
+      } catch (std::exception const &e) {
+        std::cout << ipf::kProgramName << ": " << e.what() << std::endl;
+        return 1;
+      }
+    } else {
+      std::cout << ipf::kProgramName << ": option --sort requires an";
+      std::cout << " argument\n";
+      usage();
+      return 1;
+    }
+  }
+  // write only the summary counts with --summary-only
+  it = find(args.begin(), args.end(), "--summary-only");
+  if (it != args.end()) {
+    ip.set_summary_only(true);
+  }
+  // record host counts by IP stack every --interval seconds
+  it = find(args.begin(), args.end(), "--interval");
+  if (it != args.end()) {
+    if (next(it) != args.end()) {
+      try {
+        int seconds = stoi(*next(it));
+        if (seconds < 1) throw std::out_of_range("must be at least 1");
+        ip.set_census_interval(seconds);
+      } catch (std::exception const &e) {
+        std::cout << "Could not convert \'--interval " << *next(it);
+        std::cout << "\' into a number: " << e.what() << std::endl;
+        return 1;
+      }
+    } else {
+      std::cout << ipf::kProgramName << ": option --interval requires an";
+      std::cout << " argument\n";
+      usage();
+      return 1;
+    }
+  }
+  // rank the --top K MAC and IP addresses by packets and bytes
+  it = find(args.begin(), args.end(), "--top");
+  if (it != args.end()) {
+    if (next(it) != args.end()) {
+      try {
+        int k = stoi(*next(it));
+        if (k < 1) throw std::out_of_range("must be at least 1");
+        ip.set_top(static_cast<size_t>(k));
+      } catch (std::exception const &e) {
+        std::cout << "Could not convert \'--top " << *next(it);
+        std::cout << "\' into a number: " << e.what() << std::endl;
+        return 1;
+      }
+    } else {
+      std::cout << ipf::kProgramName << ": option --top requires an";
+      std::cout << " argument\n";
+      usage();
+      return 1;
+    }
+  }
+  // estimate the inventory with --sketch, --sketch-only or --sketch-file
+  it = find(args.begin(), args.end(), "--sketch");
+  if (it != args.end()) {
+    ip.set_sketching(true);
+  }
+  it = find(args.begin(), args.end(), "--sketch-only");
+  if (it != args.end()) {
+    ip.set_sketch_only(true);
+  }
+  it = find(args.begin(), args.end(), "--sketch-file");
+  if (it != args.end()) {
+    if (next(it) != args.end()) {
+      ip.set_sketch_file(*next(it));
+      try {
+        ip.load_sketch();
+      } catch (std::exception const &e) {
+        std::cout << ipf::kProgramName << ": " << e.what() << std::endl;
+        return 1;
+      }
+    } else {
+      std::cout << ipf::kProgramName << ": option --sketch-file requires an";
+      std::cout << " argument\n";
+      usage();
+      return 1;
+    }
+  }
   // write host report to -w filename
   it = find(args.begin(), args.end(), "-w");
   if (it != args.end()) {
@@ -116,30 +411,131 @@ int main(int argc, char* argv[]) {
       return 1;
     }
   }
+  // the -w file holds the inventory, so it cannot take a summary instead
+  if (ip.summary_only() && !ip.out_file().empty()) {
+    std::cout << ipf::kProgramName << ": option --summary-only writes to the";
+    std::cout << " console and cannot be used with -w\n";
+    usage();
+    return 1;
+  }
   // exclude hosts from -x filename
   it = find(args.begin(), args.end(), "-x");
   if (it != args.end()) {
     if (next(it) != args.end()) {
       ip.set_exclude_file(*next(it));
+      try {
+        ip.load_exclude();
+      } catch (std::exception const &e) {
+        std::cout << ipf::kProgramName << ": " << e.what() << std::endl;
+        return 1;
+      }
     } else {
       std::cout << ipf::kProgramName << ": option -x requires an argument\n";
       usage();
       return 1;
     }
   }
-  // load hosts from output file if pre-populated
+  // combine the inventories named after --merge instead of capturing
+  it = find(args.begin(), args.end(), "--merge");
+  if (it != args.end()) {
+    Merge merge(&ip);
+    for (++it; it != args.end() && (*it)[0] != '-'; ++it) {
+      merge.add_file(*it);
+    }
+    if (merge.files().empty()) {
+      std::cout << ipf::kProgramName << ": option --merge requires at least";
+      std::cout << " one file\n";
+      usage();
+      return 1;
+    }
+    try {
+      size_t read = merge.run();
+      report_errors(merge.errors(), merge.errors().size());
+      if (ip.verbose()) {
+        std::cout << "Merged " << read << " hosts from ";
+        std::cout << merge.files().size() << " files into ";
+        std::cout << ip.hosts().size() << " hosts" << std::endl;
+      }
+      ip.results();
+    } catch (std::exception const &e) {
+      std::cout << ipf::kProgramName << ": " << e.what() << std::endl;
+      return 1;
+    }
+    return 0;
+  }
+  // compare the two inventories named after --diff instead of capturing
+  it = find(args.begin(), args.end(), "--diff");
+  if (it != args.end()) {
+    if (distance(it, args.end()) < 3 || (*next(it))[0] == '-' ||
+        (*next(it, 2))[0] == '-') {
+      std::cout << ipf::kProgramName << ": option --diff requires two files\n";
+      usage();
+      return 1;
+    }
+    Diff diff(&ip, *next(it), *next(it, 2));
+    try {
+      if (ip.out_file().empty()) {
+        diff.run(&std::cout);
+      } else {
+        std::ofstream ofs(ip.out_file(), std::ofstream::out |
+                                         std::ofstream::trunc);
+        if (!ofs) {
+          throw std::runtime_error("could not open " + ip.out_file());
+        }
+        diff.run(&ofs);
+      }
+      report_errors(diff.errors(), diff.errors().size());
+    } catch (std::exception const &e) {
+      std::cout << ipf::kProgramName << ": " << e.what() << std::endl;
+      return 1;
+    }
+    return 0;
+  }
+  // load hosts from the --snapshot file if it exists
+  bool snapshot_loaded {false};
+  it = find(args.begin(), args.end(), "--snapshot");
+  if (it != args.end()) {
+    if (next(it) != args.end()) {
+      ip.set_snapshot_file(*next(it));
+      try {
+        snapshot_loaded = ip.load_snapshot();
+      } catch (std::exception const &e) {
+        std::cout << ipf::kProgramName << ": " << e.what() << std::endl;
+        return 1;
+      }
+      if (snapshot_loaded && ip.verbose()) {
+        std::cout << "Loaded " << ip.hosts().size() << " hosts from ";
+        std::cout << ip.snapshot_file() << std::endl;
+      }
+    } else {
+      std::cout << ipf::kProgramName << ": option --snapshot requires an";
+      std::cout << " argument\n";
+      usage();
+      return 1;
+    }
+  }
+  // otherwise load hosts from output file if pre-populated
   IP46File ipfile(&ip);
-  if (ipfile.valid()) {
-    ipfile.load();
-    if (ip.verbose()) {
-      std::cout << "Loaded " << ip.hosts().size() << " hosts from ";
-      std::cout << ip.out_file() << std::endl;
+  if (!snapshot_loaded) {
+    bool loaded {false};
+    try {
+      loaded = ipfile.load();
+    } catch (std::exception const &e) {
+      std::cout << ipf::kProgramName << ": " << e.what() << std::endl;
+      return 1;
     }
-  } else {
-    if (ip.verbose()) {
-      std::cout << ip.out_file() << " is not a valid " << ipf::kProgramName;
-      std::cout << " file.  No hosts loaded." << std::endl;
+    if (loaded) {
+      if (ip.verbose()) {
+        std::cout << "Loaded " << ip.hosts().size() << " hosts from ";
+        std::cout << ip.out_file() << std::endl;
+      }
+    } else {
+      if (ip.verbose()) {
+        std::cout << ip.out_file() << " is not a valid ";
+        std::cout << ipf::kProgramName << " file.  No hosts loaded.\n";
+      }
     }
+    report_errors(ipfile.errors(), ipfile.error_count());
   }
   // load hosts from either file or packet capture device
   int packets_loaded {0};
@@ -174,6 +570,19 @@ int main(int argc, char* argv[]) {
   }
 }
 
+/**
+ *  @details Rows beyond those described are only counted.
+ */
+void report_errors(const std::vector<std::string>& errors, size_t count) {
+  for (const std::string& e : errors) {
+    std::cout << ipf::kProgramName << ": " << e << std::endl;
+  }
+  if (count > errors.size()) {
+    std::cout << ipf::kProgramName << ": " << count - errors.size();
+    std::cout << " more bad rows skipped" << std::endl;
+  }
+}
+
 /**
  *  @details Display program name, version, and usage
  */
@@ -187,6 +596,50 @@ void usage() {
   std::cout << "-i interface    packet capture device to use (admin needed)\n";
   std::cout << "-c count        number of packets to read or capture\n";
   std::cout << "-r in file      read packets from pcap file\n";
+  std::cout << "--sample n      decode only one in n packets and estimate";
+  std::cout << " coverage\n";
+  std::cout << "--sample-by m   sample by count (default), time or flow\n";
+  std::cout << "--local f       ignore addresses outside the networks in f\n";
+  std::cout << "--max-ipv4 n    keep at most n IPv4 addresses per host";
+  std::cout << " (default " << ipf::kMaxAddressesIPv4 << ")\n";
+  std::cout << "--max-ipv6 n    keep at most n IPv6 addresses per host";
+  std::cout << " (default " << ipf::kMaxAddressesIPv6 << ")\n";
+  std::cout << "--follow        keep reading the -r file and its rotations as";
+  std::cout << " they grow\n";
+  std::cout << "--daemon s      capture until interrupted, writing the";
+  std::cout << " report every s seconds and on SIGHUP\n";
+  std::cout << "--skip-payload  read only the headers of each -r record\n";
+  std::cout << "--uring         read the -r file through io_uring (Linux)\n";
+  std::cout << "--stats         display -r read throughput\n";
+  std::cout << "--checkpoint f  periodically save -r progress and hosts to f\n";
+  std::cout << "--resume        continue from the --checkpoint file\n";
+  std::cout << "--idle-timeout s\n";
+  std::cout << "                evict hosts not seen for s seconds of packet";
+  std::cout << " time\n";
+  std::cout << "--evict-to f    append evicted hosts to f\n";
+  std::cout << "--format f      write the report as table (default), csv,";
+  std::cout << " ndjson or json\n";
+  std::cout << "--vendor        add a vendor column and per-vendor host";
+  std::cout << " counts\n";
+  std::cout << "--sort key      write the hosts by mac (default), ipv4 or";
+  std::cout << " ipv6 address\n";
+  std::cout << "--summary-only  display only the host counts, without the";
+  std::cout << " hosts\n";
+  std::cout << "--interval s    report host counts by IP stack every s";
+  std::cout << " seconds of packet time\n";
+  std::cout << "--top k         report the k busiest MAC and IP addresses\n";
+  std::cout << "--sketch        also report estimated distinct hosts and";
+  std::cout << " addresses per subnet\n";
+  std::cout << "--sketch-only   report only the estimates, in bounded memory\n";
+  std::cout << "--sketch-file f merge estimates from f and save them back\n";
+  std::cout << "--snapshot f    load hosts from binary snapshot f if it";
+  std::cout << " exists, and save them to it\n";
+  std::cout << "--merge f ...   combine the reports and snapshots f ... into";
+  std::cout << " one report\n";
+  std::cout << "--diff a b      list the hosts added, removed and changed";
+  std::cout << " from inventory a to b\n";
+  std::cout << "-x file         exclude the MAC and IP addresses and networks";
+  std::cout << " in file\n";
   std::cout << "-w out file     write summary report to file, or append if the";
   std::cout << " file exists\n";
   std::cout << std::endl;
@@ -0,0 +1,178 @@
+/**
+ *  @file merge.cpp
+ *  @brief Merge class implementation
+ */
+
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014 Michael Maraya
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <fstream>  // NOLINT
+#include <functional>
+#include <queue>
+#include <stdexcept>
+#include <string>
+#include <thread>  // NOLINT
+#include <utility>
+#include <vector>
+#include "ipforensics/ip46file.h"
+#include "ipforensics/merge.h"
+#include "ipforensics/threads.h"
+
+Merge::Merge(IPForensics* ip) {
+  ip_ = ip;
+}
+
+IPForensics* Merge::ip() const {
+  return ip_;
+}
+
+const std::vector<std::string>& Merge::files() const {
+  return files_;
+}
+
+const std::vector<std::string>& Merge::errors() const {
+  return errors_;
+}
+
+void Merge::add_file(const std::string& filename) {
+  files_.push_back(filename);
+}
+
+bool Merge::snapshot(const std::string& filename) {
+  std::ifstream fs(filename, std::ios::binary);
+  char magic[sizeof(ipf::kSnapshotMagic)];
+  if (!fs.read(magic, sizeof(magic))) return false;
+  return std::memcmp(magic, ipf::kSnapshotMagic, sizeof(magic)) == 0;
+}
+
+/**
+ *  @details Reports are read into Hosts and then packed into records, so 
+ *           only one file's Hosts are held at once per thread.  A single 
+ *           file may use every thread; several files use one thread each. 
+ *           Inputs are normally sorted already; those that are not are sorted
+ *           here.
+ */
+void Merge::read(const std::string& filename, Run* run) const {
+  if (snapshot(filename)) {
+    Snapshot snapshot(ip_);
+    snapshot.read(filename, &run->records, &run->aliases);
+  } else {
+    IP46File::HostList hosts;
+    IP46File ipfile(ip_);
+    if (files_.size() > 1) ipfile.set_threads(1);
+    if (!ipfile.read(filename, &hosts)) {
+      throw std::runtime_error(filename + ": missing or not a valid " +
+                               ipf::kProgramName + " file");
+    }
+    run->errors = ipfile.errors();
+    run->records.reserve(hosts.size());
+    for (const std::pair<Host, Activity>& h : hosts) {
+      run->records.push_back(Snapshot::encode(h.first, h.second,
+                                              &run->aliases));
+    }
+  }
+  auto by_mac = [](const Snapshot::Record& a, const Snapshot::Record& b) {
+    return a.mac < b.mac;
+  };
+  if (!std::is_sorted(run->records.begin(), run->records.end(), by_mac)) {
+    std::stable_sort(run->records.begin(), run->records.end(), by_mac);
+  }
+}
+
+/**
+ *  @details Files are handed to the workers one at a time, so a few large 
+ *           inputs do not hold up the rest.  Heap entries compare the packed
+ *           MAC address and then the file index, so copies of a host come off
+ *           the heap in the order the files were given.
+ */
+size_t Merge::run() {
+  std::vector<Run> runs(files_.size());
+  std::vector<std::string> errors(files_.size());
+  std::atomic<size_t> next {0};
+  auto work = [&]() {
+    for (size_t i = next++; i < files_.size(); i = next++) {
+      try {
+        read(files_[i], &runs[i]);
+      } catch (std::exception const &e) {
+        errors[i] = e.what();
+      }
+    }
+  };
+  size_t workers = std::min<size_t>(files_.size(),
+                                    std::thread::hardware_concurrency());
+  run_threads(std::max<size_t>(workers, 1), [&](size_t) { work(); });
+  for (const std::string& e : errors) {
+    if (!e.empty()) throw std::runtime_error(e);
+  }
+  errors_.clear();
+  for (const Run& r : runs) {
+    errors_.insert(errors_.end(), r.errors.begin(), r.errors.end());
+  }
+  typedef std::pair<uint64_t, size_t> Entry;
+  std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> heap;
+  std::vector<size_t> position(runs.size(), 0);
+  size_t total = 0;
+  for (size_t i = 0; i < runs.size(); ++i) {
+    total += runs[i].records.size();
+    if (!runs[i].records.empty()) heap.push({runs[i].records[0].mac, i});
+  }
+  while (!heap.empty()) {
+    uint64_t mac = heap.top().first;
+    Host host;
+    Activity activity;
+    bool first = true;
+    while (!heap.empty() && heap.top().first == mac) {
+      size_t i = heap.top().second;
+      heap.pop();
+      Run& r = runs[i];
+      Activity a;
+      Host h = Snapshot::decode(r.records[position[i]], r.aliases.data(), ip_,
+                                &a);
+      if (first) {
+        host = h;
+        activity = a;
+        first = false;
+      } else {
+        ip_->update_addresses(&host, h.ipv4(), h.ipv6());
+        for (const IPv4Address& v4 : h.ipv4s()) {
+          ip_->update_addresses(&host, v4, IPv6Address());
+        }
+        for (const IPv6Address& v6 : h.ipv6s()) {
+          ip_->update_addresses(&host, IPv4Address(), v6);
+        }
+        activity.merge(a);
+      }
+      if (++position[i] < r.records.size()) {
+        heap.push({r.records[position[i]].mac, i});
+      } else {
+        r = Run();
+      }
+    }
+    ip_->add_host(host, activity);
+  }
+  return total;
+}
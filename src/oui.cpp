@@ -0,0 +1,273 @@
+/**
+ *  @file oui.cpp
+ *  @brief OUI class implementation
+ */
+
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014 Michael Maraya
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <vector>
+#include "ipforensics/ip4and6.h"
+#include "ipforensics/oui.h"
+
+namespace {
+
+/** Locally administered bit of the first MAC address octet */
+const uint8_t kLocalBit {0x02};
+
+/**
+ *  @brief Registrations, sorted by prefix
+ *  @details Short names follow the usual abbreviations; add entries in 
+ *           prefix order, which the static_assert below enforces.
+ */
+constexpr OUI::Entry kEntries[] = {
+  {0x00000C, "Cisco"},
+  {0x00005E, "IANA"},
+  {0x0000AA, "Xerox"},
+  {0x0000F0, "Samsung"},
+  {0x0000F8, "DEC"},
+  {0x000142, "Cisco"},
+  {0x000143, "Cisco"},
+  {0x000163, "Cisco"},
+  {0x000164, "Cisco"},
+  {0x000196, "Cisco"},
+  {0x000197, "Cisco"},
+  {0x0002B3, "Intel"},
+  {0x000347, "Intel"},
+  {0x000393, "Apple"},
+  {0x0003FF, "Microsoft"},
+  {0x000423, "Intel"},
+  {0x00044B, "NVIDIA"},
+  {0x000496, "Extreme"},
+  {0x000502, "Apple"},
+  {0x000569, "VMware"},
+  {0x000585, "Juniper"},
+  {0x0007E9, "Intel"},
+  {0x00090F, "Fortinet"},
+  {0x00095B, "Netgear"},
+  {0x000A27, "Apple"},
+  {0x000A95, "Apple"},
+  {0x000B86, "Aruba"},
+  {0x000BDB, "Dell"},
+  {0x000C29, "VMware"},
+  {0x000C42, "MikroTik"},
+  {0x000C6E, "ASUSTek"},
+  {0x000CF1, "Intel"},
+  {0x000D3A, "Microsoft"},
+  {0x000D93, "Apple"},
+  {0x000E0C, "Intel"},
+  {0x000E35, "Intel"},
+  {0x000FB5, "Netgear"},
+  {0x001018, "Broadcom"},
+  {0x0010DB, "Juniper"},
+  {0x0010FA, "Apple"},
+  {0x001111, "Intel"},
+  {0x001124, "Apple"},
+  {0x00112F, "ASUSTek"},
+  {0x00121E, "Juniper"},
+  {0x00125A, "Microsoft"},
+  {0x0012F0, "Intel"},
+  {0x0012FB, "Samsung"},
+  {0x001302, "Intel"},
+  {0x001310, "Cisco-Linksys"},
+  {0x001320, "Intel"},
+  {0x0013CE, "Intel"},
+  {0x0013E8, "Intel"},
+  {0x001422, "Dell"},
+  {0x001451, "Apple"},
+  {0x00146C, "Netgear"},
+  {0x001500, "Intel"},
+  {0x001517, "Intel"},
+  {0x00155D, "Microsoft"},
+  {0x00156D, "Ubiquiti"},
+  {0x001599, "Samsung"},
+  {0x0015F2, "ASUSTek"},
+  {0x001632, "Samsung"},
+  {0x00163E, "Xensource"},
+  {0x00166F, "Intel"},
+  {0x001676, "Intel"},
+  {0x0016CB, "Apple"},
+  {0x0016EA, "Intel"},
+  {0x0016EB, "Intel"},
+  {0x001788, "Philips Hue"},
+  {0x0017A4, "HP"},
+  {0x0017F2, "Apple"},
+  {0x0017FA, "Microsoft"},
+  {0x001839, "Cisco-Linksys"},
+  {0x00184D, "Netgear"},
+  {0x0018DE, "Intel"},
+  {0x0019D1, "Intel"},
+  {0x0019D2, "Intel"},
+  {0x0019E2, "Juniper"},
+  {0x0019E3, "Apple"},
+  {0x001A11, "Google"},
+  {0x001A1E, "Aruba"},
+  {0x001A4B, "HP"},
+  {0x001A70, "Cisco-Linksys"},
+  {0x001A92, "ASUSTek"},
+  {0x001AA0, "Dell"},
+  {0x001B17, "Palo Alto"},
+  {0x001B21, "Intel"},
+  {0x001B63, "Apple"},
+  {0x001B77, "Intel"},
+  {0x001B78, "HP"},
+  {0x001C14, "VMware"},
+  {0x001C42, "Parallels"},
+  {0x001CB3, "Apple"},
+  {0x001CBF, "Intel"},
+  {0x001CC0, "Intel"},
+  {0x001D4F, "Apple"},
+  {0x001DE0, "Intel"},
+  {0x001DE1, "Intel"},
+  {0x001E0B, "HP"},
+  {0x001E2A, "Netgear"},
+  {0x001E52, "Apple"},
+  {0x001E64, "Intel"},
+  {0x001E65, "Intel"},
+  {0x001E67, "Intel"},
+  {0x001EC2, "Apple"},
+  {0x001F12, "Juniper"},
+  {0x001F33, "Netgear"},
+  {0x001F3B, "Intel"},
+  {0x001F3C, "Intel"},
+  {0x001F5B, "Apple"},
+  {0x001FF3, "Apple"},
+  {0x00215A, "HP"},
+  {0x00215C, "Intel"},
+  {0x00215D, "Intel"},
+  {0x00216A, "Intel"},
+  {0x00219B, "Dell"},
+  {0x0021E9, "Apple"},
+  {0x002241, "Apple"},
+  {0x0022FA, "Intel"},
+  {0x0022FB, "Intel"},
+  {0x002312, "Apple"},
+  {0x002314, "Intel"},
+  {0x002315, "Intel"},
+  {0x002332, "Apple"},
+  {0x00236C, "Apple"},
+  {0x0023DF, "Apple"},
+  {0x002436, "Apple"},
+  {0x00246C, "Aruba"},
+  {0x0024D6, "Intel"},
+  {0x0024D7, "Intel"},
+  {0x002500, "Apple"},
+  {0x00254B, "Apple"},
+  {0x0025B3, "HP"},
+  {0x0025BC, "Apple"},
+  {0x002608, "Apple"},
+  {0x00264A, "Apple"},
+  {0x0026B0, "Apple"},
+  {0x0026BB, "Apple"},
+  {0x0026C6, "Intel"},
+  {0x002710, "Intel"},
+  {0x002722, "Ubiquiti"},
+  {0x003065, "Apple"},
+  {0x004096, "Cisco"},
+  {0x005056, "VMware"},
+  {0x0050E4, "Apple"},
+  {0x0050F2, "Microsoft"},
+  {0x00869C, "Palo Alto"},
+  {0x009027, "Intel"},
+  {0x00904C, "Broadcom"},
+  {0x00A040, "Apple"},
+  {0x00A0C9, "Intel"},
+  {0x00AA00, "Intel"},
+  {0x00D0B7, "Intel"},
+  {0x00E018, "ASUSTek"},
+  {0x00E04C, "Realtek"},
+  {0x0418D6, "Ubiquiti"},
+  {0x080009, "HP"},
+  {0x080020, "Sun"},
+  {0x080027, "VirtualBox"},
+  {0x08002B, "DEC"},
+  {0x14CC20, "TP-Link"},
+  {0x180373, "Dell"},
+  {0x24A43C, "Ubiquiti"},
+  {0x281878, "Microsoft"},
+  {0x28CFDA, "Apple"},
+  {0x3C0754, "Apple"},
+  {0x3C5AB4, "Google"},
+  {0x3CD92B, "HP"},
+  {0x406C8F, "Apple"},
+  {0x44D9E7, "Ubiquiti"},
+  {0x4C5E0C, "MikroTik"},
+  {0x50C7BF, "TP-Link"},
+  {0x687251, "Ubiquiti"},
+  {0x7C6D62, "Apple"},
+  {0x802AA8, "Ubiquiti"},
+  {0x98FE94, "Apple"},
+  {0xA46706, "Apple"},
+  {0xB827EB, "Raspberry Pi"},
+  {0xD83062, "Apple"},
+  {0xDC9FDB, "Ubiquiti"},
+  {0xDCA632, "Raspberry Pi"},
+  {0xE0F847, "Apple"},
+  {0xE45F01, "Raspberry Pi"},
+  {0xF01FAF, "Dell"},
+  {0xF09FC2, "Ubiquiti"},
+  {0xF4F5D8, "Google"},
+};
+
+/** Number of registrations */
+constexpr size_t kSize {sizeof(kEntries) / sizeof(kEntries[0])};
+
+/** Checks the entries are strictly increasing, halving to bound recursion */
+constexpr bool sorted(const OUI::Entry* e, size_t n) {
+  return n < 2 || (sorted(e, n / 2) && e[n / 2 - 1].prefix < e[n / 2].prefix &&
+                   sorted(e + n / 2, n - n / 2));
+}
+
+static_assert(sorted(kEntries, kSize), "OUI entries must be sorted by prefix");
+
+}  // namespace
+
+bool OUI::random(const MACAddress& mac) {
+  std::vector<uint8_t> octets = mac.address();
+  return !octets.empty() && (octets[0] & kLocalBit) != 0;
+}
+
+/**
+ *  @details The binary search always takes log2(size()) steps, each a
+ *           conditional move rather than a branch on the comparison.
+ */
+const char* OUI::vendor(const MACAddress& mac) {
+  std::vector<uint8_t> octets = mac.address();
+  if (octets.size() < 3) return "";
+  if ((octets[0] & kLocalBit) != 0) return ipf::kRandomVendor;
+  uint32_t prefix = static_cast<uint32_t>(octets[0]) << 16 |
+                    static_cast<uint32_t>(octets[1]) << 8 | octets[2];
+  const Entry* base = kEntries;
+  size_t n = kSize;
+  while (n > 1) {
+    size_t half = n / 2;
+    base = (base[half].prefix <= prefix) ? base + half : base;
+    n -= half;
+  }
+  return (base->prefix == prefix) ? base->vendor : "";
+}
+
+size_t OUI::size() {
+  return kSize;
+}
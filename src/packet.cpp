@@ -99,6 +99,13 @@ Packet::Packet(const uint8_t * p) {
   }
 }
 
+Packet::Packet(const struct pcap_pkthdr& header, const uint8_t* data)
+    : Packet(data) {
+  time_ = static_cast<int64_t>(header.ts.tv_sec) * 1000000 +
+          header.ts.tv_usec;
+  length_ = header.len;
+}
+
 MACAddress Packet::mac_src() const { return mac_src_; }
 
 MACAddress Packet::mac_dst() const { return mac_dst_; }
@@ -113,6 +120,10 @@ IPv6Address Packet::ipv6_src() const { return ipv6_src_; }
 
 IPv6Address Packet::ipv6_dst() const { return ipv6_dst_; }
 
+int64_t Packet::time() const { return time_; }
+
+uint32_t Packet::length() const { return length_; }
+
 bool Packet::ipv4() const { return (ether_type_ == ipf::kEtherTypeIPv4); }
 
 bool Packet::ipv6() const { return (ether_type_ == ipf::kEtherTypeIPv6); }
@@ -0,0 +1,329 @@
+/**
+ *  @file pcapfile.cpp
+ *  @brief PcapFile class implementation
+ */
+
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014 Michael Maraya
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#ifdef __linux__
+#include <sys/inotify.h>
+#endif
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "ipforensics/ip4and6.h"
+#include "ipforensics/pcapfile.h"
+
+PcapFile::PcapFile(const std::string name) {
+  name_ = name;
+}
+
+PcapFile::~PcapFile() {
+  close();
+}
+
+std::string PcapFile::name() const {
+  return name_;
+}
+
+uint32_t PcapFile::link_type() const {
+  return link_type_;
+}
+
+uint64_t PcapFile::offset() const {
+  return offset_;
+}
+
+PcapFile::Mode PcapFile::mode() const {
+  return mode_;
+}
+
+/**
+ *  @details The buffer is over-allocated by ipf::kDirectAlignment so that an
+ *           aligned start can always be found for O_DIRECT reads.
+ */
+uint8_t* PcapFile::base() {
+  uintptr_t p = reinterpret_cast<uintptr_t>(buffer_.data());
+  p = (p + ipf::kDirectAlignment - 1) & ~(ipf::kDirectAlignment - 1);
+  return reinterpret_cast<uint8_t*>(p);
+}
+
+/**
+ *  @details In Mode::kDirect the file is also opened with O_DIRECT.  File
+ *           systems that refuse O_DIRECT (tmpfs, for example) fall back to
+ *           Mode::kHeaders.  Mode::kRing falls back to Mode::kStream if 
+ *           io_uring is not available.  The access pattern is passed on to 
+ *           the kernel with posix_fadvise: sequential for whole records, 
+ *           random when skipping payloads so read-ahead does not bring the 
+ *           skipped bytes in anyway.
+ */
+void PcapFile::set_mode(Mode mode) {
+  mode_ = mode;
+#ifdef O_DIRECT
+  if (mode_ == Mode::kDirect && fd_ >= 0 && direct_fd_ < 0) {
+    direct_fd_ = ::open(name_.c_str(), O_RDONLY | O_DIRECT);
+    if (direct_fd_ < 0) mode_ = Mode::kHeaders;
+  }
+#else
+  if (mode_ == Mode::kDirect) mode_ = Mode::kHeaders;
+#endif
+  if (mode_ != Mode::kDirect && direct_fd_ >= 0) {
+    ::close(direct_fd_);
+    direct_fd_ = -1;
+  }
+  if (mode_ == Mode::kRing && fd_ >= 0 && !ring_) {
+    ring_.reset(new RingReader(fd_));
+    if (!ring_->available()) mode_ = Mode::kStream;
+  }
+  if (mode_ != Mode::kRing) ring_.reset();
+  if (fd_ >= 0) {
+#ifdef POSIX_FADV_SEQUENTIAL
+    posix_fadvise(fd_, 0, 0, (mode_ == Mode::kHeaders) ? POSIX_FADV_RANDOM :
+                  POSIX_FADV_SEQUENTIAL);
+#endif
+    buffer_.resize(((mode_ == Mode::kHeaders) ? ipf::kHeaderReadSize :
+                    ipf::kReadBufferSize) + ipf::kDirectAlignment);
+    buffer_length_ = 0;
+  }
+}
+
+/**
+ *  @details The magic number in the first four bytes identifies both the byte
+ *           order of the writer and the timestamp resolution.
+ */
+bool PcapFile::open() {
+  if (fd_ < 0) {
+    fd_ = ::open(name_.c_str(), O_RDONLY);
+    if (fd_ < 0 && errno == ENOENT) return false;
+    if (fd_ < 0) {
+      throw std::runtime_error(name_ + ": " + strerror(errno));
+    }
+    set_mode(mode_);
+  }
+  buffer_length_ = 0;
+  if (!fill(0, ipf::kPcapFileHeaderLength)) return false;
+  const uint8_t* p = window_ + (0 - buffer_offset_);
+  uint32_t magic = static_cast<uint32_t>(p[0] | p[1] << 8 | p[2] << 16 |
+                                         static_cast<uint32_t>(p[3]) << 24);
+  switch (magic) {
+    case ipf::kPcapMagic:
+      swap_ = false;
+      nano_ = false;
+      break;
+    case ipf::kPcapMagicNano:
+      swap_ = false;
+      nano_ = true;
+      break;
+    case __builtin_bswap32(ipf::kPcapMagic):
+      swap_ = true;
+      nano_ = false;
+      break;
+    case __builtin_bswap32(ipf::kPcapMagicNano):
+      swap_ = true;
+      nano_ = true;
+      break;
+    default:
+      close();
+      throw std::runtime_error(name_ + ": not a libpcap-format file");
+  }
+  link_type_ = field(p + 20);
+  if (offset_ < ipf::kPcapFileHeaderLength) {
+    offset_ = ipf::kPcapFileHeaderLength;
+  }
+  return true;
+}
+
+void PcapFile::close() {
+  ring_.reset();
+  if (fd_ >= 0) ::close(fd_);
+  if (direct_fd_ >= 0) ::close(direct_fd_);
+  if (notify_ >= 0) ::close(notify_);
+  fd_ = -1;
+  direct_fd_ = -1;
+  notify_ = -1;
+  buffer_length_ = 0;
+}
+
+void PcapFile::seek(uint64_t offset) {
+  offset_ = offset;
+}
+
+uint32_t PcapFile::field(const uint8_t* p) const {
+  uint32_t value = static_cast<uint32_t>(p[0] | p[1] << 8 | p[2] << 16 |
+                                         static_cast<uint32_t>(p[3]) << 24);
+  return swap_ ? __builtin_bswap32(value) : value;
+}
+
+/**
+ *  @details Bytes already in the buffer are reused when the requested range
+ *           overlaps it.  In Mode::kRing the range comes from the RingReader.
+ *           Otherwise the buffer is refilled with pread starting at the 
+ *           requested offset, so a record that was cut short by the 
+ *           writer is simply read again once the rest of it has arrived.  
+ *           O_DIRECT reads start at the aligned offset at or before the 
+ *           requested one and always read whole aligned blocks.
+ */
+bool PcapFile::fill(uint64_t offset, size_t length) {
+  if (offset >= buffer_offset_ &&
+      offset + length <= buffer_offset_ + buffer_length_) {
+    return true;
+  }
+  if (mode_ == Mode::kRing) {
+    window_ = ring_->data(offset, length);
+    buffer_offset_ = offset;
+    buffer_length_ = (window_ == nullptr) ? 0 : length;
+    return (window_ != nullptr);
+  }
+  int fd = fd_;
+  uint64_t start = offset;
+  size_t size = buffer_.size() - ipf::kDirectAlignment;
+  if (mode_ == Mode::kDirect) {
+    fd = direct_fd_;
+    start = offset & ~static_cast<uint64_t>(ipf::kDirectAlignment - 1);
+  }
+  if (length + (offset - start) > size) {
+    size = (length + (offset - start) + ipf::kDirectAlignment - 1) &
+           ~(ipf::kDirectAlignment - 1);
+    buffer_.resize(size + ipf::kDirectAlignment);
+  }
+  buffer_offset_ = start;
+  buffer_length_ = 0;
+  window_ = base();
+  while (buffer_length_ < size) {
+    ssize_t n = pread(fd, base() + buffer_length_, size - buffer_length_,
+                      static_cast<off_t>(start + buffer_length_));
+    if (n < 0 && errno == EINTR) continue;
+    if (n < 0) throw std::runtime_error(name_ + ": " + strerror(errno));
+    if (n == 0) break;
+    buffer_length_ += static_cast<size_t>(n);
+    // a short O_DIRECT read means the end of the file was reached
+    if (mode_ == Mode::kDirect && buffer_length_ % ipf::kDirectAlignment) break;
+  }
+  return (offset + length <= start + buffer_length_);
+}
+
+/**
+ *  @details In Mode::kHeaders only the record header and the first 
+ *           ipf::kDecodeLength bytes are read and the rest of the record is 
+ *           skipped by advancing the offset.  Since the skipped bytes are never
+ *           read, the file size tells us whether the record is complete.
+ *           Pages behind the read position are dropped from the page cache 
+ *           every ipf::kReadBufferSize bytes so large scans do not evict more 
+ *           useful data.
+ */
+bool PcapFile::next(struct pcap_pkthdr* header, const uint8_t** data) {
+  if (!fill(offset_, ipf::kPcapRecordHeaderLength)) return false;
+  const uint8_t* p = window_ + (offset_ - buffer_offset_);
+  uint32_t caplen = field(p + 8);
+  if (caplen > ipf::kMaxSnapLength) {
+    throw std::runtime_error(name_ + ": corrupt record header at offset " +
+                             std::to_string(offset_));
+  }
+  uint64_t end = offset_ + ipf::kPcapRecordHeaderLength + caplen;
+  uint32_t length = caplen;
+  if (mode_ == Mode::kHeaders) {
+    if (end > size_) {
+      struct stat st;
+      if (fstat(fd_, &st) != 0) {
+        throw std::runtime_error(name_ + ": " + strerror(errno));
+      }
+      size_ = static_cast<uint64_t>(st.st_size);
+      if (end > size_) return false;
+    }
+    length = std::min(caplen, ipf::kDecodeLength);
+  }
+  if (!fill(offset_, ipf::kPcapRecordHeaderLength + length)) return false;
+  p = window_ + (offset_ - buffer_offset_);
+  header->ts.tv_sec = field(p);
+  header->ts.tv_usec = field(p + 4) / (nano_ ? 1000 : 1);
+  header->caplen = caplen;
+  header->len = field(p + 12);
+  *data = p + ipf::kPcapRecordHeaderLength;
+  // Packet always decodes the first ipf::kDecodeLength bytes
+  if (caplen < ipf::kDecodeLength) {
+    scratch_.assign(ipf::kDecodeLength, 0);
+    std::memcpy(&scratch_[0], *data, caplen);
+    *data = &scratch_[0];
+  }
+  offset_ = end;
+#ifdef POSIX_FADV_DONTNEED
+  if (offset_ - advised_ >= ipf::kReadBufferSize) {
+    posix_fadvise(fd_, static_cast<off_t>(advised_),
+                  static_cast<off_t>(offset_ - advised_), POSIX_FADV_DONTNEED);
+    advised_ = offset_;
+  }
+#endif
+  return true;
+}
+
+/**
+ *  @details The directory is watched rather than the file itself so that the
+ *           creation of the next file in a rotation also ends the wait.
+ */
+void PcapFile::wait(int timeout) {
+#ifdef __linux__
+  if (notify_ < 0) {
+    notify_ = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    size_t slash = name_.rfind('/');
+    std::string dir = (slash == std::string::npos) ? "." :
+                      name_.substr(0, slash + 1);
+    if (notify_ >= 0 &&
+        inotify_add_watch(notify_, dir.c_str(), IN_MODIFY | IN_CREATE |
+                          IN_MOVED_TO | IN_CLOSE_WRITE) < 0) {
+      ::close(notify_);
+      notify_ = -1;
+    }
+  }
+  if (notify_ >= 0) {
+    struct pollfd pfd = {notify_, POLLIN, 0};
+    if (poll(&pfd, 1, timeout) > 0) {
+      char events[4096];
+      while (read(notify_, events, sizeof(events)) > 0) {}
+    }
+    return;
+  }
+#endif
+  usleep(static_cast<useconds_t>(timeout) * 1000);
+}
+
+std::string PcapFile::rotation(const std::string& name) {
+  size_t digits = name.size();
+  while (digits > 0 && isdigit(name[digits - 1])) --digits;
+  if (digits == name.size()) return name + "1";
+  std::string number = name.substr(digits);
+  std::string next = std::to_string(std::stoull(number) + 1);
+  if (next.size() < number.size()) {
+    next.insert(0, number.size() - next.size(), '0');
+  }
+  return name.substr(0, digits) + next;
+}
@@ -0,0 +1,136 @@
+/**
+ *  @file prefixtrie.cpp
+ *  @brief PrefixTrie class implementation
+ */
+
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014 Michael Maraya
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <algorithm>
+#include <vector>
+#include "ipforensics/prefixtrie.h"
+
+PrefixTrie::PrefixTrie() {
+  add_node(Key {}, 0, false);
+}
+
+size_t PrefixTrie::size() const {
+  return size_;
+}
+
+bool PrefixTrie::empty() const {
+  return size_ == 0;
+}
+
+int PrefixTrie::bit(const Key& key, int i) {
+  return (key[static_cast<size_t>(i / 8)] >> (7 - i % 8)) & 1;
+}
+
+int PrefixTrie::common(const Key& a, const Key& b, int limit) {
+  int bits = 0;
+  for (size_t i = 0; i < a.size() && bits < limit; ++i) {
+    uint8_t diff = a[i] ^ b[i];
+    if (diff == 0) {
+      bits += 8;
+      continue;
+    }
+    while ((diff & 0x80) == 0) {
+      ++bits;
+      diff = static_cast<uint8_t>(diff << 1);
+    }
+    break;
+  }
+  return std::min(bits, limit);
+}
+
+PrefixTrie::Key PrefixTrie::truncate(Key key, int length) {
+  for (size_t i = 0; i < key.size(); ++i) {
+    int keep = length - static_cast<int>(i) * 8;
+    if (keep >= 8) continue;
+    key[i] &= (keep <= 0) ? 0 : static_cast<uint8_t>(0xFF << (8 - keep));
+  }
+  return key;
+}
+
+int32_t PrefixTrie::add_node(const Key& key, int length, bool prefix) {
+  Node node;
+  node.key = truncate(key, length);
+  node.length = length;
+  node.prefix = prefix;
+  node.child[0] = node.child[1] = -1;
+  nodes_.push_back(node);
+  return static_cast<int32_t>(nodes_.size() - 1);
+}
+
+/**
+ *  @details Walks down while the new prefix extends the current node.  If it
+ *           diverges from a child part-way along the child's compressed path,
+ *           a branch node is inserted at the point of divergence.
+ */
+void PrefixTrie::insert(const Key& key, int length) {
+  length = std::max(0, std::min(length, 128));
+  int32_t n = 0;
+  while (true) {
+    if (nodes_[n].length == length) {
+      if (!nodes_[n].prefix) ++size_;
+      nodes_[n].prefix = true;
+      return;
+    }
+    int b = bit(key, nodes_[n].length);
+    int32_t c = nodes_[n].child[b];
+    if (c < 0) {
+      int32_t leaf = add_node(key, length, true);
+      nodes_[n].child[b] = leaf;
+      ++size_;
+      return;
+    }
+    int shared = common(key, nodes_[c].key, std::min(length, nodes_[c].length));
+    if (shared == nodes_[c].length) {
+      n = c;
+      continue;
+    }
+    int32_t branch = add_node(key, shared, shared == length);
+    nodes_[branch].child[bit(nodes_[c].key, shared)] = c;
+    if (shared < length) {
+      int32_t leaf = add_node(key, length, true);
+      nodes_[branch].child[bit(key, shared)] = leaf;
+    }
+    nodes_[n].child[b] = branch;
+    ++size_;
+    return;
+  }
+}
+
+bool PrefixTrie::contains(const Key& key, int bits) const {
+  int32_t n = 0;
+  while (n >= 0) {
+    const Node& node = nodes_[n];
+    if (node.length > bits) return false;
+    if (common(key, node.key, node.length) < node.length) return false;
+    if (node.prefix) return true;
+    if (node.length == bits) return false;
+    n = node.child[bit(key, node.length)];
+  }
+  return false;
+}
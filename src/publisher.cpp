@@ -0,0 +1,153 @@
+/**
+ *  @file publisher.cpp
+ *  @brief Publisher class implementation
+ */
+
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014 Michael Maraya
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <sys/wait.h>
+#include <unistd.h>
+#include <cerrno>
+#include <chrono>  // NOLINT
+#include <csignal>
+#include <iostream>  // NOLINT
+#include "ipforensics/publisher.h"
+
+namespace {
+
+/** Set by the SIGHUP handler to ask for a write at the next poll */
+volatile sig_atomic_t hangup {0};
+
+void request_write(int) {
+  hangup = 1;
+}
+
+}  // namespace
+
+/**
+ *  @details The first write is due one interval after construction.
+ */
+Publisher::Publisher(IPForensics* ip, int interval) {
+  ip_ = ip;
+  interval_ = interval;
+  due_ = std::chrono::steady_clock::now() + std::chrono::seconds(interval);
+  hangup = 0;
+  std::signal(SIGHUP, request_write);
+}
+
+Publisher::~Publisher() {
+  finish();
+  std::signal(SIGHUP, SIG_DFL);
+}
+
+int Publisher::interval() const {
+  return interval_;
+}
+
+uint64_t Publisher::written() const {
+  return written_;
+}
+
+uint64_t Publisher::failed() const {
+  return failed_;
+}
+
+bool Publisher::busy() {
+  if (child_ < 0) return false;
+  int status {0};
+  pid_t pid = waitpid(child_, &status, WNOHANG);
+  if (pid == 0) return true;
+  if (pid == child_ && WIFEXITED(status) && WEXITSTATUS(status) == 0) {
+    ++written_;
+  } else {
+    ++failed_;
+  }
+  child_ = -1;
+  return false;
+}
+
+void Publisher::poll() {
+  if (hangup) {
+    hangup = 0;
+    requested_ = true;
+  }
+  std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+  if (interval_ > 0 && now >= due_) {
+    requested_ = true;
+  }
+  if (!requested_ || busy()) return;
+  requested_ = false;
+  due_ = now + std::chrono::seconds(interval_);
+  start();
+}
+
+void Publisher::finish() {
+  while (child_ >= 0) {
+    int status {0};
+    pid_t pid = waitpid(child_, &status, 0);
+    if (pid < 0 && errno == EINTR) continue;
+    if (pid == child_ && WIFEXITED(status) && WEXITSTATUS(status) == 0) {
+      ++written_;
+    } else {
+      ++failed_;
+    }
+    child_ = -1;
+  }
+}
+
+/**
+ *  @details Every write is a full snapshot, so the parent stops tracking
+ *           changes for the delta log and forgets the snapshot it was based 
+ *           on, which makes its own final save a full one too.  The child
+ *           cleans its copy of the host table exactly as the end of a capture
+ *           would before writing it, and leaves with _exit() so nothing of the
+ *           parent's, such as buffered output or the capture handle, is 
+ *           flushed or closed twice.
+ */
+void Publisher::start() {
+  ip_->clear_changes();
+  ip_->journal_.reset();
+  std::cout.flush();
+  pid_t pid = fork();
+  if (pid < 0) {
+    ++failed_;
+    std::cout << ipf::kProgramName << ": Could not start background write";
+    std::cout << std::endl;
+    return;
+  }
+  if (pid == 0) {
+    int status {0};
+    try {
+      ip_->clean_hosts();
+      ip_->results();
+    } catch (std::exception const &e) {
+      std::cout << ipf::kProgramName << ": " << e.what() << std::endl;
+      status = 1;
+    }
+    std::cout.flush();
+    _exit(status);
+  }
+  child_ = pid;
+}
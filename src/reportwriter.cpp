@@ -0,0 +1,772 @@
+/**
+ *  @file reportwriter.cpp
+ *  @brief ReportWriter class hierarchy implementation
+ */
+
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014 Michael Maraya
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <fcntl.h>
+#include <limits.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <time.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <iostream>  // NOLINT we only flush std::cout before writing to it
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include "ipforensics/ip4and6.h"
+#include "ipforensics/oui.h"
+#include "ipforensics/reportwriter.h"
+#include "ipforensics/snapshot.h"
+#include "ipforensics/threads.h"
+
+namespace {
+
+/** longest text of a 64-bit number */
+const size_t kLengthNumber {20};
+
+/** longest text of a report time */
+const size_t kLengthTime {20};
+
+/**
+ *  @brief Writes a number in decimal
+ *  @param value number to write
+ *  @param out buffer with room for kLengthNumber characters
+ *  @retval char* end of the text written
+ */
+char* decimal(uint64_t value, char* out) {
+  char digits[kLengthNumber];
+  char* p = digits + sizeof(digits);
+  do {
+    *--p = static_cast<char>('0' + value % 10);
+    value /= 10;
+  } while (value > 0);
+  size_t length = static_cast<size_t>(digits + sizeof(digits) - p);
+  std::memcpy(out, p, length);
+  return out + length;
+}
+
+/**
+ *  @brief Writes two decimal digits
+ *  @param value number below 100
+ *  @param out buffer with room for 2 characters
+ *  @retval char* end of the text written
+ */
+char* two_digits(int value, char* out) {
+  *out++ = static_cast<char>('0' + value / 10);
+  *out++ = static_cast<char>('0' + value % 10);
+  return out;
+}
+
+/**
+ *  @brief Writes a time as utc_time() does
+ *  @param time microseconds since the Unix epoch, 0 if unknown
+ *  @param out buffer with room for kLengthTime characters
+ *  @retval char* end of the text written, out if the time is unknown
+ */
+char* utc(int64_t time, char* out) {
+  time_t seconds = static_cast<time_t>(time / 1000000);
+  struct tm t;
+  if (time == 0 || gmtime_r(&seconds, &t) == nullptr) return out;
+  int year = t.tm_year + 1900;
+  if (year < 0 || year > 9999) {
+    std::string text = utc_time(time);
+    std::memcpy(out, text.data(), std::min(text.size(), kLengthTime));
+    return out + std::min(text.size(), kLengthTime);
+  }
+  out = two_digits(year / 100, out);
+  out = two_digits(year % 100, out);
+  *out++ = '-';
+  out = two_digits(t.tm_mon + 1, out);
+  *out++ = '-';
+  out = two_digits(t.tm_mday, out);
+  *out++ = 'T';
+  out = two_digits(t.tm_hour, out);
+  *out++ = ':';
+  out = two_digits(t.tm_min, out);
+  *out++ = ':';
+  out = two_digits(t.tm_sec, out);
+  *out++ = 'Z';
+  return out;
+}
+
+/**
+ *  @brief Pads a left-aligned column with spaces
+ *  @param start start of the column
+ *  @param end end of the text in the column
+ *  @param width width of the column
+ *  @retval char* end of the column
+ */
+char* pad(char* start, char* end, size_t width) {
+  while (static_cast<size_t>(end - start) < width) *end++ = ' ';
+  return end;
+}
+
+/**
+ *  @brief Copies a string without its terminating null
+ *  @param text string to copy
+ *  @param out buffer with room for the string
+ *  @retval char* end of the text written
+ */
+char* append(const char* text, char* out) {
+  size_t length = std::strlen(text);
+  std::memcpy(out, text, length);
+  return out + length;
+}
+
+/**
+ *  @brief Writes a number right-aligned in a column
+ *  @param value number to write
+ *  @param width width of the column
+ *  @param out buffer with room for the column and kLengthNumber characters
+ *  @retval char* end of the column
+ */
+char* right(uint64_t value, size_t width, char* out) {
+  char digits[kLengthNumber];
+  size_t length = static_cast<size_t>(decimal(value, digits) - digits);
+  while (length < width--) *out++ = ' ';
+  std::memcpy(out, digits, length);
+  return out + length;
+}
+
+/**
+ *  @brief Unpacks an IPv4 address packed by Host::pack(const IPv4Address&)
+ *  @param packed packed address
+ *  @param octets receives the 4 octets
+ */
+void unpack(Host::PackedIPv4 packed, uint8_t* octets) {
+  for (size_t i = 0; i < ipf::kLengthIPv4; ++i) {
+    octets[i] = static_cast<uint8_t>(packed >> (8 * i));
+  }
+}
+
+/**
+ *  @brief Writes a string as a JSON string
+ *  @param text string to write
+ *  @param out buffer with room for 6 characters per character of text and 2
+ *  @retval char* end of the text written
+ */
+char* json(const char* text, char* out) {
+  *out++ = '"';
+  for (; *text != '\0'; ++text) {
+    unsigned char c = static_cast<unsigned char>(*text);
+    if (c == '"' || c == '\\') {
+      *out++ = '\\';
+      *out++ = static_cast<char>(c);
+    } else if (c < 0x20) {
+      out += std::sprintf(out, "\\u%04x", c);
+    } else {
+      *out++ = static_cast<char>(c);
+    }
+  }
+  *out++ = '"';
+  return out;
+}
+
+/**
+ *  @brief Writes a string as a CSV field, quoted only if it has to be
+ *  @param text string to write
+ *  @param out buffer with room for 2 characters per character of text and 2
+ *  @retval char* end of the text written
+ */
+char* csv(const char* text, char* out) {
+  if (std::strpbrk(text, ",\"\r\n") == nullptr) return append(text, out);
+  *out++ = '"';
+  for (; *text != '\0'; ++text) {
+    if (*text == '"') *out++ = '"';
+    *out++ = *text;
+  }
+  *out++ = '"';
+  return out;
+}
+
+/**
+ *  @brief Writes a JSON member holding an address, or null if it is empty
+ *  @tparam T MACAddress, IPv4Address or IPv6Address
+ *  @param name start of the member up to and including the colon
+ *  @param address address to write
+ *  @param out buffer with room for the member
+ *  @retval char* end of the text written
+ */
+template <typename T>
+char* member(const char* name, const T& address, char* out) {
+  out = append(name, out);
+  if (address.empty()) return append("null", out);
+  *out++ = '"';
+  out = address.format(out);
+  *out++ = '"';
+  return out;
+}
+
+/**
+ *  @brief Writes a JSON member holding a time, or null if it is unknown
+ *  @param name start of the member up to and including the colon
+ *  @param time microseconds since the Unix epoch, 0 if unknown
+ *  @param out buffer with room for the member
+ *  @retval char* end of the text written
+ */
+char* time_member(const char* name, int64_t time, char* out) {
+  out = append(name, out);
+  char* start = out;
+  out = utc(time, out + 1);
+  if (out == start + 1) return append("null", start);
+  *start = '"';
+  *out++ = '"';
+  return out;
+}
+
+/**
+ *  @brief Finds the next secondary IPv4 address of a host
+ *  @param host Host to search
+ *  @param i position in Host::packed_ipv4s() to start at
+ *  @retval size_t position of the address, or the size of the set if none
+ */
+size_t next_ipv4(const Host& host, size_t i) {
+  const AddressSet<Host::PackedIPv4, Host::kInlineIPv4>& all =
+      host.packed_ipv4s();
+  if (host.ipv4().empty()) return i;
+  Host::PackedIPv4 primary = Host::pack(host.ipv4());
+  while (i < all.size() && all[i] == primary) ++i;
+  return i;
+}
+
+/**
+ *  @brief Finds the next secondary IPv6 address of a host
+ *  @param host Host to search
+ *  @param i position in Host::packed_ipv6s() to start at
+ *  @retval size_t position of the address, or the size of the set if none
+ */
+size_t next_ipv6(const Host& host, size_t i) {
+  const AddressSet<Host::PackedIPv6, Host::kInlineIPv6>& all =
+      host.packed_ipv6s();
+  if (host.ipv6().empty()) return i;
+  Host::PackedIPv6 primary = Host::pack(host.ipv6());
+  while (i < all.size() && all[i] == primary) ++i;
+  return i;
+}
+
+/**
+ *  @brief Writes the secondary IPv4 addresses of a host, in the order first
+ *         seen
+ *  @param host Host whose addresses to write
+ *  @param separator written between addresses
+ *  @param quote written around each address, or '\0' for none
+ *  @param out buffer with room for all the addresses
+ *  @retval char* end of the text written
+ */
+char* ipv4_aliases(const Host& host, char separator, char quote, char* out) {
+  const AddressSet<Host::PackedIPv4, Host::kInlineIPv4>& all =
+      host.packed_ipv4s();
+  char* start = out;
+  for (size_t i = next_ipv4(host, 0); i < all.size();
+       i = next_ipv4(host, i + 1)) {
+    if (out != start) *out++ = separator;
+    if (quote != '\0') *out++ = quote;
+    uint8_t octets[ipf::kLengthIPv4];
+    unpack(all[i], octets);
+    out = IPv4Address::format(octets, out);
+    if (quote != '\0') *out++ = quote;
+  }
+  return out;
+}
+
+/**
+ *  @brief Writes the secondary IPv6 addresses of a host, in the order first
+ *         seen
+ *  @param host Host whose addresses to write
+ *  @param separator written between addresses
+ *  @param quote written around each address, or '\0' for none
+ *  @param out buffer with room for all the addresses
+ *  @retval char* end of the text written
+ */
+char* ipv6_aliases(const Host& host, char separator, char quote, char* out) {
+  const AddressSet<Host::PackedIPv6, Host::kInlineIPv6>& all =
+      host.packed_ipv6s();
+  char* start = out;
+  for (size_t i = next_ipv6(host, 0); i < all.size();
+       i = next_ipv6(host, i + 1)) {
+    if (out != start) *out++ = separator;
+    if (quote != '\0') *out++ = quote;
+    out = IPv6Address::format(all[i].data(), out);
+    if (quote != '\0') *out++ = quote;
+  }
+  return out;
+}
+
+/**
+ *  @brief Writes the summary counts as a JSON object
+ *  @param summary host counts
+ *  @param out buffer with room for the object
+ *  @retval char* end of the text written
+ */
+char* counts(const ReportWriter::Summary& summary, char* out) {
+  out = append("{\"hosts\":", out);
+  out = decimal(summary.hosts, out);
+  out = append(",\"ipv4_only\":", out);
+  out = decimal(summary.ipv4, out);
+  out = append(",\"ipv6_only\":", out);
+  out = decimal(summary.ipv6, out);
+  out = append(",\"dual_stack\":", out);
+  out = decimal(summary.dual, out);
+  out = append(",\"excluded\":", out);
+  out = decimal(summary.excluded, out);
+  out = append(",\"fake\":", out);
+  out = decimal(summary.fake, out);
+  *out++ = '}';
+  return out;
+}
+
+}  // namespace
+
+ReportWriter::ReportWriter(bool vendors) {
+  vendors_ = vendors;
+  buffer_.resize(ipf::kReportBufferSize);
+}
+
+ReportWriter::~ReportWriter() {
+  if (fd_ > STDOUT_FILENO) {
+    ::close(fd_);
+    if (!temp_.empty()) std::remove(temp_.c_str());
+  }
+}
+
+/**
+ *  @details Enough for the longest row, every alias row or list entry, and 
+ *           the vendor with every character escaped.
+ */
+size_t ReportWriter::bound(const Host& host, const char* vendor) {
+  size_t addresses = host.packed_ipv4s().size() + host.packed_ipv6s().size();
+  return 256 + addresses * 80 + std::strlen(vendor) * 6;
+}
+
+/**
+ *  @details A part() writer has no output, so its buffer grows to hold its 
+ *           whole share of the hosts.
+ */
+char* ReportWriter::reserve(size_t size) {
+  if (buffer_.size() - used_ < size) {
+    if (fd_ >= 0) flush();
+    if (buffer_.size() - used_ < size) {
+      buffer_.resize(std::max(buffer_.size() * 2, used_ + size));
+    }
+  }
+  return buffer_.data() + used_;
+}
+
+void ReportWriter::commit(const char* end) {
+  used_ = static_cast<size_t>(end - buffer_.data());
+}
+
+void ReportWriter::flush() {
+  if (used_ == 0) return;
+  if (!Snapshot::write(fd_, buffer_.data(), used_)) {
+    throw std::runtime_error("Could not write to output file " +
+                             (filename_.empty() ? "(stdout)" : filename_));
+  }
+  used_ = 0;
+}
+
+/**
+ *  @details Anything already sent to std::cout is flushed first so it stays
+ *           ahead of the report.  A regular file is written as filename.tmp 
+ *           and renamed over filename by close(), so readers only ever see a
+ *           whole report; anything else, such as a pipe or a device, is 
+ *           written in place.
+ */
+void ReportWriter::open(const std::string& filename) {
+  filename_ = filename;
+  temp_.clear();
+  used_ = 0;
+  if (filename.empty()) {
+    std::cout.flush();
+    fd_ = STDOUT_FILENO;
+    return;
+  }
+  struct stat st;
+  if (stat(filename.c_str(), &st) != 0 || S_ISREG(st.st_mode)) {
+    temp_ = filename + ".tmp";
+  }
+  const std::string& name = temp_.empty() ? filename : temp_;
+  fd_ = ::open(name.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+  if (fd_ < 0) {
+    throw std::runtime_error("Could not open output file " + name);
+  }
+}
+
+/**
+ *  @details The temporary file is flushed to disk before it is renamed, so a
+ *           crash leaves either the old report or the new one.
+ */
+void ReportWriter::close() {
+  flush();
+  int fd = fd_;
+  fd_ = -1;
+  if (fd <= STDOUT_FILENO) return;
+  bool ok = temp_.empty() || fsync(fd) == 0;
+  ok = ::close(fd) == 0 && ok;
+  if (!temp_.empty()) {
+    ok = ok && std::rename(temp_.c_str(), filename_.c_str()) == 0;
+    if (!ok) std::remove(temp_.c_str());
+    temp_.clear();
+  }
+  if (!ok) {
+    throw std::runtime_error("Could not write to output file " + filename_);
+  }
+}
+
+void ReportWriter::text(const std::string&) {
+}
+
+/**
+ *  @details Small reports are formatted straight into the output buffer.  
+ *           Larger ones are formatted in rounds of ipf::kReportChunkHosts 
+ *           hosts per thread, each thread filling its own part() writer, and
+ *           the parts are written in host order with writev(2), so the output
+ *           is exactly what host() would give and only one round is held in 
+ *           memory.  The first host is always written here, so every part 
+ *           starts in the state of a writer that has written hosts.
+ */
+void ReportWriter::hosts(const std::vector<const Host*>& hosts,
+                         const Activity* activities, size_t threads) {
+  if (threads < 2 || hosts.size() < ipf::kParallelReportHosts) {
+    for (const Host* h : hosts) {
+      host(*h, activities[h->slot()]);
+    }
+    return;
+  }
+  host(*hosts[0], activities[hosts[0]->slot()]);
+  std::vector<std::unique_ptr<ReportWriter>> parts;
+  for (size_t t = 0; t < threads; ++t) {
+    parts.push_back(part());
+  }
+  std::vector<struct iovec> iov;
+  for (size_t start = 1; start < hosts.size();
+       start += threads * ipf::kReportChunkHosts) {
+    size_t chunks = (hosts.size() - start + ipf::kReportChunkHosts - 1) /
+                    ipf::kReportChunkHosts;
+    run_threads(std::min(threads, chunks), [&](size_t t) {
+      ReportWriter& p = *parts[t];
+      p.used_ = 0;
+      size_t first = start + t * ipf::kReportChunkHosts;
+      size_t last = std::min(first + ipf::kReportChunkHosts, hosts.size());
+      for (size_t i = first; i < last; ++i) {
+        p.host(*hosts[i], activities[hosts[i]->slot()]);
+      }
+    });
+    flush();
+    iov.clear();
+    for (size_t t = 0; t < std::min(threads, chunks); ++t) {
+      iov.push_back({parts[t]->buffer_.data(), parts[t]->used_});
+    }
+    size_t next = 0;
+    while (next < iov.size()) {
+      int count = static_cast<int>(std::min<size_t>(iov.size() - next,
+                                                    IOV_MAX));
+      ssize_t n = ::writev(fd_, &iov[next], count);
+      if (n < 0 && errno == EINTR) continue;
+      if (n <= 0) {
+        throw std::runtime_error("Could not write to output file " +
+                                 (filename_.empty() ? "(stdout)" : filename_));
+      }
+      size_t left = static_cast<size_t>(n);
+      while (next < iov.size() && left >= iov[next].iov_len) {
+        left -= iov[next++].iov_len;
+      }
+      if (left > 0) {
+        iov[next].iov_base = static_cast<char*>(iov[next].iov_base) + left;
+        iov[next].iov_len -= left;
+      }
+    }
+  }
+}
+
+ReportWriter::Format ReportWriter::format(const std::string& name) {
+  if (name == "table") return Format::kTable;
+  if (name == "csv") return Format::kCSV;
+  if (name == "ndjson") return Format::kNDJSON;
+  if (name == "json") return Format::kJSON;
+  throw std::invalid_argument("unknown report format " + name);
+}
+
+ReportWriter::Order ReportWriter::order(const std::string& name) {
+  if (name == "mac") return Order::kMAC;
+  if (name == "ipv4") return Order::kIPv4;
+  if (name == "ipv6") return Order::kIPv6;
+  throw std::invalid_argument("unknown sort order " + name);
+}
+
+std::unique_ptr<ReportWriter> ReportWriter::create(Format format,
+                                                   bool vendors) {
+  switch (format) {
+    case Format::kCSV:
+      return std::unique_ptr<ReportWriter>(new CSVWriter(vendors));
+    case Format::kNDJSON:
+      return std::unique_ptr<ReportWriter>(new NDJSONWriter(vendors));
+    case Format::kJSON:
+      return std::unique_ptr<ReportWriter>(new JSONWriter(vendors));
+    default:
+      return std::unique_ptr<ReportWriter>(new TableWriter(vendors));
+  }
+}
+
+std::unique_ptr<ReportWriter> TableWriter::part() const {
+  return std::unique_ptr<ReportWriter>(new TableWriter(vendors_));
+}
+
+void TableWriter::begin() {
+  if (vendors_) {
+    text(ipf::kVendorHeader1 + '\n' + ipf::kVendorHeader2 + '\n');
+  } else {
+    text(ipf::kHeader1 + '\n' + ipf::kHeader2 + '\n');
+  }
+}
+
+/**
+ *  @details The columns have the widths of the report columns, and each 
+ *           alias row pairs the next secondary IPv4 and IPv6 addresses as 
+ *           Host::aliases() does.
+ */
+void TableWriter::host(const Host& host, const Activity& activity) {
+  const char* vendor = vendors_ ? OUI::vendor(host.mac()) : "";
+  char* out = reserve(bound(host, vendor));
+  char* start = out;
+  out = pad(start, host.mac().format(out), ipf::kOutputOffsetIPv4);
+  start = out;
+  out = pad(start, host.ipv4().format(out),
+            ipf::kOutputOffsetIPv6 - ipf::kOutputOffsetIPv4);
+  start = out;
+  out = pad(start, host.ipv6().format(out), ipf::kOutputLengthIPv6);
+  *out++ = ' ';
+  out = right(activity.packets, ipf::kOutputLengthPackets, out);
+  *out++ = ' ';
+  out = right(activity.bytes, ipf::kOutputLengthBytes, out);
+  *out++ = ' ';
+  start = out;
+  out = pad(start, utc(activity.first_seen, out), ipf::kOutputLengthTime);
+  *out++ = ' ';
+  start = out;
+  out = pad(start, utc(activity.last_seen, out), ipf::kOutputLengthTime);
+  if (vendors_) {
+    *out++ = ' ';
+    out = append(vendor, out);
+  }
+  *out++ = '\n';
+  const AddressSet<Host::PackedIPv4, Host::kInlineIPv4>& ipv4s =
+      host.packed_ipv4s();
+  const AddressSet<Host::PackedIPv6, Host::kInlineIPv6>& ipv6s =
+      host.packed_ipv6s();
+  size_t i = next_ipv4(host, 0), j = next_ipv6(host, 0);
+  while (i < ipv4s.size() || j < ipv6s.size()) {
+    start = out;
+    out = pad(start, out, ipf::kOutputOffsetIPv4);
+    start = out;
+    if (i < ipv4s.size()) {
+      uint8_t octets[ipf::kLengthIPv4];
+      unpack(ipv4s[i], octets);
+      out = IPv4Address::format(octets, out);
+      i = next_ipv4(host, i + 1);
+    }
+    out = pad(start, out, ipf::kOutputOffsetIPv6 - ipf::kOutputOffsetIPv4);
+    start = out;
+    if (j < ipv6s.size()) {
+      out = IPv6Address::format(ipv6s[j].data(), out);
+      j = next_ipv6(host, j + 1);
+    }
+    out = pad(start, out, ipf::kOutputLengthIPv6);
+    *out++ = '\n';
+  }
+  commit(out);
+}
+
+void TableWriter::end(const Summary& summary) {
+  text((vendors_ ? ipf::kVendorFooter1 : ipf::kFooter1) + '\n');
+  this->summary(summary);
+}
+
+/**
+ *  @details The migrated percentage is NaN for an empty report, printed as 
+ *           std::fixed would.  Skipped addresses are left to the structured 
+ *           formats, so the table reads as before.
+ */
+void TableWriter::summary(const Summary& summary) {
+  double pc = static_cast<double>(summary.dual + summary.ipv6) /
+              static_cast<double>(summary.hosts) * 100;
+  char line[256];
+  int length = std::snprintf(line, sizeof(line), "Hosts: %zu; IPv4 only: %zu;"
+                             " IPv6 only: %zu; dual-stack: %zu; migrated: "
+                             "%.0f%%\n", summary.hosts, summary.ipv4,
+                             summary.ipv6, summary.dual, pc);
+  text(std::string(line, static_cast<size_t>(length)));
+}
+
+void TableWriter::text(const std::string& text) {
+  char* out = reserve(text.size());
+  std::memcpy(out, text.data(), text.size());
+  commit(out + text.size());
+}
+
+std::unique_ptr<ReportWriter> CSVWriter::part() const {
+  return std::unique_ptr<ReportWriter>(new CSVWriter(vendors_));
+}
+
+void CSVWriter::begin() {
+  const char header[] {"mac,ipv4,ipv6,ipv4_aliases,ipv6_aliases,packets,"
+                       "bytes,first_seen,last_seen"};
+  char* out = reserve(sizeof(header) + 8);
+  out = append(header, out);
+  if (vendors_) out = append(",vendor", out);
+  *out++ = '\n';
+  commit(out);
+}
+
+void CSVWriter::host(const Host& host, const Activity& activity) {
+  const char* vendor = vendors_ ? OUI::vendor(host.mac()) : "";
+  char* out = reserve(bound(host, vendor));
+  out = host.mac().format(out);
+  *out++ = ',';
+  out = host.ipv4().format(out);
+  *out++ = ',';
+  out = host.ipv6().format(out);
+  *out++ = ',';
+  out = ipv4_aliases(host, ' ', '\0', out);
+  *out++ = ',';
+  out = ipv6_aliases(host, ' ', '\0', out);
+  *out++ = ',';
+  out = decimal(activity.packets, out);
+  *out++ = ',';
+  out = decimal(activity.bytes, out);
+  *out++ = ',';
+  out = utc(activity.first_seen, out);
+  *out++ = ',';
+  out = utc(activity.last_seen, out);
+  if (vendors_) {
+    *out++ = ',';
+    out = csv(vendor, out);
+  }
+  *out++ = '\n';
+  commit(out);
+}
+
+void CSVWriter::end(const Summary&) {
+}
+
+void CSVWriter::summary(const Summary& summary) {
+  char* out = reserve(256);
+  out = append("hosts,ipv4_only,ipv6_only,dual_stack,excluded,fake\n", out);
+  const size_t values[] {summary.hosts, summary.ipv4, summary.ipv6,
+                         summary.dual, summary.excluded, summary.fake};
+  for (size_t i = 0; i < sizeof(values) / sizeof(values[0]); ++i) {
+    out = decimal(values[i], out);
+    *out++ = i + 1 < sizeof(values) / sizeof(values[0]) ? ',' : '\n';
+  }
+  commit(out);
+}
+
+/**
+ *  @details Missing addresses, times and vendors are null.
+ */
+void NDJSONWriter::object(const Host& host, const Activity& activity) {
+  const char* vendor = vendors_ ? OUI::vendor(host.mac()) : "";
+  char* out = reserve(bound(host, vendor));
+  out = member("{\"mac\":", host.mac(), out);
+  out = member(",\"ipv4\":", host.ipv4(), out);
+  out = member(",\"ipv6\":", host.ipv6(), out);
+  out = append(",\"ipv4_aliases\":[", out);
+  out = ipv4_aliases(host, ',', '"', out);
+  out = append("],\"ipv6_aliases\":[", out);
+  out = ipv6_aliases(host, ',', '"', out);
+  out = append("],\"packets\":", out);
+  out = decimal(activity.packets, out);
+  out = append(",\"bytes\":", out);
+  out = decimal(activity.bytes, out);
+  out = time_member(",\"first_seen\":", activity.first_seen, out);
+  out = time_member(",\"last_seen\":", activity.last_seen, out);
+  if (vendors_) {
+    out = append(",\"vendor\":", out);
+    out = *vendor == '\0' ? append("null", out) : json(vendor, out);
+  }
+  *out++ = '}';
+  commit(out);
+}
+
+std::unique_ptr<ReportWriter> NDJSONWriter::part() const {
+  return std::unique_ptr<ReportWriter>(new NDJSONWriter(vendors_));
+}
+
+void NDJSONWriter::begin() {
+}
+
+void NDJSONWriter::host(const Host& host, const Activity& activity) {
+  object(host, activity);
+  char* out = reserve(1);
+  *out++ = '\n';
+  commit(out);
+}
+
+void NDJSONWriter::end(const Summary&) {
+}
+
+void NDJSONWriter::summary(const Summary& summary) {
+  char* out = reserve(256);
+  out = append("{\"summary\":", out);
+  out = counts(summary, out);
+  out = append("}\n", out);
+  commit(out);
+}
+
+std::unique_ptr<ReportWriter> JSONWriter::part() const {
+  std::unique_ptr<JSONWriter> writer(new JSONWriter(vendors_));
+  writer->first_ = first_;
+  return std::unique_ptr<ReportWriter>(writer.release());
+}
+
+void JSONWriter::begin() {
+  char* out = reserve(16);
+  out = append("{\"hosts\":[", out);
+  commit(out);
+}
+
+void JSONWriter::host(const Host& host, const Activity& activity) {
+  char* out = reserve(2);
+  if (!first_) *out++ = ',';
+  *out++ = '\n';
+  commit(out);
+  first_ = false;
+  object(host, activity);
+}
+
+void JSONWriter::end(const Summary& summary) {
+  char* out = reserve(256);
+  if (!first_) *out++ = '\n';
+  out = append("],\n\"summary\":", out);
+  out = counts(summary, out);
+  out = append("}\n", out);
+  commit(out);
+}
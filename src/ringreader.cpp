@@ -0,0 +1,281 @@
+/**
+ *  @file ringreader.cpp
+ *  @brief RingReader class implementation
+ */
+
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014 Michael Maraya
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifdef __linux__
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#endif
+#include <errno.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "ipforensics/ip4and6.h"
+#include "ipforensics/ringreader.h"
+
+#if defined(__linux__) && defined(__NR_io_uring_setup)
+
+/**
+ *  @details The submission and completion rings are mapped and the chunk 
+ *           memory registered as a single fixed buffer.  Any failure leaves
+ *           ring_ at -1 so available() reports that io_uring cannot be used;
+ *           failing to register the buffers (for example because of 
+ *           RLIMIT_MEMLOCK on older kernels) only falls back to READV.
+ */
+RingReader::RingReader(int fd) : fd_(fd) {
+  memory_.resize((ipf::kRingChunks + 1) * ipf::kRingChunkSize +
+                 ipf::kDirectAlignment);
+  uintptr_t p = reinterpret_cast<uintptr_t>(memory_.data());
+  p = (p + ipf::kDirectAlignment - 1) & ~(ipf::kDirectAlignment - 1);
+  chunks_ = reinterpret_cast<uint8_t*>(p);
+  length_.assign(ipf::kRingChunks, 0);
+  struct io_uring_params params;
+  memset(&params, 0, sizeof(params));
+  int ring = static_cast<int>(syscall(__NR_io_uring_setup, ipf::kRingChunks,
+                                      &params));
+  if (ring < 0) return;
+  sq_ring_size_ = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+  cq_ring_size_ = params.cq_off.cqes +
+                  params.cq_entries * sizeof(struct io_uring_cqe);
+  if (params.features & IORING_FEAT_SINGLE_MMAP) {
+    sq_ring_size_ = cq_ring_size_ = std::max(sq_ring_size_, cq_ring_size_);
+  }
+  sq_ring_ = mmap(nullptr, sq_ring_size_, PROT_READ | PROT_WRITE,
+                  MAP_SHARED | MAP_POPULATE, ring, IORING_OFF_SQ_RING);
+  if (sq_ring_ == MAP_FAILED) {
+    sq_ring_ = nullptr;
+    close(ring);
+    return;
+  }
+  cq_ring_ = sq_ring_;
+  if (!(params.features & IORING_FEAT_SINGLE_MMAP)) {
+    cq_ring_ = mmap(nullptr, cq_ring_size_, PROT_READ | PROT_WRITE,
+                    MAP_SHARED | MAP_POPULATE, ring, IORING_OFF_CQ_RING);
+    if (cq_ring_ == MAP_FAILED) {
+      cq_ring_ = nullptr;
+      munmap(sq_ring_, sq_ring_size_);
+      sq_ring_ = nullptr;
+      close(ring);
+      return;
+    }
+  }
+  sqes_size_ = params.sq_entries * sizeof(struct io_uring_sqe);
+  sqes_ = mmap(nullptr, sqes_size_, PROT_READ | PROT_WRITE,
+               MAP_SHARED | MAP_POPULATE, ring, IORING_OFF_SQES);
+  if (sqes_ == MAP_FAILED) {
+    sqes_ = nullptr;
+    if (cq_ring_ != sq_ring_) munmap(cq_ring_, cq_ring_size_);
+    munmap(sq_ring_, sq_ring_size_);
+    sq_ring_ = cq_ring_ = nullptr;
+    close(ring);
+    return;
+  }
+  uint8_t* sq = static_cast<uint8_t*>(sq_ring_);
+  uint8_t* cq = static_cast<uint8_t*>(cq_ring_);
+  sq_tail_ = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+  sq_mask_ = reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+  sq_array_ = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+  cq_head_ = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+  cq_tail_ = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+  cq_mask_ = reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+  cqes_ = cq + params.cq_off.cqes;
+  struct iovec region = {chunks_, ipf::kRingChunks * ipf::kRingChunkSize};
+  fixed_ = (syscall(__NR_io_uring_register, ring, IORING_REGISTER_BUFFERS,
+                    &region, 1) == 0);
+  for (size_t i = 0; i < ipf::kRingChunks; ++i) {
+    struct iovec chunk = {chunks_ + i * ipf::kRingChunkSize,
+                          ipf::kRingChunkSize};
+    iovecs_.push_back(chunk);
+  }
+  ring_ = ring;
+}
+
+RingReader::~RingReader() {
+  if (ring_ < 0) return;
+  drain();
+  munmap(sqes_, sqes_size_);
+  if (cq_ring_ != sq_ring_) munmap(cq_ring_, cq_ring_size_);
+  munmap(sq_ring_, sq_ring_size_);
+  close(ring_);
+}
+
+void RingReader::queue(uint64_t sequence) {
+  size_t slot = sequence % ipf::kRingChunks;
+  unsigned tail = *sq_tail_;
+  unsigned index = tail & *sq_mask_;
+  struct io_uring_sqe* sqe = static_cast<struct io_uring_sqe*>(sqes_) + index;
+  memset(sqe, 0, sizeof(*sqe));
+  sqe->fd = fd_;
+  sqe->off = base_ + sequence * ipf::kRingChunkSize;
+  if (fixed_) {
+    sqe->opcode = IORING_OP_READ_FIXED;
+    sqe->addr = reinterpret_cast<uintptr_t>(iovecs_[slot].iov_base);
+    sqe->len = static_cast<uint32_t>(ipf::kRingChunkSize);
+    sqe->buf_index = 0;
+  } else {
+    sqe->opcode = IORING_OP_READV;
+    sqe->addr = reinterpret_cast<uintptr_t>(&iovecs_[slot]);
+    sqe->len = 1;
+  }
+  sqe->user_data = sequence;
+  sq_array_[index] = index;
+  __atomic_store_n(sq_tail_, tail + 1, __ATOMIC_RELEASE);
+  length_[slot] = kPending;
+  ++queued_;
+  ++in_flight_;
+}
+
+/**
+ *  @details io_uring_enter submits everything queued since the last call and,
+ *           when asked to wait, blocks for at least one completion.  Completion
+ *           entries are then consumed until the completion queue is empty.
+ */
+void RingReader::reap(bool wait) {
+  unsigned head = *cq_head_;
+  unsigned tail = __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE);
+  if (queued_ > 0 || (wait && head == tail)) {
+    unsigned flags = wait ? IORING_ENTER_GETEVENTS : 0;
+    long n = syscall(__NR_io_uring_enter, ring_, queued_, wait ? 1 : 0, flags,
+                     nullptr, 0);
+    if (n < 0 && errno != EINTR && errno != EAGAIN && errno != EBUSY) {
+      throw std::runtime_error(std::string("io_uring_enter: ") +
+                               strerror(errno));
+    }
+    if (n > 0) queued_ -= std::min(queued_, static_cast<unsigned>(n));
+  }
+  tail = __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE);
+  while (head != tail) {
+    struct io_uring_cqe* cqe = static_cast<struct io_uring_cqe*>(cqes_) +
+                               (head & *cq_mask_);
+    uint64_t sequence = cqe->user_data;
+    if (cqe->res < 0) {
+      __atomic_store_n(cq_head_, head + 1, __ATOMIC_RELEASE);
+      --in_flight_;
+      throw std::runtime_error(std::string("io_uring read: ") +
+                               strerror(-cqe->res));
+    }
+    length_[sequence % ipf::kRingChunks] = cqe->res;
+    if (static_cast<size_t>(cqe->res) < ipf::kRingChunkSize &&
+        sequence < end_) {
+      end_ = sequence;
+    }
+    ++head;
+    --in_flight_;
+  }
+  __atomic_store_n(cq_head_, head, __ATOMIC_RELEASE);
+}
+
+void RingReader::drain() {
+  while (in_flight_ > 0) {
+    unsigned before = in_flight_;
+    try {
+      reap(true);
+    } catch (std::runtime_error const &) {
+      // a failed read still completes; a failed io_uring_enter does not
+      if (in_flight_ == before) return;
+    }
+  }
+}
+
+void RingReader::restart(uint64_t offset) {
+  drain();
+  started_ = true;
+  base_ = offset;
+  head_ = 0;
+  end_ = UINT64_MAX;
+  for (uint64_t q = 0; q < ipf::kRingChunks; ++q) {
+    queue(q);
+  }
+  reap(false);
+}
+
+bool RingReader::available() const {
+  return ring_ >= 0;
+}
+
+/**
+ *  @details A range that runs from the last chunk into the first one is made
+ *           contiguous by copying its tail into the spare chunk after the last
+ *           one.  Chunks before the one holding offset are queued again for the
+ *           part of the file ipf::kRingChunks chunks further on, unless the
+ *           end of the file has already been reached.
+ */
+const uint8_t* RingReader::data(uint64_t offset, size_t length) {
+  const uint64_t size = ipf::kRingChunkSize;
+  if (!started_ || offset < base_ + head_ * size ||
+      (offset - base_) / size >= head_ + ipf::kRingChunks) {
+    restart(offset);
+  }
+  uint64_t first = (offset - base_) / size;
+  uint64_t last = (offset + length - 1 - base_) / size;
+  while (head_ < first) {
+    while (length_[head_ % ipf::kRingChunks] == kPending) reap(true);
+    if (head_ + ipf::kRingChunks <= end_) queue(head_ + ipf::kRingChunks);
+    ++head_;
+  }
+  reap(false);
+  while (length_[first % ipf::kRingChunks] == kPending ||
+         length_[last % ipf::kRingChunks] == kPending) {
+    reap(true);
+  }
+  uint64_t available = base_ + first * size +
+                       static_cast<uint64_t>(length_[first % ipf::kRingChunks]);
+  if (last != first && first < end_) {
+    available += static_cast<uint64_t>(length_[last % ipf::kRingChunks]);
+  }
+  if (first > end_ || offset + length > available) return nullptr;
+  uint8_t* p = chunks_ + (first % ipf::kRingChunks) * size +
+               (offset - base_ - first * size);
+  if (last != first && last % ipf::kRingChunks == 0) {
+    memcpy(chunks_ + ipf::kRingChunks * size, chunks_,
+           offset + length - base_ - last * size);
+  }
+  return p;
+}
+
+#else
+
+RingReader::RingReader(int fd) : fd_(fd) {
+}
+
+RingReader::~RingReader() {
+}
+
+bool RingReader::available() const {
+  return false;
+}
+
+const uint8_t* RingReader::data(uint64_t, size_t) {
+  return nullptr;
+}
+
+#endif
@@ -0,0 +1,176 @@
+/**
+ *  @file sampler.cpp
+ *  @brief Sampler class implementation
+ */
+
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014 Michael Maraya
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <iomanip>
+#include <iostream>  // NOLINT
+#include <stdexcept>
+#include <string>
+#include "ipforensics/ip4and6.h"
+#include "ipforensics/sampler.h"
+
+namespace {
+
+/** 64-bit finalizer from MurmurHash3, used to spread sampling decisions */
+uint64_t mix(uint64_t k) {
+  k ^= k >> 33;
+  k *= 0xff51afd7ed558ccdULL;
+  k ^= k >> 33;
+  k *= 0xc4ceb9fe1a85ec53ULL;
+  k ^= k >> 33;
+  return k;
+}
+
+/** Pack the six bytes of a MAC address into an integer */
+uint64_t pack(const uint8_t* p) {
+  uint64_t value {0};
+  for (int i = 0; i < ipf::kLengthMAC; ++i) {
+    value = (value << 8) | p[i];
+  }
+  return value;
+}
+
+}  // namespace
+
+Sampler::Method Sampler::method() const {
+  return method_;
+}
+
+uint32_t Sampler::rate() const {
+  return rate_;
+}
+
+uint64_t Sampler::seen() const {
+  return seen_;
+}
+
+uint64_t Sampler::kept() const {
+  return kept_;
+}
+
+void Sampler::set_method(Method method) {
+  method_ = method;
+}
+
+void Sampler::set_rate(uint32_t rate) {
+  rate_ = (rate == 0) ? 1 : rate;
+}
+
+/**
+ *  @details Group and broadcast addresses (I/G bit set) are not hosts and are
+ *           not counted.
+ */
+void Sampler::observe(const uint8_t* p) {
+  if (p[0] & 0x01) return;
+  ++observations_[pack(p)];
+}
+
+/**
+ *  @details The flow hash combines the source and destination MAC addresses
+ *           with XOR so both directions of a conversation are kept together.
+ */
+bool Sampler::keep(const struct pcap_pkthdr& header, const uint8_t* data) {
+  if (rate_ <= 1) {
+    ++seen_;
+    ++kept_;
+    return true;
+  }
+  bool keep {false};
+  switch (method_) {
+    case Method::kCount:
+      keep = (seen_ % rate_ == 0);
+      break;
+    case Method::kTime: {
+      int64_t stratum = static_cast<int64_t>(header.ts.tv_sec) /
+                        ipf::kSampleStratum;
+      if (stratum != stratum_) {
+        stratum_ = stratum;
+        stratum_seen_ = 0;
+        stratum_pick_ = static_cast<uint32_t>(
+            mix(static_cast<uint64_t>(stratum)) % rate_);
+      }
+      keep = (stratum_seen_++ % rate_ == stratum_pick_);
+      break;
+    }
+    case Method::kFlow:
+      keep = (mix(pack(data + ipf::kOffsetMACSrc) ^
+                  pack(data + ipf::kOffsetMACDst)) % rate_ == 0);
+      break;
+  }
+  ++seen_;
+  if (keep) {
+    ++kept_;
+    observe(data + ipf::kOffsetMACSrc);
+    observe(data + ipf::kOffsetMACDst);
+  }
+  return keep;
+}
+
+double Sampler::coverage() const {
+  uint64_t n {0}, f1 {0};
+  for (const auto& o : observations_) {
+    n += o.second;
+    if (o.second == 1) ++f1;
+  }
+  if (n == 0) return 0;
+  return 1 - static_cast<double>(f1) / static_cast<double>(n);
+}
+
+double Sampler::missed() const {
+  double f1 {0}, f2 {0};
+  for (const auto& o : observations_) {
+    if (o.second == 1) ++f1;
+    if (o.second == 2) ++f2;
+  }
+  if (f1 == 0) return 0;
+  if (f2 > 0) return f1 * f1 / (2 * f2);
+  return f1 * (f1 - 1) / 2;
+}
+
+Sampler::Method Sampler::method(const std::string& name) {
+  if (name == "count") return Method::kCount;
+  if (name == "time") return Method::kTime;
+  if (name == "flow") return Method::kFlow;
+  throw std::invalid_argument("unknown sampling method " + name);
+}
+
+/**
+ *  @details Displays the sampling rate and method, how many packets were
+ *           decoded, and the coverage estimates.
+ */
+std::ostream& operator<<(std::ostream& out, const Sampler& s) {
+  static const char* names[] = {"count", "time", "flow"};
+  std::ios::fmtflags fmt(out.flags());
+  out << "Sampled 1 in " << s.rate() << " packets by ";
+  out << names[static_cast<int>(s.method())] << ": " << s.kept() << " of ";
+  out << s.seen() << "; estimated coverage: " << std::fixed;
+  out << std::setprecision(0) << s.coverage() * 100 << "%";
+  out << "; estimated hosts missed: " << s.missed();
+  out.flags(fmt);
+  return out;
+}
@@ -0,0 +1,335 @@
+/**
+ *  @file sketch.cpp
+ *  @brief Sketch class implementation
+ */
+
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014 Michael Maraya
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <errno.h>
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <fstream>  // NOLINT
+#include <iomanip>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "ipforensics/host.h"
+#include "ipforensics/ip4and6.h"
+#include "ipforensics/sketch.h"
+
+namespace {
+
+/** Hash of a packed IPv6 address for the estimators */
+uint64_t hash_ipv6(const Host::PackedIPv6& a) {
+  uint64_t high {0}, low {0};
+  for (size_t i = 0; i < 8; ++i) {
+    high = (high << 8) | a[i];
+    low = (low << 8) | a[i + 8];
+  }
+  return HyperLogLog::hash(high ^ HyperLogLog::hash(low));
+}
+
+/** Key of the IPv4 /24 subnet of a packed address */
+uint32_t ipv4_key(Host::PackedIPv4 a) {
+  return ((a & 0xFF) << 16) | (a & 0xFF00) | ((a >> 16) & 0xFF);
+}
+
+/** Hash of an IPv4 subnet key for dropped subnets, apart from IPv6 keys */
+uint64_t hash_ipv4_subnet(uint32_t key) {
+  return HyperLogLog::hash(HyperLogLog::hash(key));
+}
+
+/** Key of the IPv6 /64 subnet of a packed address */
+uint64_t ipv6_key(const Host::PackedIPv6& a) {
+  uint64_t key {0};
+  for (size_t i = 0; i < 8; ++i) key = (key << 8) | a[i];
+  return key;
+}
+
+/** Text of an IPv4 /24 subnet key */
+std::string ipv4_subnet(uint32_t key) {
+  std::stringstream ss;
+  ss << (key >> 16) << '.' << ((key >> 8) & 0xFF) << '.' << (key & 0xFF);
+  ss << ".0/24";
+  return ss.str();
+}
+
+/** Text of an IPv6 /64 subnet key */
+std::string ipv6_subnet(uint64_t key) {
+  std::vector<uint8_t> octets(ipf::kLengthIPv6, 0);
+  for (size_t i = 0; i < 8; ++i) {
+    octets[i] = static_cast<uint8_t>(key >> (56 - 8 * i));
+  }
+  return IPv6Address(octets).str() + "/64";
+}
+
+/** Rounds an estimate for display */
+uint64_t rounded(double estimate) {
+  return static_cast<uint64_t>(std::llround(std::max(estimate, 0.0)));
+}
+
+/** Writes one row of the subnet table */
+void write_subnet(std::ostream& out, const std::string& subnet,
+                  const Sketch::Subnet& s) {
+  out << std::left << std::setw(44) << subnet << std::right;
+  out << std::setw(10) << rounded(s.macs.estimate()) << ' ';
+  out << std::setw(10) << rounded(s.addresses.estimate()) << '\n';
+}
+
+}  // namespace
+
+double Sketch::macs() const {
+  return macs_.estimate();
+}
+
+double Sketch::ipv4() const {
+  return ipv4_.estimate();
+}
+
+double Sketch::ipv6() const {
+  return ipv6_.estimate();
+}
+
+/**
+ *  @details |IPv4 MACs and IPv6 MACs| = |IPv4 MACs| + |IPv6 MACs| - 
+ *           |IPv4 MACs or IPv6 MACs|, the union coming from the merged 
+ *           estimators.
+ */
+double Sketch::dual_stack() const {
+  HyperLogLog either = macs_ipv4_;
+  either.merge(macs_ipv6_);
+  double both = macs_ipv4_.estimate() + macs_ipv6_.estimate() -
+                either.estimate();
+  return std::max(both, 0.0);
+}
+
+/**
+ *  @details The errors of the three estimates add up, so this is the 
+ *           relative error of the larger counts rather than of the result.
+ */
+double Sketch::dual_stack_error() const {
+  HyperLogLog either = macs_ipv4_;
+  either.merge(macs_ipv6_);
+  return HyperLogLog::error() * (macs_ipv4_.estimate() +
+                                 macs_ipv6_.estimate() + either.estimate());
+}
+
+double Sketch::dropped_subnets() const {
+  return dropped_.estimate();
+}
+
+const std::map<uint32_t, Sketch::Subnet>& Sketch::ipv4_subnets() const {
+  return ipv4_subnets_;
+}
+
+const std::map<uint64_t, Sketch::Subnet>& Sketch::ipv6_subnets() const {
+  return ipv6_subnets_;
+}
+
+template <typename K>
+Sketch::Subnet* Sketch::subnet(std::map<K, Subnet>* subnets, K key,
+                               uint64_t hash) {
+  auto it = subnets->find(key);
+  if (it != subnets->end()) return &it->second;
+  if (ipv4_subnets_.size() + ipv6_subnets_.size() >= ipf::kSketchMaxSubnets) {
+    dropped_.add(hash);
+    return nullptr;
+  }
+  return &(*subnets)[key];
+}
+
+void Sketch::add(const MACAddress& mac, const IPv4Address& ipv4,
+                 const IPv6Address& ipv6) {
+  uint64_t mac_hash = HyperLogLog::hash(Host::pack(mac));
+  macs_.add(mac_hash);
+  if (!ipv4.empty()) {
+    Host::PackedIPv4 packed = Host::pack(ipv4);
+    uint64_t hash = HyperLogLog::hash(packed);
+    ipv4_.add(hash);
+    macs_ipv4_.add(mac_hash);
+    uint32_t key = ipv4_key(packed);
+    Subnet* s = subnet(&ipv4_subnets_, key, hash_ipv4_subnet(key));
+    if (s != nullptr) {
+      s->macs.add(mac_hash);
+      s->addresses.add(hash);
+    }
+  }
+  if (!ipv6.empty()) {
+    Host::PackedIPv6 packed = Host::pack(ipv6);
+    uint64_t hash = hash_ipv6(packed);
+    ipv6_.add(hash);
+    macs_ipv6_.add(mac_hash);
+    uint64_t key = ipv6_key(packed);
+    Subnet* s = subnet(&ipv6_subnets_, key, HyperLogLog::hash(key));
+    if (s != nullptr) {
+      s->macs.add(mac_hash);
+      s->addresses.add(hash);
+    }
+  }
+}
+
+void Sketch::merge(const Sketch& other) {
+  macs_.merge(other.macs_);
+  ipv4_.merge(other.ipv4_);
+  ipv6_.merge(other.ipv6_);
+  macs_ipv4_.merge(other.macs_ipv4_);
+  macs_ipv6_.merge(other.macs_ipv6_);
+  dropped_.merge(other.dropped_);
+  for (const auto& s : other.ipv4_subnets_) {
+    Subnet* mine = subnet(&ipv4_subnets_, s.first, hash_ipv4_subnet(s.first));
+    if (mine == nullptr) continue;
+    mine->macs.merge(s.second.macs);
+    mine->addresses.merge(s.second.addresses);
+  }
+  for (const auto& s : other.ipv6_subnets_) {
+    Subnet* mine = subnet(&ipv6_subnets_, s.first,
+                          HyperLogLog::hash(s.first));
+    if (mine == nullptr) continue;
+    mine->macs.merge(s.second.macs);
+    mine->addresses.merge(s.second.addresses);
+  }
+}
+
+/**
+ *  @details The file is a header line, one line per global estimator with its
+ *           name and registers, and one line per subnet with the subnet and
+ *           the registers of its MAC and address estimators.  Files written
+ *           before dropped subnets were counted have no dropped-subnets
+ *           line.
+ */
+void Sketch::save(const std::string& filename) const {
+  std::string temp = filename + ".tmp";
+  std::ofstream ofs(temp, std::ofstream::out | std::ofstream::trunc);
+  if (!ofs.is_open()) {
+    throw std::runtime_error("Could not open sketch file " + temp);
+  }
+  ofs << ipf::kSketchHeader << '\n';
+  ofs << "macs " << macs_.hex() << '\n';
+  ofs << "ipv4 " << ipv4_.hex() << '\n';
+  ofs << "ipv6 " << ipv6_.hex() << '\n';
+  ofs << "macs-ipv4 " << macs_ipv4_.hex() << '\n';
+  ofs << "macs-ipv6 " << macs_ipv6_.hex() << '\n';
+  ofs << "dropped-subnets " << dropped_.hex() << '\n';
+  for (const auto& s : ipv4_subnets_) {
+    ofs << "subnet " << ipv4_subnet(s.first) << ' ' << s.second.macs.hex();
+    ofs << ' ' << s.second.addresses.hex() << '\n';
+  }
+  for (const auto& s : ipv6_subnets_) {
+    ofs << "subnet " << ipv6_subnet(s.first) << ' ' << s.second.macs.hex();
+    ofs << ' ' << s.second.addresses.hex() << '\n';
+  }
+  ofs.close();
+  if (ofs.fail() || std::rename(temp.c_str(), filename.c_str()) != 0) {
+    throw std::runtime_error("Could not write sketch file " + filename);
+  }
+}
+
+bool Sketch::load(const std::string& filename) {
+  std::ifstream fs(filename);
+  if (!fs.is_open()) {
+    if (errno == ENOENT) return false;
+    throw std::runtime_error("Could not open sketch file " + filename);
+  }
+  std::string line;
+  std::getline(fs, line);
+  if (line != ipf::kSketchHeader) {
+    throw std::runtime_error(filename + " is not a sketch file");
+  }
+  Sketch loaded;
+  try {
+    while (std::getline(fs, line)) {
+      std::istringstream ss(line);
+      std::string name, hex;
+      ss >> name;
+      if (name == "subnet") {
+        std::string text, macs, addresses;
+        ss >> text >> macs >> addresses;
+        Subnet s;
+        s.macs.set_hex(macs);
+        s.addresses.set_hex(addresses);
+        std::string address = text.substr(0, text.find('/'));
+        Sketch single;
+        if (address.find(':') != std::string::npos) {
+          single.ipv6_subnets_[ipv6_key(Host::pack(IPv6Address(address)))] = s;
+        } else {
+          single.ipv4_subnets_[ipv4_key(Host::pack(IPv4Address(address)))] = s;
+        }
+        loaded.merge(single);
+        continue;
+      }
+      ss >> hex;
+      if (name == "macs") {
+        loaded.macs_.set_hex(hex);
+      } else if (name == "ipv4") {
+        loaded.ipv4_.set_hex(hex);
+      } else if (name == "ipv6") {
+        loaded.ipv6_.set_hex(hex);
+      } else if (name == "macs-ipv4") {
+        loaded.macs_ipv4_.set_hex(hex);
+      } else if (name == "macs-ipv6") {
+        loaded.macs_ipv6_.set_hex(hex);
+      } else if (name == "dropped-subnets") {
+        loaded.dropped_.set_hex(hex);
+      } else {
+        throw std::invalid_argument("unknown estimator " + name);
+      }
+    }
+  } catch (std::exception const &e) {
+    throw std::runtime_error(filename + ": " + e.what());
+  }
+  merge(loaded);
+  return true;
+}
+
+std::ostream& operator<<(std::ostream& out, const Sketch& s) {
+  std::ios::fmtflags fmt(out.flags());
+  out << std::fixed << std::setprecision(1);
+  out << "Estimated MACs: " << rounded(s.macs());
+  out << "; IPv4 addresses: " << rounded(s.ipv4());
+  out << "; IPv6 addresses: " << rounded(s.ipv6());
+  out << " (+/-" << HyperLogLog::error() * 100 << "%)";
+  out << "; dual-stack: " << rounded(s.dual_stack());
+  out << " (+/-" << rounded(s.dual_stack_error()) << ")\n";
+  if (!s.ipv4_subnets().empty() || !s.ipv6_subnets().empty()) {
+    out << std::left << std::setw(44) << "Subnet" << std::right;
+    out << std::setw(10) << "MACs" << ' ' << std::setw(10) << "Addresses";
+    out << '\n';
+    for (const auto& subnet : s.ipv4_subnets()) {
+      write_subnet(out, ipv4_subnet(subnet.first), subnet.second);
+    }
+    for (const auto& subnet : s.ipv6_subnets()) {
+      write_subnet(out, ipv6_subnet(subnet.first), subnet.second);
+    }
+  }
+  uint64_t dropped = rounded(s.dropped_subnets());
+  if (dropped > 0) {
+    out << "Subnets over the limit of " << ipf::kSketchMaxSubnets;
+    out << ", not listed: " << dropped << '\n';
+  }
+  out.flags(fmt);
+  return out;
+}
@@ -0,0 +1,308 @@
+/**
+ *  @file snapshot.cpp
+ *  @brief Snapshot class implementation
+ */
+
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014 Michael Maraya
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+#include "ipforensics/snapshot.h"
+
+static_assert(sizeof(Snapshot::Header) == 48, "unexpected Header padding");
+static_assert(sizeof(Snapshot::Record) == 72, "unexpected Record padding");
+static_assert(sizeof(Snapshot::Alias) == 20, "unexpected Alias padding");
+
+namespace {
+
+/** FNV-1a 64-bit prime */
+const uint64_t kFNVPrime {0x100000001b3ULL};
+
+/**
+ *  @brief Checks a mapped snapshot and copies out its records and aliases
+ *  @param data start of the mapped file
+ *  @param size size of the file in bytes
+ *  @param records receives the records of the snapshot
+ *  @param aliases receives the aliases of the snapshot
+ *  @retval Snapshot::Header header of the snapshot
+ *  @throws std::invalid_argument describing the first problem found
+ */
+Snapshot::Header restore(const uint8_t* data, size_t size,
+                         std::vector<Snapshot::Record>* records,
+                         std::vector<Snapshot::Alias>* aliases) {
+  Snapshot::Header header;
+  if (size < sizeof(header)) throw std::invalid_argument("truncated header");
+  std::memcpy(&header, data, sizeof(header));
+  if (std::memcmp(header.magic, ipf::kSnapshotMagic, sizeof(header.magic))) {
+    throw std::invalid_argument("not a snapshot file");
+  }
+  if (header.version != ipf::kSnapshotVersion) {
+    throw std::invalid_argument("unsupported version " +
+                                std::to_string(header.version));
+  }
+  if (header.byte_order != ipf::kSnapshotByteOrder) {
+    throw std::invalid_argument("written with a different byte order");
+  }
+  if (header.record_size != sizeof(Snapshot::Record) ||
+      header.alias_size != sizeof(Snapshot::Alias)) {
+    throw std::invalid_argument("unexpected record size");
+  }
+  size_t body = size - sizeof(header);
+  if (header.records > body / sizeof(Snapshot::Record) ||
+      header.aliases > body / sizeof(Snapshot::Alias) ||
+      header.records * sizeof(Snapshot::Record) +
+      header.aliases * sizeof(Snapshot::Alias) != body) {
+    throw std::invalid_argument("size does not match header");
+  }
+  if (Snapshot::checksum(data + sizeof(header), body) != header.checksum) {
+    throw std::invalid_argument("checksum mismatch");
+  }
+  const Snapshot::Record* first =
+      reinterpret_cast<const Snapshot::Record*>(data + sizeof(header));
+  const Snapshot::Alias* alias =
+      reinterpret_cast<const Snapshot::Alias*>(first + header.records);
+  for (uint64_t i = 0; i < header.records; ++i) {
+    const Snapshot::Record& r = first[i];
+    if (r.alias > header.aliases || r.alias_count > header.aliases - r.alias) {
+      throw std::invalid_argument("alias index out of range");
+    }
+  }
+  records->assign(first, first + header.records);
+  aliases->assign(alias, alias + header.aliases);
+  return header;
+}
+
+}  // namespace
+
+Snapshot::Snapshot(IPForensics* ip) {
+  ip_ = ip;
+}
+
+uint64_t Snapshot::checksum() const {
+  return checksum_;
+}
+
+uint64_t Snapshot::records() const {
+  return records_;
+}
+
+uint64_t Snapshot::checksum(const void* data, size_t size, uint64_t hash) {
+  const uint8_t* bytes = static_cast<const uint8_t*>(data);
+  for (size_t i = 0; i < size; ++i) {
+    hash = (hash ^ bytes[i]) * kFNVPrime;
+  }
+  return hash;
+}
+
+/**
+ *  @details The primary addresses go in the Record and every other address of
+ *           the Host becomes an Alias, IPv4 addresses first.
+ */
+Snapshot::Record Snapshot::encode(const Host& host, const Activity& activity,
+                                  std::vector<Alias>* aliases) {
+  Record r {};
+  r.mac = Host::pack(host.mac());
+  if (!host.ipv4().empty()) {
+    r.flags |= kHasIPv4;
+    r.ipv4 = Host::pack(host.ipv4());
+  }
+  if (!host.ipv6().empty()) {
+    r.flags |= kHasIPv6;
+    Host::PackedIPv6 packed = Host::pack(host.ipv6());
+    std::memcpy(r.ipv6, packed.data(), sizeof(r.ipv6));
+  }
+  r.alias = static_cast<uint32_t>(aliases->size());
+  for (const IPv4Address& a : host.ipv4s()) {
+    if (a == host.ipv4()) continue;
+    Alias alias {};
+    std::vector<uint8_t> octets = a.address();
+    std::memcpy(alias.address, octets.data(), octets.size());
+    alias.family = 4;
+    aliases->push_back(alias);
+  }
+  for (const IPv6Address& a : host.ipv6s()) {
+    if (a == host.ipv6()) continue;
+    Alias alias {};
+    std::vector<uint8_t> octets = a.address();
+    std::memcpy(alias.address, octets.data(), octets.size());
+    alias.family = 6;
+    aliases->push_back(alias);
+  }
+  r.alias_count = static_cast<uint32_t>(aliases->size()) - r.alias;
+  r.packets = activity.packets;
+  r.bytes = activity.bytes;
+  r.first_seen = activity.first_seen;
+  r.last_seen = activity.last_seen;
+  return r;
+}
+
+Host Snapshot::decode(const Record& record, const Alias* aliases,
+                      IPForensics* ip, Activity* activity) {
+  Host host(Host::unpack(record.mac));
+  if (record.flags & kHasIPv4) host.set_ipv4(IPv4Address(record.ipv4));
+  if (record.flags & kHasIPv6) {
+    host.set_ipv6(IPv6Address(std::vector<uint8_t>(record.ipv6,
+                                                   record.ipv6 + 16)));
+  }
+  for (uint32_t j = record.alias; j < record.alias + record.alias_count; ++j) {
+    const uint8_t* a = aliases[j].address;
+    if (aliases[j].family == 4) {
+      host.add_ipv4(IPv4Address(std::vector<uint8_t>(a, a + 4)),
+                    ip->max_ipv4());
+    } else {
+      host.add_ipv6(IPv6Address(std::vector<uint8_t>(a, a + 16)),
+                    ip->max_ipv6());
+    }
+  }
+  activity->packets = record.packets;
+  activity->bytes = record.bytes;
+  activity->first_seen = record.first_seen;
+  activity->last_seen = record.last_seen;
+  return host;
+}
+
+bool Snapshot::write(int fd, const void* data, size_t size) {
+  const char* bytes = static_cast<const char*>(data);
+  while (size > 0) {
+    ssize_t n = ::write(fd, bytes, size);
+    if (n < 0 && errno == EINTR) continue;
+    if (n <= 0) return false;
+    bytes += n;
+    size -= static_cast<size_t>(n);
+  }
+  return true;
+}
+
+/**
+ *  @details The blocks are written to filename.tmp, which is flushed to disk
+ *           before it is renamed over filename, so a crash at any point leaves
+ *           either the old file or the new one.
+ */
+void Snapshot::replace(const std::string& filename,
+                       const std::vector<std::pair<const void*, size_t>>&
+                           blocks) {
+  std::string temp = filename + ".tmp";
+  int fd = open(temp.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+  if (fd < 0) throw std::runtime_error("Could not open " + temp);
+  bool ok = true;
+  for (const std::pair<const void*, size_t>& block : blocks) {
+    ok = ok && write(fd, block.first, block.second);
+  }
+  ok = ok && fsync(fd) == 0;
+  ok = close(fd) == 0 && ok;
+  if (!ok || std::rename(temp.c_str(), filename.c_str()) != 0) {
+    std::remove(temp.c_str());
+    throw std::runtime_error("Could not write " + filename);
+  }
+}
+
+/**
+ *  @details The records and aliases are built in memory first so the 
+ *           checksum can go in the header.
+ */
+void Snapshot::save(const std::string& filename) {
+  std::vector<Record> records;
+  std::vector<Alias> aliases;
+  records.reserve(ip_->hosts().size());
+  for (const Host& h : ip_->hosts()) {
+    records.push_back(encode(h, ip_->activity(h), &aliases));
+  }
+  Header header {};
+  std::memcpy(header.magic, ipf::kSnapshotMagic, sizeof(header.magic));
+  header.version = ipf::kSnapshotVersion;
+  header.byte_order = ipf::kSnapshotByteOrder;
+  header.record_size = sizeof(Record);
+  header.alias_size = sizeof(Alias);
+  header.records = records.size();
+  header.aliases = aliases.size();
+  header.checksum = checksum(records.data(), records.size() * sizeof(Record));
+  header.checksum = checksum(aliases.data(), aliases.size() * sizeof(Alias),
+                             header.checksum);
+  replace(filename, {{&header, sizeof(header)},
+                     {records.data(), records.size() * sizeof(Record)},
+                     {aliases.data(), aliases.size() * sizeof(Alias)}});
+  checksum_ = header.checksum;
+  records_ = header.records;
+}
+
+/**
+ *  @details The whole file is checked before anything is copied out, and the
+ *           mapping is released before returning.
+ */
+bool Snapshot::read(const std::string& filename, std::vector<Record>* records,
+                    std::vector<Alias>* aliases) {
+  int fd = open(filename.c_str(), O_RDONLY);
+  if (fd < 0) {
+    if (errno == ENOENT) return false;
+    throw std::runtime_error("Could not open snapshot file " + filename);
+  }
+  struct stat st;
+  if (fstat(fd, &st) != 0 || st.st_size == 0) {
+    close(fd);
+    throw std::runtime_error(filename + ": not a snapshot file");
+  }
+  size_t size = static_cast<size_t>(st.st_size);
+  void* map = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (map == MAP_FAILED) {
+    throw std::runtime_error("Could not map snapshot file " + filename);
+  }
+  madvise(map, size, MADV_SEQUENTIAL);
+  Header header;
+  try {
+    header = restore(static_cast<const uint8_t*>(map), size, records, aliases);
+  } catch (std::exception const &e) {
+    munmap(map, size);
+    throw std::runtime_error(filename + ": " + e.what());
+  }
+  munmap(map, size);
+  checksum_ = header.checksum;
+  records_ = header.records;
+  return true;
+}
+
+/**
+ *  @details Nothing is added to IPForensics until the whole file has been 
+ *           checked.
+ */
+bool Snapshot::load(const std::string& filename) {
+  std::vector<Record> records;
+  std::vector<Alias> aliases;
+  if (!read(filename, &records, &aliases)) return false;
+  for (const Record& r : records) {
+    Activity activity;
+    Host host = decode(r, aliases.data(), ip_, &activity);
+    ip_->add_host(host, activity);
+  }
+  return true;
+}
@@ -0,0 +1,104 @@
+/**
+ *  @file timerwheel.cpp
+ *  @brief TimerWheel class implementation
+ */
+
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014 Michael Maraya
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <algorithm>
+#include <vector>
+#include "ipforensics/timerwheel.h"
+
+int64_t TimerWheel::now() const {
+  return now_;
+}
+
+size_t TimerWheel::size() const {
+  return size_;
+}
+
+bool TimerWheel::started() const {
+  return now_ >= 0;
+}
+
+void TimerWheel::start(int64_t now) {
+  if (!started()) now_ = std::max<int64_t>(now, 0);
+}
+
+/**
+ *  @details A timer goes to the lowest level whose span covers the distance to
+ *           its deadline, in the slot its deadline falls in at that level.
+ */
+void TimerWheel::schedule(const Timer& timer) {
+  Timer t = timer;
+  t.deadline = std::max(t.deadline, now_ + 1);
+  int64_t delta = t.deadline - now_;
+  int level = 0;
+  while (level < kLevels - 1 &&
+         delta >= (int64_t {1} << (kSlotBits * (level + 1)))) {
+    ++level;
+  }
+  int64_t span = int64_t {1} << (kSlotBits * kLevels);
+  if (delta >= span) t.deadline = now_ + span - 1;
+  int64_t slot = (t.deadline >> (kSlotBits * level)) & (kSlots - 1);
+  wheels_[level][slot].push_back(t);
+  ++size_;
+}
+
+void TimerWheel::cascade(int level, int slot, std::vector<Timer>* expired) {
+  std::vector<Timer> timers;
+  timers.swap(wheels_[level][slot]);
+  size_ -= timers.size();
+  for (const Timer& t : timers) {
+    if (t.deadline <= now_) {
+      expired->push_back(t);
+    } else {
+      schedule(t);
+    }
+  }
+}
+
+/**
+ *  @details Each tick empties the level 0 slot for that tick.  Whenever a 
+ *           level wraps around, the next slot of the level above is cascaded
+ *           down.  An empty wheel jumps straight to the new time.
+ */
+void TimerWheel::advance(int64_t now, std::vector<Timer>* expired) {
+  if (!started()) start(now);
+  while (now_ < now) {
+    if (size_ == 0) {
+      now_ = now;
+      break;
+    }
+    ++now_;
+    for (int level = 1; level < kLevels; ++level) {
+      int64_t shift = kSlotBits * level;
+      if ((now_ & ((int64_t {1} << shift) - 1)) != 0) break;
+      cascade(level, static_cast<int>((now_ >> shift) & (kSlots - 1)),
+              expired);
+    }
+    cascade(0, static_cast<int>(now_ & (kSlots - 1)), expired);
+  }
+}
@@ -0,0 +1,189 @@
+/**
+ *  @file toptalkers.cpp
+ *  @brief TopTalkers class implementation
+ */
+
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014 Michael Maraya
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <algorithm>
+#include <iomanip>
+#include <string>
+#include <utility>
+#include <vector>
+#include "ipforensics/host.h"
+#include "ipforensics/hyperloglog.h"
+#include "ipforensics/ip4and6.h"
+#include "ipforensics/toptalkers.h"
+
+namespace {
+
+/** Index of a ranking in the per-ranking arrays */
+size_t index(TopTalkers::Ranking ranking) {
+  return static_cast<size_t>(ranking);
+}
+
+/** Text of a ranked address */
+std::string label(const std::vector<uint8_t>& address) {
+  if (address.size() == ipf::kLengthMAC) return MACAddress(address).str();
+  if (address.size() == ipf::kLengthIPv4) return IPv4Address(address).str();
+  return IPv6Address(address).str();
+}
+
+/** Writes one ranking */
+void write_ranking(std::ostream& out, const TopTalkers& t,
+                   TopTalkers::Ranking ranking, const std::string& title) {
+  out << "Top " << t.k() << ' ' << title << " (overcounts at most ";
+  out << t.error(ranking) << " at " << CountMin::confidence() * 100;
+  out << "% confidence)\n";
+  size_t rank {0};
+  for (const TopTalkers::Talker& talker : t.top(ranking)) {
+    out << std::right << std::setw(4) << ++rank << ' ';
+    out << std::left << std::setw(39) << label(talker.address);
+    out << std::right << std::setw(15) << talker.count << '\n';
+  }
+}
+
+}  // namespace
+
+size_t TopTalkers::k() const {
+  return k_;
+}
+
+void TopTalkers::set_k(size_t k) {
+  k_ = k;
+}
+
+void TopTalkers::add(const MACAddress& mac, const IPv4Address& ipv4,
+                     const IPv6Address& ipv6, uint32_t length) {
+  uint64_t hash = HyperLogLog::hash(Host::pack(mac));
+  offer(Ranking::kMACPackets, hash, mac, 1);
+  offer(Ranking::kMACBytes, hash, mac, length);
+  if (!ipv4.empty()) {
+    // tag IPv4 keys so they cannot collide with folded IPv6 keys
+    hash = HyperLogLog::hash(Host::pack(ipv4) | (uint64_t {1} << 32));
+    offer(Ranking::kIPPackets, hash, ipv4, 1);
+    offer(Ranking::kIPBytes, hash, ipv4, length);
+  }
+  if (!ipv6.empty()) {
+    Host::PackedIPv6 packed = Host::pack(ipv6);
+    uint64_t high {0}, low {0};
+    for (size_t i = 0; i < 8; ++i) {
+      high = (high << 8) | packed[i];
+      low = (low << 8) | packed[i + 8];
+    }
+    hash = HyperLogLog::hash(high ^ HyperLogLog::hash(low));
+    offer(Ranking::kIPPackets, hash, ipv6, 1);
+    offer(Ranking::kIPBytes, hash, ipv6, length);
+  }
+}
+
+/**
+ *  @details An address already in the heap has its count raised in place.  
+ *           Otherwise it is added while the heap has fewer than k entries, 
+ *           or replaces the smallest entry once its estimate is larger.
+ */
+void TopTalkers::offer(Ranking ranking, uint64_t hash, const Address& address,
+                       uint64_t count) {
+  size_t r = index(ranking);
+  uint64_t estimate = counts_[r].add(hash, count);
+  std::vector<Talker>& heap = heaps_[r];
+  auto it = positions_[r].find(hash);
+  if (it != positions_[r].end()) {
+    heap[it->second].count = estimate;
+    sift_down(ranking, it->second);
+  } else if (heap.size() < k_) {
+    positions_[r][hash] = heap.size();
+    heap.push_back({address.address(), hash, estimate});
+    sift_up(ranking, heap.size() - 1);
+  } else if (!heap.empty() && estimate > heap.front().count) {
+    positions_[r].erase(heap.front().hash);
+    positions_[r][hash] = 0;
+    heap.front() = {address.address(), hash, estimate};
+    sift_down(ranking, 0);
+  }
+}
+
+void TopTalkers::sift_down(Ranking ranking, size_t i) {
+  const std::vector<Talker>& heap = heaps_[index(ranking)];
+  while (true) {
+    size_t smallest = i;
+    for (size_t child = 2 * i + 1; child <= 2 * i + 2; ++child) {
+      if (child < heap.size() && heap[child].count < heap[smallest].count) {
+        smallest = child;
+      }
+    }
+    if (smallest == i) return;
+    swap(ranking, i, smallest);
+    i = smallest;
+  }
+}
+
+void TopTalkers::sift_up(Ranking ranking, size_t i) {
+  const std::vector<Talker>& heap = heaps_[index(ranking)];
+  while (i > 0 && heap[i].count < heap[(i - 1) / 2].count) {
+    swap(ranking, i, (i - 1) / 2);
+    i = (i - 1) / 2;
+  }
+}
+
+void TopTalkers::swap(Ranking ranking, size_t i, size_t j) {
+  size_t r = index(ranking);
+  std::swap(heaps_[r][i], heaps_[r][j]);
+  positions_[r][heaps_[r][i].hash] = i;
+  positions_[r][heaps_[r][j].hash] = j;
+}
+
+std::vector<TopTalkers::Talker> TopTalkers::top(Ranking ranking) const {
+  std::vector<Talker> result = heaps_[index(ranking)];
+  std::sort(result.begin(), result.end(),
+            [](const Talker& a, const Talker& b) {
+              if (a.count != b.count) return a.count > b.count;
+              return a.address < b.address;
+            });
+  return result;
+}
+
+uint64_t TopTalkers::error(Ranking ranking) const {
+  return counts_[index(ranking)].error();
+}
+
+/**
+ *  @details Each ranking lists the rank, address and estimated count, with 
+ *           the error bound of its estimator in the title.
+ */
+std::ostream& operator<<(std::ostream& out, const TopTalkers& t) {
+  std::ios::fmtflags fmt(out.flags());
+  out << std::fixed << std::setprecision(1);
+  write_ranking(out, t, TopTalkers::Ranking::kMACPackets,
+                "MAC addresses by packets");
+  write_ranking(out, t, TopTalkers::Ranking::kMACBytes,
+                "MAC addresses by bytes");
+  write_ranking(out, t, TopTalkers::Ranking::kIPPackets,
+                "IP addresses by packets");
+  write_ranking(out, t, TopTalkers::Ranking::kIPBytes,
+                "IP addresses by bytes");
+  out.flags(fmt);
+  return out;
+}